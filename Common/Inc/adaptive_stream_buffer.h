@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file           : adaptive_stream_buffer.h
+  * @brief          : Stream buffer whose trigger level follows the traffic
+  ******************************************************************************
+  * @attention
+  *
+  * With a trigger level of 1 the consumer is woken for every byte; with a
+  * large fixed trigger level a short message waits in the buffer until
+  * more data arrives. Here the consumer is woken when
+  *
+  *   - N bytes are in the buffer, or
+  *   - the buffer is not empty and nothing was written for xIdleTimeout ticks
+  *
+  * and N follows the measured arrival rate: it is the number of bytes that
+  * arrive in about xIdleTimeout, between 1 and half the buffer size. A
+  * burst is handed over in large blocks with few context switches, a single
+  * byte on a quiet line after at most xIdleTimeout.
+  *
+  * One consumer task, one producer (task or ISR), as for a stream buffer.
+  * The consumer is woken with its task notification (index 0), so it must
+  * not use that notification for anything else.
+  *
+  ******************************************************************************
+  */
+
+#ifndef ADAPTIVE_STREAM_BUFFER_H
+#define ADAPTIVE_STREAM_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+
+typedef struct AdaptiveStreamBuffer *AdaptiveStreamBufferHandle_t;
+
+/* Returns NULL when the heap is exhausted. */
+AdaptiveStreamBufferHandle_t xAdaptiveStreamBufferCreate(size_t xBufferSizeBytes, TickType_t xIdleTimeout);
+void vAdaptiveStreamBufferDelete(AdaptiveStreamBufferHandle_t xBuffer);
+
+/* Same as xStreamBufferSend() / xStreamBufferSendFromISR(). */
+size_t xAdaptiveStreamBufferSend(AdaptiveStreamBufferHandle_t xBuffer, const void *pvTxData,
+                                 size_t xDataLengthBytes, TickType_t xTicksToWait);
+size_t xAdaptiveStreamBufferSendFromISR(AdaptiveStreamBufferHandle_t xBuffer, const void *pvTxData,
+                                        size_t xDataLengthBytes, BaseType_t *pxHigherPriorityTaskWoken);
+
+/* Returns up to xBufferLengthBytes bytes once the trigger level or the idle
+timeout is reached. When xTicksToWait expires first it returns what is there,
+0 if the buffer is empty. */
+size_t xAdaptiveStreamBufferReceive(AdaptiveStreamBufferHandle_t xBuffer, void *pvRxData,
+                                    size_t xBufferLengthBytes, TickType_t xTicksToWait);
+
+/* Current trigger level N. */
+size_t xAdaptiveStreamBufferGetTriggerLevel(AdaptiveStreamBufferHandle_t xBuffer);
+
+/* The stock stream buffer underneath, to watch it with queue_metrics.h.
+Do not send to or receive from it directly. */
+StreamBufferHandle_t xAdaptiveStreamBufferGetStreamBuffer(AdaptiveStreamBufferHandle_t xBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADAPTIVE_STREAM_BUFFER_H */
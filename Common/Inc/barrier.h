@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file           : barrier.h
+  * @brief          : Reusable task barrier with a generation counter
+  ******************************************************************************
+  * @attention
+  *
+  * xEventGroupSync() needs one event bit per participant (at most 24) and a
+  * task that gives up on a round leaves its bit set, so the next round can
+  * complete without it. Here every arrival only increments a counter, the
+  * last one of a round starts a new generation and releases all waiters with
+  * one event group call:
+  *
+  *   round g:   arrive, arrive, ... , arrive (N-th)  -> generation g+1, release
+  *
+  * A task whose wait times out withdraws its arrival, so a missed round
+  * never counts towards the next one. xBarrierWait() reports the generation
+  * the caller took part in, pdFAIL tells which round timed out.
+  *
+  *   xBarrier = xBarrierCreate(3);
+  *   ...
+  *   if (xBarrierWait(xBarrier, pdMS_TO_TICKS(2000), &ulRound) == pdFAIL)
+  *     // round ulRound timed out for this task
+  *
+  * Any number of participants, tasks only.
+  *
+  ******************************************************************************
+  */
+
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+typedef struct Barrier *BarrierHandle_t;
+
+/* Returns NULL when the heap is exhausted. */
+BarrierHandle_t xBarrierCreate(UBaseType_t uxParticipants);
+void vBarrierDelete(BarrierHandle_t xBarrier);
+
+/* pdPASS when all participants arrived, pdFAIL when xTicksToWait expired
+first (the arrival is taken back). pulGeneration may be NULL. */
+BaseType_t xBarrierWait(BarrierHandle_t xBarrier, TickType_t xTicksToWait, uint32_t *pulGeneration);
+
+/* Number of completed rounds. */
+uint32_t ulBarrierGetGeneration(BarrierHandle_t xBarrier);
+/* Number of waits that timed out, over all rounds. */
+uint32_t ulBarrierGetTimeouts(BarrierHandle_t xBarrier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BARRIER_H */
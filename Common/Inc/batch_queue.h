@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file           : batch_queue.h
+  * @brief          : Queue that moves many items per call
+  ******************************************************************************
+  * @attention
+  *
+  * xQueueSend() / xQueueReceive() move one item per call: a kernel entry, a
+  * critical section and, when the other side is blocked, a wake-up and a
+  * context switch per item. A consumer that wants to drain everything pays
+  * that N times.
+  *
+  * Here one call copies up to uxCount items by value, in one critical
+  * section, and wakes at most one task on the other side however many items
+  * it moved. A consumer that is slower than its producer therefore gets the
+  * backlog in blocks and the per item cost falls with the batch size.
+  *
+  * Send copies as many items as fit and returns that number, it only waits
+  * while the queue is completely full. Receive returns whatever is there, up
+  * to uxMaxCount, and only waits while the queue is empty. Both return 0 on
+  * timeout. Waiting tasks sleep on their task notification.
+  *
+  * Items are copied inside the critical section, so a batch keeps
+  * interrupts masked for about uxCount * uxItemSize bytes of memcpy: keep
+  * big items out of it or the batches short.
+  *
+  *   xQueue = xBatchQueueCreate(64, sizeof(QMsg));
+  *   ...
+  *   uxSent = uxBatchQueueSend(xQueue, msgs, 8, portMAX_DELAY);
+  *   uxGot = uxBatchQueueReceive(xQueue, msgs, 8, portMAX_DELAY);
+  *
+  ******************************************************************************
+  */
+
+#ifndef BATCH_QUEUE_H
+#define BATCH_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FreeRTOS.h"
+
+typedef struct BatchQueue *BatchQueueHandle_t;
+
+/* NULL when the heap is exhausted. */
+BatchQueueHandle_t xBatchQueueCreate(UBaseType_t uxLength, UBaseType_t uxItemSize);
+void vBatchQueueDelete(BatchQueueHandle_t xQueue);
+
+/* Number of items copied, 0 on timeout. */
+UBaseType_t uxBatchQueueSend(BatchQueueHandle_t xQueue, const void *pvItems, UBaseType_t uxCount,
+                             TickType_t xTicksToWait);
+UBaseType_t uxBatchQueueReceive(BatchQueueHandle_t xQueue, void *pvItems, UBaseType_t uxMaxCount,
+                                TickType_t xTicksToWait);
+
+/* Never wait. */
+UBaseType_t uxBatchQueueSendFromISR(BatchQueueHandle_t xQueue, const void *pvItems, UBaseType_t uxCount,
+                                    BaseType_t *pxHigherPriorityTaskWoken);
+UBaseType_t uxBatchQueueReceiveFromISR(BatchQueueHandle_t xQueue, void *pvItems, UBaseType_t uxMaxCount,
+                                       BaseType_t *pxHigherPriorityTaskWoken);
+
+UBaseType_t uxBatchQueueMessagesWaiting(BatchQueueHandle_t xQueue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATCH_QUEUE_H */
@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file           : block_pool.h
+  * @brief          : Fixed size block pool with static storage
+  ******************************************************************************
+  * @attention
+  *
+  * All blocks of a pool have the same size, so a free block always fits and
+  * the pool can not fragment. Free blocks are kept in a singly linked list
+  * stored inside the blocks themselves: allocating pops the head, freeing
+  * pushes it back, both O(1) inside a short critical section. The FromISR
+  * variants can be called from interrupts up to
+  * configMAX_SYSCALL_INTERRUPT_PRIORITY.
+  *
+  * BLOCK_POOL_STORAGE also reserves one bit per block after the blocks,
+  * set while the block is allocated: freeing a block twice, or a pointer
+  * that is not a block of the pool, trips configASSERT.
+  *
+  *   BLOCK_POOL_STORAGE(LogBuffers, 100, 3);
+  *   BlockPool_t LogPool;
+  *
+  *   vBlockPoolInit(&LogPool, LogBuffers, 100, 3);     // before the scheduler
+  *   char* str = pvBlockPoolAlloc(&LogPool);
+  *   ...
+  *   vBlockPoolFree(&LogPool, str);
+  *
+  ******************************************************************************
+  */
+
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/* Every block is rounded up to this, enough for any C type on the M4. */
+#define BLOCK_POOL_ALIGNMENT      8U
+#define BLOCK_POOL_BLOCK_SIZE(xSize) \
+  ((((xSize) < sizeof(void *) ? sizeof(void *) : (xSize)) + BLOCK_POOL_ALIGNMENT - 1U) & ~(size_t)(BLOCK_POOL_ALIGNMENT - 1U))
+
+/* 32 bit words of the allocated bitmap. */
+#define BLOCK_POOL_MAP_WORDS(uxBlocks) (((uxBlocks) + 31U) / 32U)
+
+/* Static storage for uxBlocks blocks of xSize bytes and their bitmap, the
+only storage vBlockPoolInit() accepts. */
+#define BLOCK_POOL_STORAGE(name, xSize, uxBlocks)                                               \
+  static uint8_t name[BLOCK_POOL_BLOCK_SIZE(xSize) * (uxBlocks) + BLOCK_POOL_MAP_WORDS(uxBlocks) * 4U] \
+  __attribute__((aligned(BLOCK_POOL_ALIGNMENT)))
+
+typedef struct
+{
+  void *pvFreeList;
+  uint8_t *pucStorage;
+  uint32_t *pulAllocated;
+  size_t xBlockSize;
+  UBaseType_t uxBlocks;
+  UBaseType_t uxFree;
+  UBaseType_t uxMinimumFree;
+} BlockPool_t;
+
+void vBlockPoolInit(BlockPool_t *pxPool, void *pvStorage, size_t xSize, UBaseType_t uxBlocks);
+
+/* Return NULL when every block is in use. */
+void *pvBlockPoolAlloc(BlockPool_t *pxPool);
+void *pvBlockPoolAllocFromISR(BlockPool_t *pxPool);
+
+void vBlockPoolFree(BlockPool_t *pxPool, void *pvBlock);
+void vBlockPoolFreeFromISR(BlockPool_t *pxPool, void *pvBlock);
+
+UBaseType_t uxBlockPoolGetFree(const BlockPool_t *pxPool);
+UBaseType_t uxBlockPoolGetMinimumEverFree(const BlockPool_t *pxPool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLOCK_POOL_H */
@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file           : fast_recursive_mutex.h
+  * @brief          : Recursive mutex with an inline re-entry path
+  ******************************************************************************
+  * @attention
+  *
+  * Same semantics as xSemaphoreTakeRecursive() / xSemaphoreGiveRecursive(),
+  * including priority inheritance, for code that re-takes the lock it
+  * already holds on every call (driver layers calling each other).
+  *
+  * The owner and the depth live next to a plain mutex. A take by the owner
+  * is one compare with the current task handle and one increment, inlined
+  * at the call site; a give that does not release is the same compare and
+  * one decrement. Only the outermost take and give call into the kernel.
+  *
+  * No critical section is needed on the inline path: xOwner can only become
+  * equal to the calling task by that task's own take, and only the owner
+  * writes uxDepth.
+  *
+  *   static FastRecursiveMutex_t xDriverLock;
+  *   xFastRecursiveMutexInit(&xDriverLock);            // before the scheduler
+  *   ...
+  *   xFastRecursiveMutexTake(&xDriverLock, portMAX_DELAY);
+  *   ...                                                // may take it again
+  *   xFastRecursiveMutexGive(&xDriverLock);
+  *
+  ******************************************************************************
+  */
+
+#ifndef FAST_RECURSIVE_MUTEX_H
+#define FAST_RECURSIVE_MUTEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+typedef struct
+{
+  SemaphoreHandle_t xMutex;
+  TaskHandle_t volatile xOwner;
+  UBaseType_t uxDepth;
+} FastRecursiveMutex_t;
+
+/* Returns pdFAIL when the heap is exhausted. */
+BaseType_t xFastRecursiveMutexInit(FastRecursiveMutex_t *pxMutex);
+void vFastRecursiveMutexDelete(FastRecursiveMutex_t *pxMutex);
+
+/* Outermost take and last give, through the kernel. */
+BaseType_t xFastRecursiveMutexTakeSlow(FastRecursiveMutex_t *pxMutex, TickType_t xTicksToWait);
+BaseType_t xFastRecursiveMutexGiveSlow(FastRecursiveMutex_t *pxMutex);
+
+static inline BaseType_t xFastRecursiveMutexTake(FastRecursiveMutex_t *pxMutex, TickType_t xTicksToWait)
+{
+  if (pxMutex->xOwner == xTaskGetCurrentTaskHandle())
+  {
+    pxMutex->uxDepth++;
+    return pdPASS;
+  }
+
+  return xFastRecursiveMutexTakeSlow(pxMutex, xTicksToWait);
+}
+
+/* Once per successful take. pdFAIL when the calling task is not the owner,
+like xSemaphoreGiveRecursive(). */
+static inline BaseType_t xFastRecursiveMutexGive(FastRecursiveMutex_t *pxMutex)
+{
+  if (pxMutex->xOwner == xTaskGetCurrentTaskHandle() && pxMutex->uxDepth > 1U)
+  {
+    pxMutex->uxDepth--;
+    return pdPASS;
+  }
+
+  return xFastRecursiveMutexGiveSlow(pxMutex);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAST_RECURSIVE_MUTEX_H */
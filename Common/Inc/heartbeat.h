@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file           : heartbeat.h
+  * @brief          : Task heartbeat watchdog for any number of tasks
+  ******************************************************************************
+  * @attention
+  *
+  * Every monitored task registers once with its own timeout and then calls
+  * vHeartbeatCheckIn() in its loop. A check-in is one store of the tick
+  * count into the task's slot: no lock, no kernel call, never waits.
+  *
+  * The "Heartbeat" task wakes every HEARTBEAT_CHECK_PERIOD_MS. Slots are
+  * grouped in words of 32; for each word it only visits the registered
+  * slots (CTZ over the registration bitmap), builds the bitmap of slots
+  * whose last check-in is older than their timeout and then reports the
+  * slots that changed state, again with CTZ. The callback runs in the
+  * "Heartbeat" task, once when a task goes silent and once when it checks
+  * in again.
+  *
+  *   static void OnHeartbeat(BaseType_t xId, BaseType_t xMissing) { ... }
+  *
+  *   xHeartbeatInit(OnHeartbeat);                       // before the scheduler
+  *   id = xHeartbeatRegister("T1", pdMS_TO_TICKS(2000));
+  *   for(;;) { ...; vHeartbeatCheckIn(id); }
+  *
+  * The worst gap is the longest silence the "Heartbeat" task observed, so it
+  * is exact to one check period.
+  *
+  ******************************************************************************
+  */
+
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef HEARTBEAT_MAX_TASKS
+#define HEARTBEAT_MAX_TASKS        64U       /* multiple of 32 */
+#endif
+
+#ifndef HEARTBEAT_CHECK_PERIOD_MS
+#define HEARTBEAT_CHECK_PERIOD_MS  50U
+#endif
+
+#ifndef HEARTBEAT_TASK_PRIORITY
+#define HEARTBEAT_TASK_PRIORITY    (configMAX_PRIORITIES - 1)
+#endif
+
+#ifndef HEARTBEAT_TASK_STACK
+#define HEARTBEAT_TASK_STACK       256U
+#endif
+
+/* xMissing: pdTRUE when task xId went past its timeout, pdFALSE when it
+checked in again. */
+typedef void (*HeartbeatCallback_t)(BaseType_t xId, BaseType_t xMissing);
+
+/* Creates the "Heartbeat" task. pxCallback may be NULL. */
+BaseType_t xHeartbeatInit(HeartbeatCallback_t pxCallback);
+
+/* Returns the slot id, or -1 when all HEARTBEAT_MAX_TASKS slots are used.
+The slot counts as checked in at registration. */
+BaseType_t xHeartbeatRegister(const char *pcName, TickType_t xTimeout);
+void vHeartbeatUnregister(BaseType_t xId);
+
+extern volatile TickType_t xHeartbeatLastCheckIn[HEARTBEAT_MAX_TASKS];
+
+static inline void vHeartbeatCheckIn(BaseType_t xId)
+{
+  xHeartbeatLastCheckIn[xId] = xTaskGetTickCount();
+}
+
+static inline void vHeartbeatCheckInFromISR(BaseType_t xId)
+{
+  xHeartbeatLastCheckIn[xId] = xTaskGetTickCountFromISR();
+}
+
+const char *pcHeartbeatGetName(BaseType_t xId);
+/* Number of times the task went past its timeout. */
+uint32_t ulHeartbeatGetMisses(BaseType_t xId);
+/* Longest time without a check-in, in ticks. */
+TickType_t xHeartbeatGetWorstGap(BaseType_t xId);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEARTBEAT_H */
@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file           : latency_hist.h
+  * @brief          : Fixed size log-linear histogram for latency percentiles
+  ******************************************************************************
+  * @attention
+  *
+  * Values below 8 are counted exactly, larger values fall into one of 8
+  * linear sub-buckets per power of two, so any percentile is reported within
+  * 12.5 % of the true value. The histogram is about 1 KB, needs no heap and
+  * adding a sample is O(1) (one CLZ), cheap enough to run inside the loop
+  * being measured.
+  *
+  * Not thread safe: one writer per histogram.
+  *
+  ******************************************************************************
+  */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define LATENCY_HIST_SUB_BITS      3U
+#define LATENCY_HIST_SUB_BUCKETS   (1U << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_BUCKETS       ((32U - LATENCY_HIST_SUB_BITS + 1U) * LATENCY_HIST_SUB_BUCKETS)
+
+typedef struct
+{
+  uint32_t ulBucket[LATENCY_HIST_BUCKETS];
+  uint32_t ulCount;
+  uint32_t ulMin;
+  uint32_t ulMax;
+  uint64_t ullSum;
+} LatencyHist_t;
+
+void vLatencyHistReset(LatencyHist_t *pxHist);
+void vLatencyHistAdd(LatencyHist_t *pxHist, uint32_t ulValue);
+
+/* ulPerMille: 500 = median, 990 = p99, 999 = p99.9 */
+uint32_t ulLatencyHistPercentile(const LatencyHist_t *pxHist, uint32_t ulPerMille);
+uint32_t ulLatencyHistMean(const LatencyHist_t *pxHist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_HIST_H */
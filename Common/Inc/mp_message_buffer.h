@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file           : mp_message_buffer.h
+  * @brief          : Message buffer that accepts several concurrent writers
+  ******************************************************************************
+  * @attention
+  *
+  * A FreeRTOS message buffer assumes one writer and one reader. With two
+  * producers, a send that is preempted by the other producer's send corrupts
+  * the buffer, so every xMessageBufferSend() needs a mutex or a critical
+  * section around it.
+  *
+  * Here each writer reserves the space for its message with one
+  * compare-and-swap on the write position, copies the payload without any
+  * lock and then commits the message by setting a flag in its 4 byte header.
+  * The single reader takes messages in reservation order and stops at the
+  * first one that is not committed yet. A preempted writer therefore never
+  * blocks the other writers, it only delays the reader.
+  *
+  *   [hdr|payload..pad][hdr|payload..pad][hdr: not committed yet] ...
+  *    ^ reader                                                    ^ next reservation
+  *
+  * A message never wraps: when it does not fit before the end of the storage
+  * the writer also reserves the rest of the storage as a skip record. The
+  * largest message is therefore half of the buffer size minus the header.
+  *
+  * One reader task. Writers can be any number of tasks and ISRs.
+  * Needs configUSE_COUNTING_SEMAPHORES 1 (blocked writers are woken with it).
+  *
+  ******************************************************************************
+  */
+
+#ifndef MP_MESSAGE_BUFFER_H
+#define MP_MESSAGE_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+typedef struct MPMessageBuffer *MPMessageBufferHandle_t;
+
+/* xBufferSizeBytes is rounded up to a power of two. Returns NULL when the
+heap is exhausted. */
+MPMessageBufferHandle_t xMPMessageBufferCreate(size_t xBufferSizeBytes);
+void vMPMessageBufferDelete(MPMessageBufferHandle_t xBuffer);
+
+/* Return xDataLengthBytes, or 0 when no space became free in time. */
+size_t xMPMessageBufferSend(MPMessageBufferHandle_t xBuffer, const void *pvTxData,
+                            size_t xDataLengthBytes, TickType_t xTicksToWait);
+size_t xMPMessageBufferSendFromISR(MPMessageBufferHandle_t xBuffer, const void *pvTxData,
+                                   size_t xDataLengthBytes, BaseType_t *pxHigherPriorityTaskWoken);
+
+/* Returns the message length, or 0 on timeout or when pvRxData is too
+small (the message then stays in the buffer). */
+size_t xMPMessageBufferReceive(MPMessageBufferHandle_t xBuffer, void *pvRxData,
+                               size_t xBufferLengthBytes, TickType_t xTicksToWait);
+
+/*
+ * Zero-copy: the producer writes straight into the buffer storage and the
+ * consumer reads from it, no copy through a stack buffer on either side.
+ *
+ *   uint8_t *p = pvMPMessageBufferReserve(xBuffer, 24, portMAX_DELAY);
+ *   ... fill p[0..23] ...
+ *   vMPMessageBufferCommit(xBuffer, p);
+ *
+ *   const uint8_t *m = pvMPMessageBufferPeek(xBuffer, &xLength, portMAX_DELAY);
+ *   ... use m[0..xLength-1] ...
+ *   vMPMessageBufferRelease(xBuffer);
+ *
+ * The reserved block is contiguous even at the end of the storage, it is
+ * never split around the wrap. Every reservation must be committed (a
+ * reservation that is never committed stops the reader), and the reader
+ * sees messages in reservation order, so keep the time between reserve and
+ * commit short. Peek returns the same message until it is released.
+ */
+void *pvMPMessageBufferReserve(MPMessageBufferHandle_t xBuffer, size_t xDataLengthBytes, TickType_t xTicksToWait);
+void *pvMPMessageBufferReserveFromISR(MPMessageBufferHandle_t xBuffer, size_t xDataLengthBytes);
+void vMPMessageBufferCommit(MPMessageBufferHandle_t xBuffer, void *pvReserved);
+void vMPMessageBufferCommitFromISR(MPMessageBufferHandle_t xBuffer, void *pvReserved,
+                                   BaseType_t *pxHigherPriorityTaskWoken);
+
+const void *pvMPMessageBufferPeek(MPMessageBufferHandle_t xBuffer, size_t *pxLength, TickType_t xTicksToWait);
+void vMPMessageBufferRelease(MPMessageBufferHandle_t xBuffer);
+
+size_t xMPMessageBufferSpacesAvailable(MPMessageBufferHandle_t xBuffer);
+size_t xMPMessageBufferMaxMessageSize(MPMessageBufferHandle_t xBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MP_MESSAGE_BUFFER_H */
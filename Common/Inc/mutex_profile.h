@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file           : mutex_profile.h
+  * @brief          : Mutex with contention and hold time statistics
+  ******************************************************************************
+  * @attention
+  *
+  * A FreeRTOS mutex plus counters, used through xMutexProfileTake() /
+  * xMutexProfileGive() instead of xSemaphoreTake() / xSemaphoreGive():
+  *
+  *   acquires     successful takes
+  *   contended    takes that found the mutex held and had to wait
+  *   timeouts     takes that gave up
+  *   wait         histogram of the time from the take call until the mutex
+  *                was obtained (0 when uncontended)
+  *   hold         histogram of the time from obtaining to giving, and the
+  *                name of the task that held it longest
+  *
+  * Times are taken with the perf counter (vPerfCounterInit() first). The
+  * histograms are only written by the task that holds the mutex, so the
+  * mutex itself keeps them consistent.
+  *
+  *   static MutexProfile_t SimpleMutexProfile;
+  *   SimpleMutex = xMutexProfileCreate(&SimpleMutexProfile, "SimpleMutex");
+  *   ...
+  *   xMutexProfileTake(&SimpleMutexProfile, portMAX_DELAY);
+  *   ...
+  *   xMutexProfileGive(&SimpleMutexProfile);
+  *   ...
+  *   vMutexProfileDump(print);       // every profiled mutex, any time
+  *
+  ******************************************************************************
+  */
+
+#ifndef MUTEX_PROFILE_H
+#define MUTEX_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "latency_hist.h"
+
+typedef struct MutexProfile
+{
+  SemaphoreHandle_t xMutex;
+  const char *pcName;
+  struct MutexProfile *pxNext;
+  uint32_t ulAcquires;
+  uint32_t ulContended;
+  uint32_t ulTimeouts;
+  uint32_t ulHoldStart;
+  LatencyHist_t xWait;
+  LatencyHist_t xHold;
+  char cLongestHolder[configMAX_TASK_NAME_LEN];
+} MutexProfile_t;
+
+/* Creates the mutex and adds the profile to the list vMutexProfileDump()
+prints. Returns the mutex, NULL when the heap is exhausted. */
+SemaphoreHandle_t xMutexProfileCreate(MutexProfile_t *pxProfile, const char *pcName);
+
+BaseType_t xMutexProfileTake(MutexProfile_t *pxProfile, TickType_t xTicksToWait);
+BaseType_t xMutexProfileGive(MutexProfile_t *pxProfile);
+
+void vMutexProfileReset(MutexProfile_t *pxProfile);
+
+/* Calls pxWrite with a few lines per profiled mutex. */
+void vMutexProfileDump(void (*pxWrite)(const char *pcLine));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MUTEX_PROFILE_H */
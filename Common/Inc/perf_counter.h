@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : perf_counter.h
+  * @brief          : Free running high resolution counter for measurements
+  ******************************************************************************
+  * @attention
+  *
+  * STM32F429: DWT->CYCCNT, one count per core clock (SystemCoreClock, 180 MHz).
+  * Host build: CLOCK_MONOTONIC in nanoseconds.
+  *
+  * The counter is 32 bit and wraps (after ~23 s on the target), so only use
+  * it for differences: ulPerfCounterGet() - ulStart.
+  *
+  ******************************************************************************
+  */
+
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "main.h"
+
+#ifdef HOST_BUILD
+#include "host_port.h"
+#endif
+
+void vPerfCounterInit(void);
+
+static inline uint32_t ulPerfCounterGet(void)
+{
+#ifdef HOST_BUILD
+  return (uint32_t)HostPort_TimeNs();
+#else
+  return DWT->CYCCNT;
+#endif
+}
+
+static inline uint32_t ulPerfCounterHz(void)
+{
+#ifdef HOST_BUILD
+  return 1000000000U;
+#else
+  return SystemCoreClock;
+#endif
+}
+
+static inline uint32_t ulPerfCounterToNs(uint32_t ulCounts)
+{
+  return (uint32_t)(((uint64_t)ulCounts * 1000000000ULL) / ulPerfCounterHz());
+}
+
+/* For differences of 4.29 s and more, which ulPerfCounterToNs() wraps. */
+static inline uint32_t ulPerfCounterToUs(uint32_t ulCounts)
+{
+  return (uint32_t)(((uint64_t)ulCounts * 1000000ULL) / ulPerfCounterHz());
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERF_COUNTER_H */
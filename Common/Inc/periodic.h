@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file           : periodic.h
+  * @brief          : Periodic tasks released on an absolute time grid
+  ******************************************************************************
+  * @attention
+  *
+  * for(;;) { work(); vTaskDelay(period); } sleeps one period after the work,
+  * so every cycle is longer than the period by the loop body, including a
+  * blocking HAL_UART_Transmit(), and the task slowly slides against
+  * anything that counts real time, such as a watchdog window.
+  *
+  * Here a task is released at phase + n * period ticks after the scheduler
+  * started, with vTaskDelayUntil(): the body time no longer adds up, and
+  * tasks with the same period but different phases never wake in the same
+  * tick.
+  *
+  *   static PeriodicTask_t xT1;
+  *   vPeriodicInit(&xT1, "T1", pdMS_TO_TICKS(1000), pdMS_TO_TICKS(100));
+  *   ...
+  *   for(;;) { vPeriodicWait(&xT1); work(); }
+  *
+  * When a job runs past its next release the task is late: the most recent
+  * missed release runs at once, the older ones are skipped and counted, and
+  * the task stays on its grid instead of running a burst of catch-up jobs.
+  *
+  * Jitter is the difference between two consecutive start times and the
+  * period, measured with the cycle counter (periods up to ~11 s on the
+  * target). Exec is from the release to the next vPeriodicWait(), time spent
+  * preempted included. INCLUDE_vTaskDelayUntil must be 1 and
+  * vPerfCounterInit() must have been called.
+  *
+  ******************************************************************************
+  */
+
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+typedef struct PeriodicTask
+{
+  const char *pcName;
+  struct PeriodicTask *pxNext;
+  TickType_t xPeriod;
+  TickType_t xPhase;
+  TickType_t xLastWake;
+  uint32_t ulReleases;
+  uint32_t ulOverruns;
+  uint32_t ulSkipped;
+  uint32_t ulMaxJitter;    /* perf counter counts */
+  uint32_t ulMaxExec;      /* perf counter counts */
+  uint32_t ulJobStart;
+  BaseType_t xLate;
+} PeriodicTask_t;
+
+/* Once per task, xPhase < xPeriod. The first release is the next grid point
+from now on, so it can be called before the scheduler starts or from the task
+itself. Adds the task to the list vPeriodicDump() prints. */
+void vPeriodicInit(PeriodicTask_t *pxTask, const char *pcName, TickType_t xPeriod, TickType_t xPhase);
+
+/* Owning task only. Blocks until the next release. */
+void vPeriodicWait(PeriodicTask_t *pxTask);
+
+void vPeriodicResetStats(PeriodicTask_t *pxTask);
+
+/* Calls pxWrite with one line per periodic task. */
+void vPeriodicDump(void (*pxWrite)(const char *pcLine));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERIODIC_H */
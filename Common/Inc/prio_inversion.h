@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : prio_inversion.h
+  * @brief          : Priority inversion detector with a timeline export
+  ******************************************************************************
+  * @attention
+  *
+  * Fed by the kernel trace macros of prio_inversion_trace.h, so the
+  * application keeps using xSemaphoreTake() / xSemaphoreGive() unchanged.
+  *
+  * The detector remembers which task took each binary semaphore or mutex
+  * last. An inversion starts when a task blocks on one held by a task of
+  * lower priority and ends when the waiter gets it (or times out); its
+  * duration is measured with the perf counter (vPerfCounterInit() first).
+  * For mutexes the kernel also reports every priority inheritance boost and
+  * every restore.
+  *
+  * Every event goes to a timeline ring of PRIO_INVERSION_TIMELINE_SIZE
+  * entries, vPrioInversionExport() drains it as CSV lines:
+  *
+  *   tick,event,lock,task,priority,other,other_priority,duration_us
+  *
+  *   block    task (priority) blocked on lock held by other (other_priority)
+  *   acquire  the inversion ended, task got the lock after duration_us
+  *   timeout  the inversion ended without the lock
+  *   boost    task inherited priority, other_priority is the one it had
+  *   restore  task went back to priority from other_priority
+  *
+  * The lock column is the queue registry name (vQueueAddToRegistry()) when
+  * there is one, else the handle.
+  *
+  ******************************************************************************
+  */
+
+#ifndef PRIO_INVERSION_H
+#define PRIO_INVERSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#ifndef PRIO_INVERSION_TIMELINE_SIZE
+#define PRIO_INVERSION_TIMELINE_SIZE   64U
+#endif
+
+/* Binary semaphores and mutexes whose holder is remembered. */
+#ifndef PRIO_INVERSION_MAX_LOCKS
+#define PRIO_INVERSION_MAX_LOCKS       8U
+#endif
+
+/* Tasks that can be in an inversion at the same time. */
+#ifndef PRIO_INVERSION_MAX_OPEN
+#define PRIO_INVERSION_MAX_OPEN        8U
+#endif
+
+typedef struct
+{
+  uint32_t ulInversions;    /* started */
+  uint32_t ulTimeouts;      /* ended without the lock */
+  uint32_t ulBoosts;
+  uint32_t ulRestores;
+  uint32_t ulTotalUs;       /* time spent in ended inversions */
+  uint32_t ulWorstUs;
+  uint32_t ulDropped;       /* events lost to a full timeline */
+} PrioInversionStats_t;
+
+void vPrioInversionGetStats(PrioInversionStats_t *pxStats);
+void vPrioInversionResetStats(void);
+
+/* Calls pxWrite with the CSV header and one line per event, oldest first,
+and removes the events. Task context only. */
+void vPrioInversionExport(void (*pxWrite)(const char *pcLine));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIO_INVERSION_H */
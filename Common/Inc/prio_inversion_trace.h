@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file           : prio_inversion_trace.h
+  * @brief          : Kernel trace macros feeding the priority inversion detector
+  ******************************************************************************
+  * @attention
+  *
+  * Include at the end of FreeRTOSConfig.h (USER CODE BEGIN Defines):
+  *
+  *   #include "prio_inversion_trace.h"
+  *
+  * The macros expand inside queue.c and tasks.c, which is why they may look
+  * at queue and TCB fields. Only binary semaphores and mutexes (item size 0,
+  * length 1) are reported; counting semaphores have no single holder.
+  *
+  * This file is included by FreeRTOS.h itself, so it must not include any
+  * FreeRTOS header and the hooks only use plain C types.
+  *
+  ******************************************************************************
+  */
+
+#ifndef PRIO_INVERSION_TRACE_H
+#define PRIO_INVERSION_TRACE_H
+
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+
+void vPrioInversionTraceTake(void *pvLock);
+void vPrioInversionTraceTakeFailed(void *pvLock);
+void vPrioInversionTraceBlocking(void *pvLock);
+void vPrioInversionTraceGive(void *pvLock);
+void vPrioInversionTracePriority(void *pvTask, unsigned long ulFrom, unsigned long ulTo);
+
+#endif
+
+#define prioINVERSION_IS_LOCK(pxQueue)  (((pxQueue)->uxItemSize == 0U) && ((pxQueue)->uxLength == 1U))
+
+#define traceQUEUE_RECEIVE(pxQueue) \
+  do { if (prioINVERSION_IS_LOCK(pxQueue)) { vPrioInversionTraceTake((void *)(pxQueue)); } } while (0)
+
+#define traceQUEUE_RECEIVE_FAILED(pxQueue) \
+  do { if (prioINVERSION_IS_LOCK(pxQueue)) { vPrioInversionTraceTakeFailed((void *)(pxQueue)); } } while (0)
+
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+  do { if (prioINVERSION_IS_LOCK(pxQueue)) { vPrioInversionTraceBlocking((void *)(pxQueue)); } } while (0)
+
+#define traceQUEUE_SEND(pxQueue) \
+  do { if (prioINVERSION_IS_LOCK(pxQueue)) { vPrioInversionTraceGive((void *)(pxQueue)); } } while (0)
+
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+  do { if (prioINVERSION_IS_LOCK(pxQueue)) { vPrioInversionTraceGive((void *)(pxQueue)); } } while (0)
+
+/* Called before the TCB priority changes: (pxTCB)->uxPriority is the old one. */
+#define traceTASK_PRIORITY_INHERIT(pxTCB, uxNewPriority) \
+  vPrioInversionTracePriority((void *)(pxTCB), (unsigned long)(pxTCB)->uxPriority, (unsigned long)(uxNewPriority))
+
+#define traceTASK_PRIORITY_DISINHERIT(pxTCB, uxNewPriority) \
+  vPrioInversionTracePriority((void *)(pxTCB), (unsigned long)(pxTCB)->uxPriority, (unsigned long)(uxNewPriority))
+
+#endif /* PRIO_INVERSION_TRACE_H */
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : prio_queue.h
+  * @brief          : Queue that always returns the most urgent item
+  ******************************************************************************
+  * @attention
+  *
+  * xQueueSendToFront() gives a queue two classes of items, and puts the
+  * urgent ones in reverse order: the last one sent to the front comes out
+  * first. Here every item carries a key, smaller is more urgent, and a
+  * receive always returns the item with the smallest key; items with equal
+  * keys come out in the order they were sent.
+  *
+  * The key can be a priority (0 = most urgent) or an absolute deadline in
+  * ticks, xTaskGetTickCount() + budget. Keys are compared as
+  * (int32_t)(a - b) so deadlines keep their order across the tick count
+  * wrap; all keys in the queue at the same time must lie within 2^31 of
+  * each other, which small priority numbers always do.
+  *
+  * The queue is a binary heap of small (key, sequence, slot) entries over a
+  * fixed array of item slots: send and receive are O(log n) and copy the
+  * item once, the heap never moves item data. Everything happens in short
+  * critical sections; waiting tasks sleep on their task notification.
+  *
+  *   xQueue = xPrioQueueCreate(8, sizeof(QMsg));
+  *   xPrioQueueSend(xQueue, &msg, PRIO_NORMAL, portMAX_DELAY);
+  *   xPrioQueueSendFromISR(xQueue, &alarm, PRIO_URGENT, &xHigherPriorityTaskWoken);
+  *   ...
+  *   xPrioQueueReceive(xQueue, &msg, NULL, portMAX_DELAY);  // the alarm first
+  *
+  ******************************************************************************
+  */
+
+#ifndef PRIO_QUEUE_H
+#define PRIO_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+typedef struct PrioQueue *PrioQueueHandle_t;
+
+/* NULL when the heap is exhausted. */
+PrioQueueHandle_t xPrioQueueCreate(UBaseType_t uxLength, UBaseType_t uxItemSize);
+void vPrioQueueDelete(PrioQueueHandle_t xQueue);
+
+/* pdFAIL when the queue stayed full / empty for xTicksToWait. The FromISR
+variants never wait. pulKey may be NULL. */
+BaseType_t xPrioQueueSend(PrioQueueHandle_t xQueue, const void *pvItem, uint32_t ulKey, TickType_t xTicksToWait);
+BaseType_t xPrioQueueSendFromISR(PrioQueueHandle_t xQueue, const void *pvItem, uint32_t ulKey,
+                                 BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xPrioQueueReceive(PrioQueueHandle_t xQueue, void *pvItem, uint32_t *pulKey, TickType_t xTicksToWait);
+BaseType_t xPrioQueueReceiveFromISR(PrioQueueHandle_t xQueue, void *pvItem, uint32_t *pulKey,
+                                    BaseType_t *pxHigherPriorityTaskWoken);
+
+/* Key of the most urgent item without removing it, pdFAIL when empty. */
+BaseType_t xPrioQueuePeekKey(PrioQueueHandle_t xQueue, uint32_t *pulKey);
+
+UBaseType_t uxPrioQueueMessagesWaiting(PrioQueueHandle_t xQueue);
+UBaseType_t uxPrioQueueSpacesAvailable(PrioQueueHandle_t xQueue);
+
+/* Number passed to tracePRIO_QUEUE_EVENT(), as vQueueSetQueueNumber() for a
+kernel queue. 0 (the default) = not traced. */
+void vPrioQueueSetQueueNumber(PrioQueueHandle_t xQueue, UBaseType_t uxQueueNumber);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIO_QUEUE_H */
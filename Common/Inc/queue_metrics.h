@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file           : queue_metrics.h
+  * @brief          : Occupancy, blocking time and failure counters per queue
+  ******************************************************************************
+  * @attention
+  *
+  * Every watched queue, semaphore, stream / message buffer or PrioQueue gets
+  * a name and a set of counters, kept by the hooks of queue_metrics_trace.h:
+  *
+  *   level        fill level now and its peak (items, or bytes for stream
+  *                and message buffers, length words included)
+  *   sends        successful sends, and the ones that failed because the
+  *                object stayed full for the whole timeout (0 = immediately)
+  *   receives     the same for the empty side
+  *   blocked      how often a sender / receiver had to wait, the total and
+  *                longest wait and a histogram of the waits in powers of two
+  *                of microseconds
+  *
+  * A sampler task reads every level each period into a short time series
+  * and a histogram of how full the object was (empty, up to 1/4, 1/2, 3/4,
+  * below full, full): the share of samples at "full" is how often a
+  * non-blocking send would have failed at that moment.
+  *
+  * Kernel objects also go into the queue registry under the same name, so a
+  * debugger shows it. Wait times are measured with the perf counter
+  * (vPerfCounterInit() first) and fall back to ticks for waits over 1 s.
+  * Only the hooks write the counters, inside short critical sections.
+  *
+  *   xQueueMetricsAddPrioQueue(Queue_Handle, "Queue");
+  *   xQueueMetricsAddStreamBuffer(MessageBuffer_Handle, "MsgBuf");
+  *   xQueueMetricsStartSampler(pdMS_TO_TICKS(100), 5);
+  *   ...
+  *   vQueueMetricsDump(print);
+  *
+  ******************************************************************************
+  */
+
+#ifndef QUEUE_METRICS_H
+#define QUEUE_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "stream_buffer.h"
+#include "prio_queue.h"
+
+/* Watched objects, at most configQUEUE_REGISTRY_SIZE of them are kernel
+objects. */
+#ifndef QUEUE_METRICS_MAX
+#define QUEUE_METRICS_MAX          8U
+#endif
+
+/* Tasks that can be blocked on watched objects at the same time. */
+#ifndef QUEUE_METRICS_MAX_WAITERS
+#define QUEUE_METRICS_MAX_WAITERS  8U
+#endif
+
+/* Length of the occupancy time series, per object. */
+#ifndef QUEUE_METRICS_SAMPLES
+#define QUEUE_METRICS_SAMPLES      32U
+#endif
+
+#define QUEUE_METRICS_WAIT_BUCKETS 16U    /* < 2 us ... >= 32 ms */
+#define QUEUE_METRICS_FILL_BUCKETS 6U     /* 0, <= 1/4, <= 1/2, <= 3/4, < full, full */
+
+/* pdFAIL when the table is full. The message buffer variant is the stream
+buffer one, a MessageBufferHandle_t is a StreamBufferHandle_t. */
+BaseType_t xQueueMetricsAddQueue(QueueHandle_t xQueue, const char *pcName);
+BaseType_t xQueueMetricsAddStreamBuffer(StreamBufferHandle_t xStreamBuffer, const char *pcName);
+BaseType_t xQueueMetricsAddPrioQueue(PrioQueueHandle_t xQueue, const char *pcName);
+
+/* Starts the task that samples the levels every xPeriod ticks (periodic.h,
+INCLUDE_vTaskDelayUntil 1). Give it a priority above the tasks using the
+objects, or a sample shows the level only when they are idle. */
+BaseType_t xQueueMetricsStartSampler(TickType_t xPeriod, UBaseType_t uxPriority);
+
+/* One sample of every object, for applications with their own periodic
+task instead of the sampler. */
+void vQueueMetricsSample(void);
+
+/* Clears the counters, peaks and samples, the levels stay. */
+void vQueueMetricsReset(void);
+
+/* Calls pxWrite with a few lines per object. */
+void vQueueMetricsDump(void (*pxWrite)(const char *pcLine));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUEUE_METRICS_H */
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file           : queue_metrics_trace.h
+  * @brief          : Kernel trace macros feeding the queue metrics
+  ******************************************************************************
+  * @attention
+  *
+  * Include at the end of FreeRTOSConfig.h (USER CODE BEGIN Defines), with
+  * configUSE_TRACE_FACILITY 1:
+  *
+  *   #include "queue_metrics_trace.h"
+  *
+  * The macros expand inside queue.c, stream_buffer.c and prio_queue.c. An
+  * object takes part once xQueueMetricsAddxxx() has given it a number
+  * (uxQueueNumber / uxStreamBufferNumber, 0 = not watched), every other
+  * queue, semaphore and buffer only pays the test of that field.
+  *
+  * Only queue and stream buffer macros are defined, so this file can be
+  * combined with runtime_stats_trace.h but not with timeline_trace.h.
+  *
+  * This file is included by FreeRTOS.h itself, so it must not include any
+  * FreeRTOS header and the hooks only use plain C types.
+  *
+  ******************************************************************************
+  */
+
+#ifndef QUEUE_METRICS_TRACE_H
+#define QUEUE_METRICS_TRACE_H
+
+#define QUEUE_METRICS_SEND                     0UL
+#define QUEUE_METRICS_SEND_FAILED              1UL
+#define QUEUE_METRICS_SEND_FROM_ISR            2UL
+#define QUEUE_METRICS_SEND_FROM_ISR_FAILED     3UL
+#define QUEUE_METRICS_BLOCK_SEND               4UL
+#define QUEUE_METRICS_RECEIVE                  5UL
+#define QUEUE_METRICS_RECEIVE_FAILED           6UL
+#define QUEUE_METRICS_RECEIVE_FROM_ISR         7UL
+#define QUEUE_METRICS_RECEIVE_FROM_ISR_FAILED  8UL
+#define QUEUE_METRICS_BLOCK_RECEIVE            9UL
+
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+
+/* ulLevel is the fill level after the call: items, or bytes for stream and
+message buffers. */
+void vQueueMetricsEvent(unsigned long ulNumber, unsigned long ulEvent, unsigned long ulLevel);
+
+#endif
+
+/* Queues, semaphores and mutexes. The kernel calls the macros before it
+updates uxMessagesWaiting. */
+#define queuemetricsQUEUE(ev, pxQueue, delta)                                      \
+  do                                                                               \
+  {                                                                                \
+    if ((pxQueue)->uxQueueNumber != 0U)                                            \
+    {                                                                              \
+      vQueueMetricsEvent((unsigned long)(pxQueue)->uxQueueNumber, (ev),            \
+                         (unsigned long)((pxQueue)->uxMessagesWaiting + (delta))); \
+    }                                                                              \
+  } while (0)
+
+#define traceQUEUE_SEND(pxQueue)                    queuemetricsQUEUE(QUEUE_METRICS_SEND, pxQueue, 1)
+#define traceQUEUE_SEND_FAILED(pxQueue)             queuemetricsQUEUE(QUEUE_METRICS_SEND_FAILED, pxQueue, 0)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           queuemetricsQUEUE(QUEUE_METRICS_SEND_FROM_ISR, pxQueue, 1)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)    queuemetricsQUEUE(QUEUE_METRICS_SEND_FROM_ISR_FAILED, pxQueue, 0)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)        queuemetricsQUEUE(QUEUE_METRICS_BLOCK_SEND, pxQueue, 0)
+#define traceQUEUE_RECEIVE(pxQueue)                 queuemetricsQUEUE(QUEUE_METRICS_RECEIVE, pxQueue, -1)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)          queuemetricsQUEUE(QUEUE_METRICS_RECEIVE_FAILED, pxQueue, 0)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)        queuemetricsQUEUE(QUEUE_METRICS_RECEIVE_FROM_ISR, pxQueue, -1)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue) queuemetricsQUEUE(QUEUE_METRICS_RECEIVE_FROM_ISR_FAILED, pxQueue, 0)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)     queuemetricsQUEUE(QUEUE_METRICS_BLOCK_RECEIVE, pxQueue, 0)
+
+/* Stream and message buffers. The kernel calls the macros after the copy,
+the FromISR ones also when nothing was copied. */
+#define queuemetricsSTREAM(ev, xStreamBuffer)                                        \
+  do                                                                                 \
+  {                                                                                  \
+    if ((xStreamBuffer)->uxStreamBufferNumber != 0U)                                 \
+    {                                                                                \
+      vQueueMetricsEvent((unsigned long)(xStreamBuffer)->uxStreamBufferNumber, (ev), \
+                         (unsigned long)xStreamBufferBytesAvailable(xStreamBuffer)); \
+    }                                                                                \
+  } while (0)
+
+#define traceSTREAM_BUFFER_SEND(xStreamBuffer, xBytesSent) \
+  queuemetricsSTREAM(((xBytesSent) != 0U) ? QUEUE_METRICS_SEND : QUEUE_METRICS_SEND_FAILED, xStreamBuffer)
+#define traceSTREAM_BUFFER_SEND_FAILED(xStreamBuffer) \
+  queuemetricsSTREAM(QUEUE_METRICS_SEND_FAILED, xStreamBuffer)
+#define traceSTREAM_BUFFER_SEND_FROM_ISR(xStreamBuffer, xBytesSent) \
+  queuemetricsSTREAM(((xBytesSent) != 0U) ? QUEUE_METRICS_SEND_FROM_ISR : QUEUE_METRICS_SEND_FROM_ISR_FAILED, \
+                     xStreamBuffer)
+#define traceBLOCKING_ON_STREAM_BUFFER_SEND(xStreamBuffer) \
+  queuemetricsSTREAM(QUEUE_METRICS_BLOCK_SEND, xStreamBuffer)
+#define traceSTREAM_BUFFER_RECEIVE(xStreamBuffer, xReceivedLength) \
+  queuemetricsSTREAM(((xReceivedLength) != 0U) ? QUEUE_METRICS_RECEIVE : QUEUE_METRICS_RECEIVE_FAILED, xStreamBuffer)
+#define traceSTREAM_BUFFER_RECEIVE_FAILED(xStreamBuffer) \
+  queuemetricsSTREAM(QUEUE_METRICS_RECEIVE_FAILED, xStreamBuffer)
+#define traceSTREAM_BUFFER_RECEIVE_FROM_ISR(xStreamBuffer, xReceivedLength) \
+  queuemetricsSTREAM(((xReceivedLength) != 0U) ? QUEUE_METRICS_RECEIVE_FROM_ISR                       \
+                                               : QUEUE_METRICS_RECEIVE_FROM_ISR_FAILED, xStreamBuffer)
+#define traceBLOCKING_ON_STREAM_BUFFER_RECEIVE(xStreamBuffer) \
+  queuemetricsSTREAM(QUEUE_METRICS_BLOCK_RECEIVE, xStreamBuffer)
+
+/* PrioQueue (prio_queue.c): the level is passed explicitly. */
+#define tracePRIO_QUEUE_EVENT(uxQueueNumber, ev, uxLevel)                                \
+  do                                                                                     \
+  {                                                                                      \
+    if ((uxQueueNumber) != 0U)                                                           \
+    {                                                                                    \
+      vQueueMetricsEvent((unsigned long)(uxQueueNumber), (ev), (unsigned long)(uxLevel)); \
+    }                                                                                    \
+  } while (0)
+
+#endif /* QUEUE_METRICS_TRACE_H */
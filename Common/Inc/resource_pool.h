@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file           : resource_pool.h
+  * @brief          : Counting semaphore that hands out the resources themselves
+  ******************************************************************************
+  * @attention
+  *
+  * A pool of N resource handles (buffers, DMA descriptors, ...). The count
+  * of free units and the free list are one object, so a take returns the
+  * resource it got instead of a permission to go and find one, and a give
+  * returns a specific resource.
+  *
+  * Any number of units can be taken or given in one call, from tasks and
+  * from interrupts. A batch is all or nothing and costs one critical section
+  * plus one notification per task it wakes, whatever its size: an ISR that
+  * completes K transfers gives the K buffers back with one
+  * vResourcePoolGiveBatchFromISR() instead of K xSemaphoreGiveFromISR().
+  *
+  * Waiting tasks are served strictly in arrival order, a large batch is not
+  * overtaken by later small ones. A waiting task sleeps on its task
+  * notification, the giver hands it the resources directly.
+  *
+  *   static uint8_t ucBuffers[4][64];
+  *   static void *pvBuffers[4] = { ucBuffers[0], ucBuffers[1], ucBuffers[2], ucBuffers[3] };
+  *
+  *   xPool = xResourcePoolCreate(pvBuffers, 4);
+  *   pvBuffer = pvResourcePoolTake(xPool, portMAX_DELAY);
+  *   ...
+  *   vResourcePoolGive(xPool, pvBuffer);
+  *
+  ******************************************************************************
+  */
+
+#ifndef RESOURCE_POOL_H
+#define RESOURCE_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FreeRTOS.h"
+
+typedef struct ResourcePool *ResourcePoolHandle_t;
+
+/* Copies the uxCount handles, all of them start free. NULL when the heap is
+exhausted. */
+ResourcePoolHandle_t xResourcePoolCreate(void * const *ppvResources, UBaseType_t uxCount);
+void vResourcePoolDelete(ResourcePoolHandle_t xPool);
+
+/* NULL on timeout. */
+void *pvResourcePoolTake(ResourcePoolHandle_t xPool, TickType_t xTicksToWait);
+void *pvResourcePoolTakeFromISR(ResourcePoolHandle_t xPool);
+void vResourcePoolGive(ResourcePoolHandle_t xPool, void *pvResource);
+void vResourcePoolGiveFromISR(ResourcePoolHandle_t xPool, void *pvResource, BaseType_t *pxHigherPriorityTaskWoken);
+
+/* uxCount units into ppvResources, or none: pdFAIL on timeout. The FromISR
+variant never waits and fails while tasks are waiting. */
+BaseType_t xResourcePoolTakeBatch(ResourcePoolHandle_t xPool, void **ppvResources, UBaseType_t uxCount,
+                                  TickType_t xTicksToWait);
+BaseType_t xResourcePoolTakeBatchFromISR(ResourcePoolHandle_t xPool, void **ppvResources, UBaseType_t uxCount);
+
+void vResourcePoolGiveBatch(ResourcePoolHandle_t xPool, void * const *ppvResources, UBaseType_t uxCount);
+void vResourcePoolGiveBatchFromISR(ResourcePoolHandle_t xPool, void * const *ppvResources, UBaseType_t uxCount,
+                                   BaseType_t *pxHigherPriorityTaskWoken);
+
+UBaseType_t uxResourcePoolGetFree(ResourcePoolHandle_t xPool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESOURCE_POOL_H */
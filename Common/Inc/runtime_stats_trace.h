@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file           : runtime_stats_trace.h
+  * @brief          : Kernel trace macros feeding the runtime statistics
+  ******************************************************************************
+  * @attention
+  *
+  * Include at the end of FreeRTOSConfig.h (USER CODE BEGIN Defines), with
+  * configUSE_TRACE_FACILITY 1:
+  *
+  *   #include "runtime_stats_trace.h"
+  *
+  * The macros expand inside tasks.c, which is why they may look at
+  * pxCurrentTCB. The task number is the kernel's uxTCBNumber, the same value
+  * uxTaskGetSystemState() reports in xTaskNumber.
+  *
+  * This file is included by FreeRTOS.h itself, so it must not include any
+  * FreeRTOS header and the hooks only use plain C types.
+  *
+  ******************************************************************************
+  */
+
+#ifndef RUNTIME_STATS_TRACE_H
+#define RUNTIME_STATS_TRACE_H
+
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+
+void vRuntimeStatsSwitchedIn(unsigned long ulTaskNumber);
+void vRuntimeStatsTick(void);
+
+#endif
+
+/* Called on every context switch, after the next task was selected. */
+#define traceTASK_SWITCHED_IN() \
+  vRuntimeStatsSwitchedIn((unsigned long)pxCurrentTCB->uxTCBNumber)
+
+/* Called on every tick, so the running task is charged at least once per
+tick and a long run never wraps the 32 bit counter. */
+#define traceTASK_INCREMENT_TICK(xTickCount) \
+  vRuntimeStatsTick()
+
+#endif /* RUNTIME_STATS_TRACE_H */
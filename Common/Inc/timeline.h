@@ -0,0 +1,139 @@
+/**
+  ******************************************************************************
+  * @file           : timeline.h
+  * @brief          : Kernel event recorder for a scheduling timeline
+  ******************************************************************************
+  * @attention
+  *
+  * The kernel trace hooks (timeline_trace.h) write one 12 byte record per
+  * event into a ring in RAM: task switch in / out, queue and semaphore send,
+  * receive and block, event group set / wait / sync, stream and message
+  * buffer send / receive / block, plus the interrupts the application marks
+  * with vTimelineIsrEnter() / vTimelineIsrExit(). Timestamps are perf
+  * counter counts, CPU cycles on the target, ns on the host build. When the
+  * ring is full the oldest records are overwritten.
+  *
+  * ulTimelineSave() streams the ring as a file: a TimelineHeader_t, the name
+  * table (tasks, registered queues, vTimelineSetName() objects), then the
+  * records, oldest first. Host/tools/timeline2json.c turns it into Chrome
+  * trace JSON for chrome://tracing or ui.perfetto.dev. On the host build
+  * HOST_TRACE=<file> saves it at exit.
+  *
+  * This file is included by FreeRTOSConfig.h through timeline_trace.h and
+  * by the converter, so it only uses plain C types.
+  *
+  ******************************************************************************
+  */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Records in the ring (power of two), 12 bytes each. */
+#ifndef TIMELINE_RECORDS
+#define TIMELINE_RECORDS     1024U
+#endif
+
+/* Tasks and named objects. */
+#ifndef TIMELINE_MAX_NAMES
+#define TIMELINE_MAX_NAMES   24U
+#endif
+
+#define TIMELINE_NAME_LEN    16U
+#define TIMELINE_VERSION     1U
+
+typedef enum
+{
+  TIMELINE_SYNC = 0,              /* keeps the 32 bit time unambiguous */
+  TIMELINE_TASK_IN,
+  TIMELINE_TASK_OUT,
+  TIMELINE_ISR_ENTER,             /* value: interrupt id */
+  TIMELINE_ISR_EXIT,
+  TIMELINE_QUEUE_SEND,            /* queue events, value: items before */
+  TIMELINE_QUEUE_SEND_FAILED,
+  TIMELINE_QUEUE_SEND_FROM_ISR,
+  TIMELINE_QUEUE_SEND_FROM_ISR_FAILED,
+  TIMELINE_QUEUE_BLOCK_SEND,
+  TIMELINE_QUEUE_RECEIVE,
+  TIMELINE_QUEUE_RECEIVE_FAILED,
+  TIMELINE_QUEUE_RECEIVE_FROM_ISR,
+  TIMELINE_QUEUE_RECEIVE_FROM_ISR_FAILED,
+  TIMELINE_QUEUE_BLOCK_RECEIVE,
+  TIMELINE_EVENT_SET,             /* event group events, value: bits */
+  TIMELINE_EVENT_SET_FROM_ISR,
+  TIMELINE_EVENT_WAIT_BLOCK,
+  TIMELINE_EVENT_WAIT_END,        /* value: 1 on timeout */
+  TIMELINE_EVENT_SYNC_BLOCK,
+  TIMELINE_EVENT_SYNC_END,        /* value: 1 on timeout */
+  TIMELINE_STREAM_SEND,           /* stream / message buffer, value: bytes */
+  TIMELINE_STREAM_SEND_FAILED,
+  TIMELINE_STREAM_SEND_FROM_ISR,
+  TIMELINE_STREAM_BLOCK_SEND,
+  TIMELINE_STREAM_RECEIVE,
+  TIMELINE_STREAM_RECEIVE_FAILED,
+  TIMELINE_STREAM_RECEIVE_FROM_ISR,
+  TIMELINE_STREAM_BLOCK_RECEIVE,
+  TIMELINE_EVENT_COUNT
+} TimelineEvent_t;
+
+typedef struct
+{
+  uint32_t ulTime;      /* perf counter */
+  uint32_t ulObject;    /* handle (low 32 bits) or task number */
+  uint8_t ucEvent;      /* TimelineEvent_t */
+  uint8_t ucTask;       /* task running when it happened */
+  uint16_t usValue;
+} TimelineRecord_t;
+
+typedef struct
+{
+  uint32_t ulId;        /* task number or object handle */
+  uint8_t ucIsTask;
+  uint8_t ucReserved[3];
+  char cName[TIMELINE_NAME_LEN];
+} TimelineName_t;
+
+typedef struct
+{
+  char cMagic[4];       /* "FRTL" */
+  uint16_t usVersion;
+  uint16_t usRecordSize;
+  uint32_t ulCounterHz;
+  uint32_t ulNames;
+  uint32_t ulRecords;
+  uint32_t ulOverwritten;
+} TimelineHeader_t;
+
+/* Host build: saves the file named by HOST_TRACE at exit. Recording itself
+needs no init, it starts with the first kernel event. */
+void vTimelineInit(void);
+
+/* Objects without a queue registry entry, e.g. stream buffers. */
+void vTimelineSetName(const void *pvObject, const char *pcName);
+
+/* First and last line of an interrupt handler or callback. */
+void vTimelineIsrEnter(uint32_t ulIrq);
+void vTimelineIsrExit(void);
+
+/* Streams the file, recording is paused meanwhile. Returns the number of
+records written. */
+uint32_t ulTimelineSave(void (*pxWrite)(const void *pvData, size_t xLength));
+
+/* Called by the hooks in timeline_trace.h. */
+void vTimelineEvent(uint32_t ulEvent, const void *pvObject, uint32_t ulValue);
+void vTimelineSwitchedIn(uint32_t ulTask);
+void vTimelineSwitchedOut(void);
+void vTimelineTaskCreated(uint32_t ulTask, const char *pcName);
+void vTimelineTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMELINE_H */
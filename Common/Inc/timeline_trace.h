@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : timeline_trace.h
+  * @brief          : Kernel trace macros feeding the timeline recorder
+  ******************************************************************************
+  * @attention
+  *
+  * Include at the end of FreeRTOSConfig.h (USER CODE BEGIN Defines), with
+  * configUSE_TRACE_FACILITY 1:
+  *
+  *   #include "timeline_trace.h"
+  *
+  * The macros expand inside tasks.c, queue.c, event_groups.c and
+  * stream_buffer.c, which is why they may look at TCB and queue fields.
+  * They define the same trace macros as prio_inversion_trace.h and
+  * runtime_stats_trace.h, an example includes only one of them.
+  *
+  * This file is included by FreeRTOS.h itself, so it must not include any
+  * FreeRTOS header and the hooks only use plain C types.
+  *
+  ******************************************************************************
+  */
+
+#ifndef TIMELINE_TRACE_H
+#define TIMELINE_TRACE_H
+
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+#include "timeline.h"
+#endif
+
+/* Tasks */
+#define traceTASK_CREATE(pxNewTCB) \
+  vTimelineTaskCreated((uint32_t)(pxNewTCB)->uxTCBNumber, (pxNewTCB)->pcTaskName)
+
+#define traceTASK_SWITCHED_OUT()  vTimelineSwitchedOut()
+
+#define traceTASK_SWITCHED_IN()   vTimelineSwitchedIn((uint32_t)pxCurrentTCB->uxTCBNumber)
+
+#define traceTASK_INCREMENT_TICK(xTickCount)  vTimelineTick()
+
+/* Queues, semaphores and mutexes: value is the number of items before */
+#define timelineQUEUE(ev, pxQueue) \
+  vTimelineEvent((ev), (const void *)(pxQueue), (uint32_t)(pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcQueueName)  vTimelineSetName((const void *)(xQueue), (pcQueueName))
+
+#define traceQUEUE_SEND(pxQueue)                    timelineQUEUE(TIMELINE_QUEUE_SEND, pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)             timelineQUEUE(TIMELINE_QUEUE_SEND_FAILED, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           timelineQUEUE(TIMELINE_QUEUE_SEND_FROM_ISR, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)    timelineQUEUE(TIMELINE_QUEUE_SEND_FROM_ISR_FAILED, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)        timelineQUEUE(TIMELINE_QUEUE_BLOCK_SEND, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)                 timelineQUEUE(TIMELINE_QUEUE_RECEIVE, pxQueue)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)          timelineQUEUE(TIMELINE_QUEUE_RECEIVE_FAILED, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)        timelineQUEUE(TIMELINE_QUEUE_RECEIVE_FROM_ISR, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue) timelineQUEUE(TIMELINE_QUEUE_RECEIVE_FROM_ISR_FAILED, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)     timelineQUEUE(TIMELINE_QUEUE_BLOCK_RECEIVE, pxQueue)
+
+/* Event groups: value is the bits set or waited for (low 16) */
+#define traceEVENT_GROUP_SET_BITS(xEventGroup, uxBitsToSet) \
+  vTimelineEvent(TIMELINE_EVENT_SET, (const void *)(xEventGroup), (uint32_t)(uxBitsToSet))
+#define traceEVENT_GROUP_SET_BITS_FROM_ISR(xEventGroup, uxBitsToSet) \
+  vTimelineEvent(TIMELINE_EVENT_SET_FROM_ISR, (const void *)(xEventGroup), (uint32_t)(uxBitsToSet))
+#define traceEVENT_GROUP_WAIT_BITS_BLOCK(xEventGroup, uxBitsToWaitFor) \
+  vTimelineEvent(TIMELINE_EVENT_WAIT_BLOCK, (const void *)(xEventGroup), (uint32_t)(uxBitsToWaitFor))
+#define traceEVENT_GROUP_WAIT_BITS_END(xEventGroup, uxBitsToWaitFor, xTimeoutOccurred) \
+  vTimelineEvent(TIMELINE_EVENT_WAIT_END, (const void *)(xEventGroup), (uint32_t)(xTimeoutOccurred))
+#define traceEVENT_GROUP_SYNC_BLOCK(xEventGroup, uxBitsToSet, uxBitsToWaitFor) \
+  vTimelineEvent(TIMELINE_EVENT_SYNC_BLOCK, (const void *)(xEventGroup), (uint32_t)(uxBitsToWaitFor))
+#define traceEVENT_GROUP_SYNC_END(xEventGroup, uxBitsToSet, uxBitsToWaitFor, xTimeoutOccurred) \
+  vTimelineEvent(TIMELINE_EVENT_SYNC_END, (const void *)(xEventGroup), (uint32_t)(xTimeoutOccurred))
+
+/* Stream and message buffers: value is the number of bytes */
+#define traceSTREAM_BUFFER_SEND(xStreamBuffer, xBytesSent) \
+  vTimelineEvent(TIMELINE_STREAM_SEND, (const void *)(xStreamBuffer), (uint32_t)(xBytesSent))
+#define traceSTREAM_BUFFER_SEND_FAILED(xStreamBuffer) \
+  vTimelineEvent(TIMELINE_STREAM_SEND_FAILED, (const void *)(xStreamBuffer), 0U)
+#define traceSTREAM_BUFFER_SEND_FROM_ISR(xStreamBuffer, xBytesSent) \
+  vTimelineEvent(TIMELINE_STREAM_SEND_FROM_ISR, (const void *)(xStreamBuffer), (uint32_t)(xBytesSent))
+#define traceBLOCKING_ON_STREAM_BUFFER_SEND(xStreamBuffer) \
+  vTimelineEvent(TIMELINE_STREAM_BLOCK_SEND, (const void *)(xStreamBuffer), 0U)
+#define traceSTREAM_BUFFER_RECEIVE(xStreamBuffer, xReceivedLength) \
+  vTimelineEvent(TIMELINE_STREAM_RECEIVE, (const void *)(xStreamBuffer), (uint32_t)(xReceivedLength))
+#define traceSTREAM_BUFFER_RECEIVE_FAILED(xStreamBuffer) \
+  vTimelineEvent(TIMELINE_STREAM_RECEIVE_FAILED, (const void *)(xStreamBuffer), 0U)
+#define traceSTREAM_BUFFER_RECEIVE_FROM_ISR(xStreamBuffer, xReceivedLength) \
+  vTimelineEvent(TIMELINE_STREAM_RECEIVE_FROM_ISR, (const void *)(xStreamBuffer), (uint32_t)(xReceivedLength))
+#define traceBLOCKING_ON_STREAM_BUFFER_RECEIVE(xStreamBuffer) \
+  vTimelineEvent(TIMELINE_STREAM_BLOCK_RECEIVE, (const void *)(xStreamBuffer), 0U)
+
+#endif /* TIMELINE_TRACE_H */
@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file           : uart_log.h
+  * @brief          : Non-blocking log output on a UART
+  ******************************************************************************
+  * @attention
+  *
+  * HAL_UART_Transmit(&huart1, ..., HAL_MAX_DELAY) keeps the calling task busy
+  * for ~87 us per byte at 115200 baud, a 60 byte line costs ~5 ms. Here the
+  * caller only copies its text into a ring of fixed size records and returns;
+  * a single low priority "Log" task sends the records to the UART.
+  *
+  * The ring is lock-free: a writer claims all records it needs with one
+  * compare-and-swap, fills them and publishes each one with a sequence
+  * number, so a writer that is preempted never blocks another writer and one
+  * line is never interleaved with another. When the ring is full the whole
+  * line is dropped and counted in ulUartLogGetDropped(), the writer never
+  * waits for the UART.
+  *
+  * xUartLogWriteFromISR() uses the same ring from interrupt callbacks: it
+  * copies a preformatted line (no printf, no heap, no blocking) and at most
+  * wakes the "Log" task, so the time spent in the ISR only depends on the
+  * length of the line, never on the UART.
+  *
+  ******************************************************************************
+  */
+
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "main.h"
+#include "FreeRTOS.h"
+
+/* Payload bytes per record, a record is this plus 8 bytes of header. */
+#ifndef UART_LOG_RECORD_SIZE
+#define UART_LOG_RECORD_SIZE     24U
+#endif
+
+/* Number of records in the ring (power of two): 64 x 32 bytes = 2 KB. */
+#ifndef UART_LOG_RECORDS
+#define UART_LOG_RECORDS         64U
+#endif
+
+/* Longest line xUartLogPrintf() formats, longer output is truncated. */
+#ifndef UART_LOG_LINE_MAX
+#define UART_LOG_LINE_MAX        128U
+#endif
+
+#ifndef UART_LOG_TASK_PRIORITY
+#define UART_LOG_TASK_PRIORITY   tskIDLE_PRIORITY
+#endif
+
+#ifndef UART_LOG_TASK_STACK
+#define UART_LOG_TASK_STACK      256U
+#endif
+
+/* Creates the "Log" task that drains the ring into huart. Text written
+before the call is kept and sent once the scheduler runs. */
+BaseType_t xUartLogInit(UART_HandleTypeDef *huart);
+
+/* Task context. Returns xLength, or 0 when the line was dropped. */
+size_t xUartLogWrite(const char *pcData, size_t xLength);
+size_t xUartLogPrintf(const char *pcFormat, ...) __attribute__((format(printf, 1, 2)));
+
+/* Interrupt context (HAL_xxx_Callback). Returns xLength, or 0 when the
+line was dropped. */
+size_t xUartLogWriteFromISR(const char *pcData, size_t xLength, BaseType_t *pxHigherPriorityTaskWoken);
+
+/* Bytes lost because the ring was full, since start up. */
+uint32_t ulUartLogGetDropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_LOG_H */
@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file           : uart_rx.h
+  * @brief          : UART reception with circular DMA and idle line detection
+  ******************************************************************************
+  * @attention
+  *
+  * HAL_UART_Receive_IT(huart, &rx_data, 1) takes one interrupt per byte and
+  * the callback has to re-arm the reception every time; a byte that arrives
+  * before it is re-armed is lost. Here the DMA writes into a circular buffer
+  * without ever stopping and the CPU is only interrupted when the line goes
+  * idle after a burst (and at half / full buffer for long bursts).
+  *
+  * The DMA buffer itself is a single producer / single consumer ring: the
+  * DMA is the producer, HAL_UARTEx_RxEventCallback() only publishes how far
+  * it got and wakes the reader task, once per burst. Bytes are copied once,
+  * from the DMA buffer to the reader, and no lock is taken on either side.
+  *
+  * There is one reader task. It sleeps on its task notification, so it must
+  * not use the notification for anything else while it is in
+  * xUartRxRead(). When it falls behind by more than half the buffer the DMA
+  * may already be overwriting the unread data: it is dropped and counted in
+  * ulUartRxGetDropped(). An application that handles the input in the
+  * interrupt instead calls xUartRxReadFromISR() from
+  * HAL_UARTEx_RxEventCallback(), after vUartRxEventFromISR(), and gets only
+  * the bytes that are new since the previous event; it then has no reader
+  * task.
+  *
+  * The application forwards the two HAL callbacks:
+  *
+  *   void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+  *   {
+  *     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  *     vUartRxEventFromISR(huart, Size, &xHigherPriorityTaskWoken);
+  *     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+  *   }
+  *
+  *   void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+  *   {
+  *     vUartRxErrorFromISR(huart);
+  *   }
+  *
+  * USART1 RX needs a DMA stream in circular mode (DMA2 Stream2 Channel 4 on
+  * the STM32F429) linked to the UART handle, see the .ioc of the examples.
+  *
+  ******************************************************************************
+  */
+
+#ifndef UART_RX_H
+#define UART_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "main.h"
+#include "FreeRTOS.h"
+
+/* DMA buffer in bytes (power of two). Half of it must hold everything that
+can arrive while the reader is not running: 128 bytes are ~11 ms at
+115200 baud. */
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE      256U
+#endif
+
+/* Starts the circular reception on huart. pdFAIL when the HAL refuses it. */
+BaseType_t xUartRxInit(UART_HandleTypeDef *huart);
+
+/* Interrupt context, from HAL_UARTEx_RxEventCallback() and
+HAL_UART_ErrorCallback(). Calls for another UART are ignored. */
+void vUartRxEventFromISR(UART_HandleTypeDef *huart, uint16_t Size, BaseType_t *pxHigherPriorityTaskWoken);
+void vUartRxErrorFromISR(UART_HandleTypeDef *huart);
+
+/* Reader task only. Copies up to xLength received bytes, waits up to
+xTicksToWait for the first one. Returns the number of bytes copied, 0 on
+timeout. */
+size_t xUartRxRead(void *pvBuffer, size_t xLength, TickType_t xTicksToWait);
+
+/* Interrupt context, instead of a reader task. Copies up to xLength
+received bytes without waiting, returns the count (0 when there are none):
+call it until it returns 0. */
+size_t xUartRxReadFromISR(void *pvBuffer, size_t xLength);
+
+/* Bytes lost because the reader fell behind, since start up. Bytes cut by
+a line error before the event handler reported them are not counted. */
+uint32_t ulUartRxGetDropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_RX_H */
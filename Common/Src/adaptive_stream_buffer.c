@@ -0,0 +1,227 @@
+/**
+  ******************************************************************************
+  * @file           : adaptive_stream_buffer.c
+  * @brief          : Stream buffer whose trigger level follows the traffic
+  ******************************************************************************
+  * @attention
+  *
+  * The data goes through a stock stream buffer, but the consumer never blocks
+  * in it: it waits on its task notification, with a timeout that ends
+  * xIdleTimeout after the last write. The producer notifies when the fill
+  * level reaches the trigger level and when it writes into an empty buffer
+  * (which starts the reader's idle timeout), so the other writes below the
+  * trigger cost no context switch at all.
+  *
+  * On every hand-over the consumer measures the arrival rate (bytes written
+  * since the previous hand-over / ticks), smooths it and sets the trigger
+  * level to the bytes expected within one idle timeout.
+  *
+  ******************************************************************************
+  */
+
+#include <stdint.h>
+
+#include "adaptive_stream_buffer.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+/* Rate in bytes per tick, 8 fractional bits. */
+#define ASB_RATE_SHIFT         8U
+/* Smoothing: new = old + (sample - old) / 2^ASB_EWMA_SHIFT */
+#define ASB_EWMA_SHIFT         2U
+
+struct AdaptiveStreamBuffer
+{
+  StreamBufferHandle_t xStream;
+  TickType_t xIdleTimeout;
+  size_t xTriggerMax;
+  volatile size_t xTrigger;
+  volatile TickType_t xLastWrite;
+  volatile uint32_t ulBytesWritten;
+  TaskHandle_t volatile xReader;
+  /* Reader only */
+  uint32_t ulRate;
+  uint32_t ulBytesAtLastRead;
+  TickType_t xLastRead;
+};
+
+AdaptiveStreamBufferHandle_t xAdaptiveStreamBufferCreate(size_t xBufferSizeBytes, TickType_t xIdleTimeout)
+{
+  struct AdaptiveStreamBuffer *pxBuffer;
+
+  configASSERT(xBufferSizeBytes >= 2U && xIdleTimeout > 0U);
+
+  pxBuffer = pvPortMalloc(sizeof(struct AdaptiveStreamBuffer));
+  if (pxBuffer == NULL)
+  {
+    return NULL;
+  }
+
+  /* Trigger level 1: the stream buffer itself never decides when to wake. */
+  pxBuffer->xStream = xStreamBufferCreate(xBufferSizeBytes, 1);
+  if (pxBuffer->xStream == NULL)
+  {
+    vPortFree(pxBuffer);
+    return NULL;
+  }
+
+  pxBuffer->xIdleTimeout = xIdleTimeout;
+  pxBuffer->xTriggerMax = xBufferSizeBytes / 2U;
+  pxBuffer->xTrigger = 1U;
+  pxBuffer->xLastWrite = 0U;
+  pxBuffer->ulBytesWritten = 0U;
+  pxBuffer->xReader = NULL;
+  pxBuffer->ulRate = 0U;
+  pxBuffer->ulBytesAtLastRead = 0U;
+  pxBuffer->xLastRead = 0U;
+
+  return pxBuffer;
+}
+
+void vAdaptiveStreamBufferDelete(AdaptiveStreamBufferHandle_t xBuffer)
+{
+  vStreamBufferDelete(xBuffer->xStream);
+  vPortFree(xBuffer);
+}
+
+size_t xAdaptiveStreamBufferGetTriggerLevel(AdaptiveStreamBufferHandle_t xBuffer)
+{
+  return xBuffer->xTrigger;
+}
+
+StreamBufferHandle_t xAdaptiveStreamBufferGetStreamBuffer(AdaptiveStreamBufferHandle_t xBuffer)
+{
+  return xBuffer->xStream;
+}
+
+/* The reader is notified when a hand-over is due, i.e. when the fill level
+reached the trigger level, and when the write made an empty buffer non-empty:
+a reader waiting on an empty buffer has no idle timeout running yet and must
+wake up to start it. Other writes below the trigger cost nothing. */
+static BaseType_t prvTriggerReached(struct AdaptiveStreamBuffer *pxBuffer, size_t xSent, TickType_t xNow)
+{
+  size_t xAvailable;
+
+  if (xSent == 0U)
+  {
+    return pdFALSE;
+  }
+
+  pxBuffer->xLastWrite = xNow;
+  pxBuffer->ulBytesWritten += (uint32_t)xSent;
+
+  xAvailable = xStreamBufferBytesAvailable(pxBuffer->xStream);
+  return (pxBuffer->xReader != NULL &&
+          (xAvailable >= pxBuffer->xTrigger || xAvailable <= xSent)) ? pdTRUE : pdFALSE;
+}
+
+size_t xAdaptiveStreamBufferSend(AdaptiveStreamBufferHandle_t xBuffer, const void *pvTxData,
+                                 size_t xDataLengthBytes, TickType_t xTicksToWait)
+{
+  size_t xSent = xStreamBufferSend(xBuffer->xStream, pvTxData, xDataLengthBytes, xTicksToWait);
+
+  if (prvTriggerReached(xBuffer, xSent, xTaskGetTickCount()) != pdFALSE)
+  {
+    xTaskNotifyGive(xBuffer->xReader);
+  }
+  return xSent;
+}
+
+size_t xAdaptiveStreamBufferSendFromISR(AdaptiveStreamBufferHandle_t xBuffer, const void *pvTxData,
+                                        size_t xDataLengthBytes, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  size_t xSent = xStreamBufferSendFromISR(xBuffer->xStream, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken);
+
+  if (prvTriggerReached(xBuffer, xSent, xTaskGetTickCountFromISR()) != pdFALSE)
+  {
+    vTaskNotifyGiveFromISR(xBuffer->xReader, pxHigherPriorityTaskWoken);
+  }
+  return xSent;
+}
+
+static void prvAdapt(struct AdaptiveStreamBuffer *pxBuffer, TickType_t xNow)
+{
+  uint32_t ulBytes = pxBuffer->ulBytesWritten;
+  TickType_t xTicks = xNow - pxBuffer->xLastRead;
+  uint32_t ulSample;
+  uint64_t ullTrigger;
+
+  if (xTicks == 0U)
+  {
+    xTicks = 1U;
+  }
+  ulSample = (uint32_t)(((uint64_t)(ulBytes - pxBuffer->ulBytesAtLastRead) << ASB_RATE_SHIFT) / xTicks);
+
+  if (ulSample >= pxBuffer->ulRate)
+  {
+    pxBuffer->ulRate += (ulSample - pxBuffer->ulRate) >> ASB_EWMA_SHIFT;
+  }
+  else
+  {
+    pxBuffer->ulRate -= (pxBuffer->ulRate - ulSample) >> ASB_EWMA_SHIFT;
+  }
+
+  ullTrigger = ((uint64_t)pxBuffer->ulRate * pxBuffer->xIdleTimeout) >> ASB_RATE_SHIFT;
+  if (ullTrigger < 1U)
+  {
+    ullTrigger = 1U;
+  }
+  else if (ullTrigger > pxBuffer->xTriggerMax)
+  {
+    ullTrigger = pxBuffer->xTriggerMax;
+  }
+  pxBuffer->xTrigger = (size_t)ullTrigger;
+
+  pxBuffer->ulBytesAtLastRead = ulBytes;
+  pxBuffer->xLastRead = xNow;
+}
+
+size_t xAdaptiveStreamBufferReceive(AdaptiveStreamBufferHandle_t xBuffer, void *pvRxData,
+                                    size_t xBufferLengthBytes, TickType_t xTicksToWait)
+{
+  TimeOut_t xTimeOut;
+  size_t xAvailable;
+  size_t xWanted;
+  TickType_t xNow;
+  TickType_t xIdle;
+  TickType_t xWait;
+
+  configASSERT(xBufferLengthBytes > 0U);
+
+  xBuffer->xReader = xTaskGetCurrentTaskHandle();
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    xAvailable = xStreamBufferBytesAvailable(xBuffer->xStream);
+    xWanted = xBuffer->xTrigger < xBufferLengthBytes ? xBuffer->xTrigger : xBufferLengthBytes;
+    xNow = xTaskGetTickCount();
+    xIdle = xNow - xBuffer->xLastWrite;
+
+    if (xAvailable >= xWanted || (xAvailable > 0U && xIdle >= xBuffer->xIdleTimeout))
+    {
+      break;
+    }
+
+    if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+    {
+      if (xAvailable == 0U)
+      {
+        return 0;
+      }
+      break;
+    }
+
+    /* Nothing yet: wait for the trigger. Data below the trigger: wait for it
+    or for the end of the idle time, whichever comes first. */
+    xWait = xTicksToWait;
+    if (xAvailable > 0U && xBuffer->xIdleTimeout - xIdle < xWait)
+    {
+      xWait = xBuffer->xIdleTimeout - xIdle;
+    }
+    (void)ulTaskNotifyTake(pdTRUE, xWait);
+  }
+
+  prvAdapt(xBuffer, xNow);
+  return xStreamBufferReceive(xBuffer->xStream, pvRxData, xBufferLengthBytes, 0);
+}
@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file           : barrier.c
+  * @brief          : Reusable task barrier with a generation counter
+  ******************************************************************************
+  * @attention
+  *
+  * Waiters of generation g block on event bit (g & 1). The last arrival of
+  * round g clears the bit of round g+1 and then sets the bit of round g,
+  * which moves every waiter of the round to the ready list at once when the
+  * scheduler is resumed. Bits
+  * are never cleared on exit, so a released waiter that runs late still
+  * sees its bit; it is only cleared when the following round completes,
+  * by which time every waiter of round g has left.
+  *
+  ******************************************************************************
+  */
+
+#include "barrier.h"
+#include "task.h"
+#include "event_groups.h"
+
+#define BARRIER_BIT(ulGeneration)   ((EventBits_t)1 << ((ulGeneration) & 1U))
+
+struct Barrier
+{
+  EventGroupHandle_t xRelease;
+  UBaseType_t uxParticipants;
+  UBaseType_t uxArrived;
+  uint32_t ulGeneration;
+  uint32_t ulTimeouts;
+};
+
+BarrierHandle_t xBarrierCreate(UBaseType_t uxParticipants)
+{
+  struct Barrier *pxBarrier;
+
+  configASSERT(uxParticipants > 0U);
+
+  pxBarrier = pvPortMalloc(sizeof(struct Barrier));
+  if (pxBarrier == NULL)
+  {
+    return NULL;
+  }
+
+  pxBarrier->xRelease = xEventGroupCreate();
+  if (pxBarrier->xRelease == NULL)
+  {
+    vPortFree(pxBarrier);
+    return NULL;
+  }
+
+  pxBarrier->uxParticipants = uxParticipants;
+  pxBarrier->uxArrived = 0U;
+  pxBarrier->ulGeneration = 0U;
+  pxBarrier->ulTimeouts = 0U;
+
+  return pxBarrier;
+}
+
+void vBarrierDelete(BarrierHandle_t xBarrier)
+{
+  vEventGroupDelete(xBarrier->xRelease);
+  vPortFree(xBarrier);
+}
+
+BaseType_t xBarrierWait(BarrierHandle_t xBarrier, TickType_t xTicksToWait, uint32_t *pulGeneration)
+{
+  uint32_t ulGeneration;
+  BaseType_t xLast = pdFALSE;
+  BaseType_t xResult = pdPASS;
+
+  /* Only tasks touch the barrier, so suspending the scheduler is enough and
+  the release runs in the same section as the arrival that completes the
+  round: no task can arrive for round g+1 before the bit of g+1 is clear. */
+  vTaskSuspendAll();
+  {
+    ulGeneration = xBarrier->ulGeneration;
+    xBarrier->uxArrived++;
+    if (xBarrier->uxArrived == xBarrier->uxParticipants)
+    {
+      xBarrier->uxArrived = 0U;
+      xBarrier->ulGeneration = ulGeneration + 1U;
+      (void)xEventGroupClearBits(xBarrier->xRelease, BARRIER_BIT(ulGeneration + 1U));
+      (void)xEventGroupSetBits(xBarrier->xRelease, BARRIER_BIT(ulGeneration));
+      xLast = pdTRUE;
+    }
+  }
+  (void)xTaskResumeAll();
+
+  if (pulGeneration != NULL)
+  {
+    *pulGeneration = ulGeneration;
+  }
+
+  if (xLast == pdFALSE &&
+      (xEventGroupWaitBits(xBarrier->xRelease, BARRIER_BIT(ulGeneration), pdFALSE, pdFALSE, xTicksToWait) &
+       BARRIER_BIT(ulGeneration)) == 0U)
+  {
+    vTaskSuspendAll();
+    {
+      /* The round may have completed between the timeout and here. */
+      if (xBarrier->ulGeneration == ulGeneration)
+      {
+        xBarrier->uxArrived--;
+        xBarrier->ulTimeouts++;
+        xResult = pdFAIL;
+      }
+    }
+    (void)xTaskResumeAll();
+  }
+
+  return xResult;
+}
+
+uint32_t ulBarrierGetGeneration(BarrierHandle_t xBarrier)
+{
+  return xBarrier->ulGeneration;
+}
+
+uint32_t ulBarrierGetTimeouts(BarrierHandle_t xBarrier)
+{
+  return xBarrier->ulTimeouts;
+}
@@ -0,0 +1,376 @@
+/**
+  ******************************************************************************
+  * @file           : batch_queue.c
+  * @brief          : Queue that moves many items per call
+  ******************************************************************************
+  * @attention
+  *
+  * A ring of uxLength items behind the control block. Blocked senders and
+  * receivers are kept in two FIFO lists of records that live on their own
+  * stacks. A call that moved items wakes the first task of the other list;
+  * a woken task that leaves work behind (items still queued, space still
+  * free) passes the wake-up on to the next one of its own list, so every
+  * call costs at most two notifications.
+  *
+  * A woken task is not handed any items, it simply tries again and waits
+  * again if another task was faster.
+  *
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "batch_queue.h"
+#include "task.h"
+
+typedef struct BatchQueueWaiter
+{
+  TaskHandle_t xTask;
+  volatile BaseType_t xWoken;
+  struct BatchQueueWaiter *pxNext;
+} BatchQueueWaiter_t;
+
+typedef struct
+{
+  BatchQueueWaiter_t *pxHead;
+  BatchQueueWaiter_t *pxTail;
+} BatchQueueWaitList_t;
+
+struct BatchQueue
+{
+  uint8_t *pucStorage;
+  UBaseType_t uxLength;
+  UBaseType_t uxItemSize;
+  UBaseType_t uxRead;                /* index of the oldest item */
+  UBaseType_t uxWaiting;             /* items in the ring */
+  BatchQueueWaitList_t xSenders;
+  BatchQueueWaitList_t xReceivers;
+};
+
+BatchQueueHandle_t xBatchQueueCreate(UBaseType_t uxLength, UBaseType_t uxItemSize)
+{
+  struct BatchQueue *pxQueue;
+
+  configASSERT(uxLength > 0U && uxItemSize > 0U);
+
+  pxQueue = pvPortMalloc(sizeof(struct BatchQueue) + (size_t)uxLength * uxItemSize);
+  if (pxQueue == NULL)
+  {
+    return NULL;
+  }
+
+  memset(pxQueue, 0, sizeof(struct BatchQueue));
+  pxQueue->pucStorage = (uint8_t *)(pxQueue + 1);
+  pxQueue->uxLength = uxLength;
+  pxQueue->uxItemSize = uxItemSize;
+
+  return pxQueue;
+}
+
+void vBatchQueueDelete(BatchQueueHandle_t xQueue)
+{
+  configASSERT(xQueue->xSenders.pxHead == NULL && xQueue->xReceivers.pxHead == NULL);
+
+  vPortFree(xQueue);
+}
+
+/* Critical section. Copies uxCount items between the ring, starting at item
+index uxIndex, and pucItems, in at most two pieces. */
+static void prvCopy(struct BatchQueue *pxQueue, UBaseType_t uxIndex, uint8_t *pucItems, UBaseType_t uxCount,
+                    BaseType_t xToRing)
+{
+  UBaseType_t uxFirst = pxQueue->uxLength - uxIndex;
+  size_t xFirstBytes;
+  size_t xSecondBytes;
+
+  if (uxFirst > uxCount)
+  {
+    uxFirst = uxCount;
+  }
+  xFirstBytes = (size_t)uxFirst * pxQueue->uxItemSize;
+  xSecondBytes = (size_t)(uxCount - uxFirst) * pxQueue->uxItemSize;
+
+  if (xToRing != pdFALSE)
+  {
+    memcpy(&pxQueue->pucStorage[(size_t)uxIndex * pxQueue->uxItemSize], pucItems, xFirstBytes);
+    memcpy(pxQueue->pucStorage, &pucItems[xFirstBytes], xSecondBytes);
+  }
+  else
+  {
+    memcpy(pucItems, &pxQueue->pucStorage[(size_t)uxIndex * pxQueue->uxItemSize], xFirstBytes);
+    memcpy(&pucItems[xFirstBytes], pxQueue->pucStorage, xSecondBytes);
+  }
+}
+
+/* Critical section. */
+static UBaseType_t prvPut(struct BatchQueue *pxQueue, const void *pvItems, UBaseType_t uxCount)
+{
+  UBaseType_t uxSpace = pxQueue->uxLength - pxQueue->uxWaiting;
+  UBaseType_t uxWrite = pxQueue->uxRead + pxQueue->uxWaiting;
+
+  if (uxCount > uxSpace)
+  {
+    uxCount = uxSpace;
+  }
+  if (uxWrite >= pxQueue->uxLength)
+  {
+    uxWrite -= pxQueue->uxLength;
+  }
+
+  prvCopy(pxQueue, uxWrite, (uint8_t *)pvItems, uxCount, pdTRUE);
+  pxQueue->uxWaiting += uxCount;
+
+  return uxCount;
+}
+
+/* Critical section. */
+static UBaseType_t prvGet(struct BatchQueue *pxQueue, void *pvItems, UBaseType_t uxCount)
+{
+  if (uxCount > pxQueue->uxWaiting)
+  {
+    uxCount = pxQueue->uxWaiting;
+  }
+
+  prvCopy(pxQueue, pxQueue->uxRead, pvItems, uxCount, pdFALSE);
+  pxQueue->uxRead += uxCount;
+  if (pxQueue->uxRead >= pxQueue->uxLength)
+  {
+    pxQueue->uxRead -= pxQueue->uxLength;
+  }
+  pxQueue->uxWaiting -= uxCount;
+
+  return uxCount;
+}
+
+/* Critical section. Wakes the first task of pxList, if any.
+pxHigherPriorityTaskWoken is NULL in a task. */
+static void prvWakeOne(BatchQueueWaitList_t *pxList, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BatchQueueWaiter_t *pxWaiter = pxList->pxHead;
+
+  if (pxWaiter == NULL)
+  {
+    return;
+  }
+
+  pxList->pxHead = pxWaiter->pxNext;
+  if (pxList->pxHead == NULL)
+  {
+    pxList->pxTail = NULL;
+  }
+  pxWaiter->xWoken = pdTRUE;
+
+  if (pxHigherPriorityTaskWoken != NULL)
+  {
+    vTaskNotifyGiveFromISR(pxWaiter->xTask, pxHigherPriorityTaskWoken);
+  }
+  else
+  {
+    (void)xTaskNotifyGive(pxWaiter->xTask);
+  }
+}
+
+/* Critical section. Wake-ups after a call that moved items. */
+static void prvWakeAfter(struct BatchQueue *pxQueue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  if (pxQueue->uxWaiting > 0U)
+  {
+    prvWakeOne(&pxQueue->xReceivers, pxHigherPriorityTaskWoken);
+  }
+  if (pxQueue->uxWaiting < pxQueue->uxLength)
+  {
+    prvWakeOne(&pxQueue->xSenders, pxHigherPriorityTaskWoken);
+  }
+}
+
+/* Critical section. */
+static void prvEnqueue(BatchQueueWaitList_t *pxList, BatchQueueWaiter_t *pxWaiter)
+{
+  pxWaiter->xTask = xTaskGetCurrentTaskHandle();
+  pxWaiter->xWoken = pdFALSE;
+  pxWaiter->pxNext = NULL;
+
+  if (pxList->pxTail == NULL)
+  {
+    pxList->pxHead = pxWaiter;
+  }
+  else
+  {
+    pxList->pxTail->pxNext = pxWaiter;
+  }
+  pxList->pxTail = pxWaiter;
+}
+
+/* Critical section. */
+static void prvRemove(BatchQueueWaitList_t *pxList, BatchQueueWaiter_t *pxWaiter)
+{
+  BatchQueueWaiter_t *pxPrevious = NULL;
+  BatchQueueWaiter_t *pxIterator = pxList->pxHead;
+
+  while (pxIterator != NULL && pxIterator != pxWaiter)
+  {
+    pxPrevious = pxIterator;
+    pxIterator = pxIterator->pxNext;
+  }
+  configASSERT(pxIterator != NULL);
+
+  if (pxPrevious == NULL)
+  {
+    pxList->pxHead = pxWaiter->pxNext;
+  }
+  else
+  {
+    pxPrevious->pxNext = pxWaiter->pxNext;
+  }
+  if (pxList->pxTail == pxWaiter)
+  {
+    pxList->pxTail = pxPrevious;
+  }
+}
+
+/* Blocks on pxList until woken or until the time runs out. */
+static void prvWait(BatchQueueWaitList_t *pxList, BatchQueueWaiter_t *pxWaiter, TimeOut_t *pxTimeOut,
+                    TickType_t *pxTicksToWait)
+{
+  (void)ulTaskNotifyTake(pdTRUE, *pxTicksToWait);
+
+  taskENTER_CRITICAL();
+  if (pxWaiter->xWoken == pdFALSE)
+  {
+    prvRemove(pxList, pxWaiter);
+  }
+  taskEXIT_CRITICAL();
+
+  if (xTaskCheckForTimeOut(pxTimeOut, pxTicksToWait) != pdFALSE)
+  {
+    /* One last try, then give up. */
+    *pxTicksToWait = 0U;
+  }
+}
+
+UBaseType_t uxBatchQueueSend(BatchQueueHandle_t xQueue, const void *pvItems, UBaseType_t uxCount,
+                             TickType_t xTicksToWait)
+{
+  BatchQueueWaiter_t xWaiter;
+  TimeOut_t xTimeOut;
+  UBaseType_t uxSent;
+
+  if (uxCount == 0U)
+  {
+    return 0U;
+  }
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    {
+      uxSent = prvPut(xQueue, pvItems, uxCount);
+      if (uxSent > 0U)
+      {
+        prvWakeAfter(xQueue, NULL);
+        taskEXIT_CRITICAL();
+        return uxSent;
+      }
+
+      if (xTicksToWait == 0U)
+      {
+        taskEXIT_CRITICAL();
+        return 0U;
+      }
+
+      prvEnqueue(&xQueue->xSenders, &xWaiter);
+    }
+    taskEXIT_CRITICAL();
+
+    prvWait(&xQueue->xSenders, &xWaiter, &xTimeOut, &xTicksToWait);
+  }
+}
+
+UBaseType_t uxBatchQueueReceive(BatchQueueHandle_t xQueue, void *pvItems, UBaseType_t uxMaxCount,
+                                TickType_t xTicksToWait)
+{
+  BatchQueueWaiter_t xWaiter;
+  TimeOut_t xTimeOut;
+  UBaseType_t uxReceived;
+
+  if (uxMaxCount == 0U)
+  {
+    return 0U;
+  }
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    {
+      uxReceived = prvGet(xQueue, pvItems, uxMaxCount);
+      if (uxReceived > 0U)
+      {
+        prvWakeAfter(xQueue, NULL);
+        taskEXIT_CRITICAL();
+        return uxReceived;
+      }
+
+      if (xTicksToWait == 0U)
+      {
+        taskEXIT_CRITICAL();
+        return 0U;
+      }
+
+      prvEnqueue(&xQueue->xReceivers, &xWaiter);
+    }
+    taskEXIT_CRITICAL();
+
+    prvWait(&xQueue->xReceivers, &xWaiter, &xTimeOut, &xTicksToWait);
+  }
+}
+
+UBaseType_t uxBatchQueueSendFromISR(BatchQueueHandle_t xQueue, const void *pvItems, UBaseType_t uxCount,
+                                    BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xWoken = pdFALSE;
+  UBaseType_t uxSavedInterruptStatus;
+  UBaseType_t uxSent;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  uxSent = prvPut(xQueue, pvItems, uxCount);
+  if (uxSent > 0U)
+  {
+    prvWakeAfter(xQueue, &xWoken);
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if (pxHigherPriorityTaskWoken != NULL && xWoken != pdFALSE)
+  {
+    *pxHigherPriorityTaskWoken = pdTRUE;
+  }
+  return uxSent;
+}
+
+UBaseType_t uxBatchQueueReceiveFromISR(BatchQueueHandle_t xQueue, void *pvItems, UBaseType_t uxMaxCount,
+                                       BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xWoken = pdFALSE;
+  UBaseType_t uxSavedInterruptStatus;
+  UBaseType_t uxReceived;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  uxReceived = prvGet(xQueue, pvItems, uxMaxCount);
+  if (uxReceived > 0U)
+  {
+    prvWakeAfter(xQueue, &xWoken);
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if (pxHigherPriorityTaskWoken != NULL && xWoken != pdFALSE)
+  {
+    *pxHigherPriorityTaskWoken = pdTRUE;
+  }
+  return uxReceived;
+}
+
+UBaseType_t uxBatchQueueMessagesWaiting(BatchQueueHandle_t xQueue)
+{
+  return xQueue->uxWaiting;
+}
@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @file           : block_pool.c
+  * @brief          : Fixed size block pool with static storage
+  ******************************************************************************
+  */
+
+#include "block_pool.h"
+#include "task.h"
+
+void vBlockPoolInit(BlockPool_t *pxPool, void *pvStorage, size_t xSize, UBaseType_t uxBlocks)
+{
+  size_t xBlockSize = BLOCK_POOL_BLOCK_SIZE(xSize);
+  uint8_t *pucBlock = pvStorage;
+  UBaseType_t ux;
+  uint32_t *pulAllocated;
+
+  configASSERT(pxPool != NULL && pvStorage != NULL && uxBlocks > 0U);
+  configASSERT(((uintptr_t)pvStorage & (BLOCK_POOL_ALIGNMENT - 1U)) == 0U);
+
+  /* Chain the blocks in address order, the last one ends the list. */
+  for (ux = 0U; ux < uxBlocks - 1U; ux++)
+  {
+    *(void **)pucBlock = pucBlock + xBlockSize;
+    pucBlock += xBlockSize;
+  }
+  *(void **)pucBlock = NULL;
+
+  /* The bitmap follows the last block, nothing is allocated yet. */
+  pulAllocated = (uint32_t *)(pucBlock + xBlockSize);
+  for (ux = 0U; ux < BLOCK_POOL_MAP_WORDS(uxBlocks); ux++)
+  {
+    pulAllocated[ux] = 0U;
+  }
+
+  pxPool->pvFreeList = pvStorage;
+  pxPool->pucStorage = pvStorage;
+  pxPool->pulAllocated = pulAllocated;
+  pxPool->xBlockSize = xBlockSize;
+  pxPool->uxBlocks = uxBlocks;
+  pxPool->uxFree = uxBlocks;
+  pxPool->uxMinimumFree = uxBlocks;
+}
+
+/* Callers hold the critical section. */
+static void *prvPop(BlockPool_t *pxPool)
+{
+  void *pvBlock = pxPool->pvFreeList;
+  size_t xIndex;
+
+  if (pvBlock != NULL)
+  {
+    xIndex = (size_t)((uint8_t *)pvBlock - pxPool->pucStorage) / pxPool->xBlockSize;
+    pxPool->pulAllocated[xIndex / 32U] |= 1UL << (xIndex % 32U);
+    pxPool->pvFreeList = *(void **)pvBlock;
+    pxPool->uxFree--;
+    if (pxPool->uxFree < pxPool->uxMinimumFree)
+    {
+      pxPool->uxMinimumFree = pxPool->uxFree;
+    }
+  }
+  return pvBlock;
+}
+
+static void prvPush(BlockPool_t *pxPool, void *pvBlock)
+{
+  size_t xIndex;
+  uint32_t ulMask;
+
+  /* Only blocks of this pool, and only while they are allocated. */
+  configASSERT((uint8_t *)pvBlock >= pxPool->pucStorage &&
+               (uint8_t *)pvBlock < pxPool->pucStorage + pxPool->xBlockSize * pxPool->uxBlocks &&
+               (((uint8_t *)pvBlock - pxPool->pucStorage) % pxPool->xBlockSize) == 0U);
+  xIndex = (size_t)((uint8_t *)pvBlock - pxPool->pucStorage) / pxPool->xBlockSize;
+  ulMask = 1UL << (xIndex % 32U);
+  configASSERT((pxPool->pulAllocated[xIndex / 32U] & ulMask) != 0U);
+  pxPool->pulAllocated[xIndex / 32U] &= ~ulMask;
+
+  *(void **)pvBlock = pxPool->pvFreeList;
+  pxPool->pvFreeList = pvBlock;
+  pxPool->uxFree++;
+}
+
+void *pvBlockPoolAlloc(BlockPool_t *pxPool)
+{
+  void *pvBlock;
+
+  taskENTER_CRITICAL();
+  pvBlock = prvPop(pxPool);
+  taskEXIT_CRITICAL();
+
+  return pvBlock;
+}
+
+void *pvBlockPoolAllocFromISR(BlockPool_t *pxPool)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  void *pvBlock;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  pvBlock = prvPop(pxPool);
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  return pvBlock;
+}
+
+void vBlockPoolFree(BlockPool_t *pxPool, void *pvBlock)
+{
+  if (pvBlock == NULL)
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  prvPush(pxPool, pvBlock);
+  taskEXIT_CRITICAL();
+}
+
+void vBlockPoolFreeFromISR(BlockPool_t *pxPool, void *pvBlock)
+{
+  UBaseType_t uxSavedInterruptStatus;
+
+  if (pvBlock == NULL)
+  {
+    return;
+  }
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  prvPush(pxPool, pvBlock);
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+UBaseType_t uxBlockPoolGetFree(const BlockPool_t *pxPool)
+{
+  return pxPool->uxFree;
+}
+
+UBaseType_t uxBlockPoolGetMinimumEverFree(const BlockPool_t *pxPool)
+{
+  return pxPool->uxMinimumFree;
+}
@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file           : fast_recursive_mutex.c
+  * @brief          : Recursive mutex with an inline re-entry path
+  ******************************************************************************
+  */
+
+#include "fast_recursive_mutex.h"
+
+BaseType_t xFastRecursiveMutexInit(FastRecursiveMutex_t *pxMutex)
+{
+  pxMutex->xOwner = NULL;
+  pxMutex->uxDepth = 0U;
+  pxMutex->xMutex = xSemaphoreCreateMutex();
+
+  return (pxMutex->xMutex != NULL) ? pdPASS : pdFAIL;
+}
+
+void vFastRecursiveMutexDelete(FastRecursiveMutex_t *pxMutex)
+{
+  configASSERT(pxMutex->xOwner == NULL);
+
+  vSemaphoreDelete(pxMutex->xMutex);
+  pxMutex->xMutex = NULL;
+}
+
+BaseType_t xFastRecursiveMutexTakeSlow(FastRecursiveMutex_t *pxMutex, TickType_t xTicksToWait)
+{
+  if (xSemaphoreTake(pxMutex->xMutex, xTicksToWait) != pdPASS)
+  {
+    return pdFAIL;
+  }
+
+  pxMutex->uxDepth = 1U;
+  pxMutex->xOwner = xTaskGetCurrentTaskHandle();
+
+  return pdPASS;
+}
+
+BaseType_t xFastRecursiveMutexGiveSlow(FastRecursiveMutex_t *pxMutex)
+{
+  if (pxMutex->xOwner != xTaskGetCurrentTaskHandle())
+  {
+    return pdFAIL;
+  }
+
+  /* Clear the owner first: once the mutex is given the next owner writes
+  both fields. */
+  pxMutex->uxDepth = 0U;
+  pxMutex->xOwner = NULL;
+
+  return xSemaphoreGive(pxMutex->xMutex);
+}
@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file           : heartbeat.c
+  * @brief          : Task heartbeat watchdog for any number of tasks
+  ******************************************************************************
+  * @attention
+  *
+  * Check-ins only write xHeartbeatLastCheckIn[]. Everything else is owned by
+  * the "Heartbeat" task, except the registration bitmap and the slot setup,
+  * which register/unregister change inside a critical section.
+  *
+  ******************************************************************************
+  */
+
+#include "heartbeat.h"
+
+#if (HEARTBEAT_MAX_TASKS % 32U) != 0U
+#error "HEARTBEAT_MAX_TASKS must be a multiple of 32"
+#endif
+
+#define HEARTBEAT_WORDS   (HEARTBEAT_MAX_TASKS / 32U)
+
+typedef struct
+{
+  const char *pcName;
+  TickType_t xTimeout;
+  TickType_t xWorstGap;
+  uint32_t ulMisses;
+} HeartbeatSlot_t;
+
+volatile TickType_t xHeartbeatLastCheckIn[HEARTBEAT_MAX_TASKS];
+
+static HeartbeatSlot_t xSlots[HEARTBEAT_MAX_TASKS];
+static volatile uint32_t ulRegistered[HEARTBEAT_WORDS];
+static uint32_t ulMissing[HEARTBEAT_WORDS];        /* "Heartbeat" task, cleared on register */
+
+static HeartbeatCallback_t pxOnChange = NULL;
+
+/* Calls the callback for every set bit of ulBits, lowest slot first. */
+static void prvReport(uint32_t ulWord, uint32_t ulBits, BaseType_t xMissing)
+{
+  while (ulBits != 0U)
+  {
+    BaseType_t xId = (BaseType_t)(ulWord * 32U + (uint32_t)__builtin_ctz(ulBits));
+
+    ulBits &= ulBits - 1U;
+    if (xMissing != pdFALSE)
+    {
+      xSlots[xId].ulMisses++;
+    }
+    if (pxOnChange != NULL)
+    {
+      pxOnChange(xId, xMissing);
+    }
+  }
+}
+
+static void prvCheckWord(uint32_t ulWord, TickType_t xNow)
+{
+  uint32_t ulRegisteredBits = ulRegistered[ulWord];
+  uint32_t ulBits = ulRegisteredBits;
+  uint32_t ulExpired = 0U;
+  uint32_t ulChanged;
+
+  while (ulBits != 0U)
+  {
+    uint32_t ulBit = (uint32_t)__builtin_ctz(ulBits);
+    HeartbeatSlot_t *pxSlot = &xSlots[ulWord * 32U + ulBit];
+    TickType_t xGap = xNow - xHeartbeatLastCheckIn[ulWord * 32U + ulBit];
+
+    ulBits &= ulBits - 1U;
+
+    /* Checked in after xNow was read. */
+    if (xGap > (portMAX_DELAY >> 1))
+    {
+      xGap = 0U;
+    }
+    if (xGap > pxSlot->xWorstGap)
+    {
+      pxSlot->xWorstGap = xGap;
+    }
+    if (xGap > pxSlot->xTimeout)
+    {
+      ulExpired |= 1UL << ulBit;
+    }
+  }
+
+  /* Unregistered slots leave the missing set silently. */
+  ulChanged = (ulExpired ^ ulMissing[ulWord]) & ulRegisteredBits;
+  ulMissing[ulWord] = ulExpired;
+
+  prvReport(ulWord, ulChanged & ulExpired, pdTRUE);
+  prvReport(ulWord, ulChanged & ~ulExpired, pdFALSE);
+}
+
+static void prvHeartbeatTask(void *pvParameters)
+{
+  (void)pvParameters;
+
+  for (;;)
+  {
+    TickType_t xNow;
+    uint32_t ulWord;
+
+    vTaskDelay(pdMS_TO_TICKS(HEARTBEAT_CHECK_PERIOD_MS));
+
+    xNow = xTaskGetTickCount();
+    for (ulWord = 0U; ulWord < HEARTBEAT_WORDS; ulWord++)
+    {
+      if (ulRegistered[ulWord] != 0U || ulMissing[ulWord] != 0U)
+      {
+        prvCheckWord(ulWord, xNow);
+      }
+    }
+  }
+}
+
+BaseType_t xHeartbeatInit(HeartbeatCallback_t pxCallback)
+{
+  pxOnChange = pxCallback;
+
+  return xTaskCreate(prvHeartbeatTask, "Heartbeat", HEARTBEAT_TASK_STACK, NULL,
+                     HEARTBEAT_TASK_PRIORITY, NULL);
+}
+
+BaseType_t xHeartbeatRegister(const char *pcName, TickType_t xTimeout)
+{
+  BaseType_t xId = -1;
+  uint32_t ulWord;
+
+  taskENTER_CRITICAL();
+  {
+    for (ulWord = 0U; ulWord < HEARTBEAT_WORDS; ulWord++)
+    {
+      if (ulRegistered[ulWord] != 0xFFFFFFFFUL)
+      {
+        uint32_t ulBit = (uint32_t)__builtin_ctz(~ulRegistered[ulWord]);
+
+        xId = (BaseType_t)(ulWord * 32U + ulBit);
+        xSlots[xId].pcName = pcName;
+        xSlots[xId].xTimeout = xTimeout;
+        xSlots[xId].xWorstGap = 0U;
+        xSlots[xId].ulMisses = 0U;
+        xHeartbeatLastCheckIn[xId] = xTaskGetTickCount();
+        /* A previous user of the slot may have been missing: the new one
+        starts healthy, without a "running again" report. */
+        ulMissing[ulWord] &= ~(1UL << ulBit);
+        ulRegistered[ulWord] |= 1UL << ulBit;
+        break;
+      }
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return xId;
+}
+
+void vHeartbeatUnregister(BaseType_t xId)
+{
+  configASSERT(xId >= 0 && (uint32_t)xId < HEARTBEAT_MAX_TASKS);
+
+  taskENTER_CRITICAL();
+  ulRegistered[(uint32_t)xId / 32U] &= ~(1UL << ((uint32_t)xId % 32U));
+  taskEXIT_CRITICAL();
+}
+
+const char *pcHeartbeatGetName(BaseType_t xId)
+{
+  return xSlots[xId].pcName;
+}
+
+uint32_t ulHeartbeatGetMisses(BaseType_t xId)
+{
+  return xSlots[xId].ulMisses;
+}
+
+TickType_t xHeartbeatGetWorstGap(BaseType_t xId)
+{
+  return xSlots[xId].xWorstGap;
+}
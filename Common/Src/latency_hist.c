@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file           : latency_hist.c
+  * @brief          : Fixed size log-linear histogram for latency percentiles
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "latency_hist.h"
+
+static uint32_t prvBucketIndex(uint32_t ulValue)
+{
+  uint32_t ulExp;
+
+  if (ulValue < LATENCY_HIST_SUB_BUCKETS)
+  {
+    return ulValue;
+  }
+  ulExp = 31U - (uint32_t)__builtin_clz(ulValue);
+  return ((ulExp - LATENCY_HIST_SUB_BITS + 1U) << LATENCY_HIST_SUB_BITS)
+       + ((ulValue >> (ulExp - LATENCY_HIST_SUB_BITS)) & (LATENCY_HIST_SUB_BUCKETS - 1U));
+}
+
+/* Middle of the value range covered by a bucket. */
+static uint32_t prvBucketValue(uint32_t ulIndex)
+{
+  uint32_t ulShift;
+
+  if (ulIndex < LATENCY_HIST_SUB_BUCKETS)
+  {
+    return ulIndex;
+  }
+  ulShift = (ulIndex >> LATENCY_HIST_SUB_BITS) - 1U;
+  return (((LATENCY_HIST_SUB_BUCKETS + (ulIndex & (LATENCY_HIST_SUB_BUCKETS - 1U))) << ulShift)
+         + ((1U << ulShift) >> 1));
+}
+
+void vLatencyHistReset(LatencyHist_t *pxHist)
+{
+  memset(pxHist, 0, sizeof(*pxHist));
+  pxHist->ulMin = UINT32_MAX;
+}
+
+void vLatencyHistAdd(LatencyHist_t *pxHist, uint32_t ulValue)
+{
+  pxHist->ulBucket[prvBucketIndex(ulValue)]++;
+  pxHist->ulCount++;
+  pxHist->ullSum += ulValue;
+  if (ulValue < pxHist->ulMin)
+  {
+    pxHist->ulMin = ulValue;
+  }
+  if (ulValue > pxHist->ulMax)
+  {
+    pxHist->ulMax = ulValue;
+  }
+}
+
+uint32_t ulLatencyHistPercentile(const LatencyHist_t *pxHist, uint32_t ulPerMille)
+{
+  uint64_t ullRank;
+  uint64_t ullSeen = 0;
+  uint32_t ulIndex;
+
+  if (pxHist->ulCount == 0U)
+  {
+    return 0U;
+  }
+
+  /* Smallest bucket that holds at least ulPerMille/1000 of the samples. */
+  ullRank = ((uint64_t)pxHist->ulCount * ulPerMille + 999U) / 1000U;
+  for (ulIndex = 0; ulIndex < LATENCY_HIST_BUCKETS; ulIndex++)
+  {
+    ullSeen += pxHist->ulBucket[ulIndex];
+    if (ullSeen >= ullRank && ullSeen != 0U)
+    {
+      uint32_t ulValue = prvBucketValue(ulIndex);
+
+      /* Never report outside the observed range. */
+      if (ulValue < pxHist->ulMin)
+      {
+        ulValue = pxHist->ulMin;
+      }
+      return (ulValue > pxHist->ulMax) ? pxHist->ulMax : ulValue;
+    }
+  }
+  return pxHist->ulMax;
+}
+
+uint32_t ulLatencyHistMean(const LatencyHist_t *pxHist)
+{
+  return (pxHist->ulCount != 0U) ? (uint32_t)(pxHist->ullSum / pxHist->ulCount) : 0U;
+}
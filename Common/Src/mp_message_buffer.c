@@ -0,0 +1,394 @@
+/**
+  ******************************************************************************
+  * @file           : mp_message_buffer.c
+  * @brief          : Message buffer that accepts several concurrent writers
+  ******************************************************************************
+  * @attention
+  *
+  * ulHead and ulTail are free running byte positions, the storage offset is
+  * the position masked with the (power of two) size. Every record starts
+  * with a 32 bit header on a 4 byte boundary:
+  *
+  *   bit 31     committed, the record may be read
+  *   bit 30     skip record, the rest of the storage up to the end is unused
+  *   bit 29..0  payload length (skip record: length of the skipped area)
+  *
+  * A writer stores the length right after the reservation and sets the
+  * committed bit when the payload is complete. The reader clears every record
+  * it consumes before it advances ulTail, so a header that is reserved but
+  * not yet written reads as zero and never as old payload bytes.
+  *
+  * Records never wrap, so the zero-copy functions can hand out one plain
+  * pointer per message.
+  *
+  ******************************************************************************
+  */
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "mp_message_buffer.h"
+#include "task.h"
+#include "semphr.h"
+
+#define MPMB_HEADER_SIZE       4U
+#define MPMB_COMMITTED         0x80000000UL
+#define MPMB_SKIP              0x40000000UL
+#define MPMB_LENGTH_MASK       0x3FFFFFFFUL
+
+/* Writers woken per consumed message, more waiting writers retry on the
+next one. */
+#define MPMB_MAX_WAKE          255U
+
+struct MPMessageBuffer
+{
+  uint8_t *pucStorage;
+  uint32_t ulSize;
+  atomic_uint ulHead;                 /* next reservation */
+  atomic_uint ulTail;                 /* written by the reader only */
+  atomic_int xReaderWaiting;
+  atomic_uint ulWritersWaiting;
+  SemaphoreHandle_t xDataReady;       /* binary, wakes the reader */
+  SemaphoreHandle_t xSpaceFree;       /* counting, wakes writers */
+};
+
+static inline atomic_uint *prvHeader(struct MPMessageBuffer *pxBuffer, uint32_t ulPos)
+{
+  return (atomic_uint *)&pxBuffer->pucStorage[ulPos & (pxBuffer->ulSize - 1U)];
+}
+
+static inline uint32_t prvRecordSize(size_t xLength)
+{
+  return MPMB_HEADER_SIZE + (((uint32_t)xLength + 3U) & ~3U);
+}
+
+MPMessageBufferHandle_t xMPMessageBufferCreate(size_t xBufferSizeBytes)
+{
+  struct MPMessageBuffer *pxBuffer;
+  uint32_t ulSize = 2U * (MPMB_HEADER_SIZE + 4U);
+
+  while (ulSize < xBufferSizeBytes)
+  {
+    ulSize <<= 1;
+  }
+
+  pxBuffer = pvPortMalloc(sizeof(struct MPMessageBuffer) + ulSize);
+  if (pxBuffer == NULL)
+  {
+    return NULL;
+  }
+
+  pxBuffer->pucStorage = (uint8_t *)(pxBuffer + 1);
+  pxBuffer->ulSize = ulSize;
+  atomic_init(&pxBuffer->ulHead, 0U);
+  atomic_init(&pxBuffer->ulTail, 0U);
+  atomic_init(&pxBuffer->xReaderWaiting, 0);
+  atomic_init(&pxBuffer->ulWritersWaiting, 0U);
+  memset(pxBuffer->pucStorage, 0, ulSize);
+
+  pxBuffer->xDataReady = xSemaphoreCreateBinary();
+  pxBuffer->xSpaceFree = xSemaphoreCreateCounting(MPMB_MAX_WAKE, 0U);
+  if (pxBuffer->xDataReady == NULL || pxBuffer->xSpaceFree == NULL)
+  {
+    vMPMessageBufferDelete(pxBuffer);
+    return NULL;
+  }
+  return pxBuffer;
+}
+
+void vMPMessageBufferDelete(MPMessageBufferHandle_t xBuffer)
+{
+  if (xBuffer->xDataReady != NULL)
+  {
+    vSemaphoreDelete(xBuffer->xDataReady);
+  }
+  if (xBuffer->xSpaceFree != NULL)
+  {
+    vSemaphoreDelete(xBuffer->xSpaceFree);
+  }
+  vPortFree(xBuffer);
+}
+
+size_t xMPMessageBufferMaxMessageSize(MPMessageBufferHandle_t xBuffer)
+{
+  return (xBuffer->ulSize / 2U) - MPMB_HEADER_SIZE;
+}
+
+size_t xMPMessageBufferSpacesAvailable(MPMessageBufferHandle_t xBuffer)
+{
+  uint32_t ulUsed = atomic_load(&xBuffer->ulHead) - atomic_load(&xBuffer->ulTail);
+
+  return (ulUsed + MPMB_HEADER_SIZE < xBuffer->ulSize) ? (xBuffer->ulSize - ulUsed - MPMB_HEADER_SIZE) : 0U;
+}
+
+/* Reserves ulRecord bytes that do not wrap, returns pdFALSE when full. */
+static BaseType_t prvReserve(struct MPMessageBuffer *pxBuffer, uint32_t ulRecord, uint32_t *pulPos)
+{
+  uint32_t ulHead = atomic_load_explicit(&pxBuffer->ulHead, memory_order_relaxed);
+  uint32_t ulSkip;
+
+  for (;;)
+  {
+    uint32_t ulTail = atomic_load_explicit(&pxBuffer->ulTail, memory_order_acquire);
+    uint32_t ulToEnd = pxBuffer->ulSize - (ulHead & (pxBuffer->ulSize - 1U));
+
+    ulSkip = (ulRecord > ulToEnd) ? ulToEnd : 0U;
+    if (ulSkip + ulRecord > pxBuffer->ulSize - (ulHead - ulTail))
+    {
+      return pdFALSE;
+    }
+    if (atomic_compare_exchange_weak_explicit(&pxBuffer->ulHead, &ulHead, ulHead + ulSkip + ulRecord,
+                                              memory_order_relaxed, memory_order_relaxed))
+    {
+      break;
+    }
+  }
+
+  if (ulSkip != 0U)
+  {
+    atomic_store_explicit(prvHeader(pxBuffer, ulHead), MPMB_COMMITTED | MPMB_SKIP | ulSkip, memory_order_release);
+    ulHead += ulSkip;
+  }
+  *pulPos = ulHead;
+  return pdTRUE;
+}
+
+/* Sets the committed flag of a record whose header already holds the
+length. Returns pdTRUE when the reader has to be woken. */
+static BaseType_t prvPublish(struct MPMessageBuffer *pxBuffer, atomic_uint *pxHeader)
+{
+  atomic_fetch_or_explicit(pxHeader, MPMB_COMMITTED, memory_order_release);
+
+  return atomic_exchange(&pxBuffer->xReaderWaiting, 0) != 0;
+}
+
+/* Reserves space for xLength bytes and writes the (not yet committed)
+header, blocking up to xTicksToWait. Returns the payload or NULL. */
+static uint8_t *prvReserveMessage(struct MPMessageBuffer *pxBuffer, size_t xLength, TickType_t xTicksToWait)
+{
+  uint32_t ulRecord = prvRecordSize(xLength);
+  uint32_t ulPos;
+  TimeOut_t xTimeOut;
+
+  if (xLength == 0U || xLength > xMPMessageBufferMaxMessageSize(pxBuffer))
+  {
+    return NULL;
+  }
+
+  vTaskSetTimeOutState(&xTimeOut);
+  for (;;)
+  {
+    if (prvReserve(pxBuffer, ulRecord, &ulPos) != pdFALSE)
+    {
+      break;
+    }
+    if (xTicksToWait == 0U)
+    {
+      return NULL;
+    }
+
+    /* Register first, then retry: space freed in between either is seen
+    by the retry or the reader finds the registration and gives a token. */
+    atomic_fetch_add(&pxBuffer->ulWritersWaiting, 1U);
+    if (prvReserve(pxBuffer, ulRecord, &ulPos) != pdFALSE)
+    {
+      break;
+    }
+    if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+    {
+      return NULL;
+    }
+    xSemaphoreTake(pxBuffer->xSpaceFree, xTicksToWait);
+  }
+
+  atomic_store_explicit(prvHeader(pxBuffer, ulPos), (uint32_t)xLength, memory_order_relaxed);
+  return &pxBuffer->pucStorage[(ulPos & (pxBuffer->ulSize - 1U)) + MPMB_HEADER_SIZE];
+}
+
+static uint8_t *prvReserveMessageFromISR(struct MPMessageBuffer *pxBuffer, size_t xLength)
+{
+  uint32_t ulPos;
+
+  if (xLength == 0U || xLength > xMPMessageBufferMaxMessageSize(pxBuffer) ||
+      prvReserve(pxBuffer, prvRecordSize(xLength), &ulPos) == pdFALSE)
+  {
+    return NULL;
+  }
+
+  atomic_store_explicit(prvHeader(pxBuffer, ulPos), (uint32_t)xLength, memory_order_relaxed);
+  return &pxBuffer->pucStorage[(ulPos & (pxBuffer->ulSize - 1U)) + MPMB_HEADER_SIZE];
+}
+
+static inline atomic_uint *prvPayloadHeader(void *pvPayload)
+{
+  return (atomic_uint *)((uint8_t *)pvPayload - MPMB_HEADER_SIZE);
+}
+
+size_t xMPMessageBufferSend(MPMessageBufferHandle_t xBuffer, const void *pvTxData,
+                            size_t xDataLengthBytes, TickType_t xTicksToWait)
+{
+  uint8_t *pucPayload = prvReserveMessage(xBuffer, xDataLengthBytes, xTicksToWait);
+
+  if (pucPayload == NULL)
+  {
+    return 0U;
+  }
+
+  memcpy(pucPayload, pvTxData, xDataLengthBytes);
+  vMPMessageBufferCommit(xBuffer, pucPayload);
+  return xDataLengthBytes;
+}
+
+size_t xMPMessageBufferSendFromISR(MPMessageBufferHandle_t xBuffer, const void *pvTxData,
+                                   size_t xDataLengthBytes, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  uint8_t *pucPayload = prvReserveMessageFromISR(xBuffer, xDataLengthBytes);
+
+  if (pucPayload == NULL)
+  {
+    return 0U;
+  }
+
+  memcpy(pucPayload, pvTxData, xDataLengthBytes);
+  vMPMessageBufferCommitFromISR(xBuffer, pucPayload, pxHigherPriorityTaskWoken);
+  return xDataLengthBytes;
+}
+
+void *pvMPMessageBufferReserve(MPMessageBufferHandle_t xBuffer, size_t xDataLengthBytes, TickType_t xTicksToWait)
+{
+  return prvReserveMessage(xBuffer, xDataLengthBytes, xTicksToWait);
+}
+
+void *pvMPMessageBufferReserveFromISR(MPMessageBufferHandle_t xBuffer, size_t xDataLengthBytes)
+{
+  return prvReserveMessageFromISR(xBuffer, xDataLengthBytes);
+}
+
+void vMPMessageBufferCommit(MPMessageBufferHandle_t xBuffer, void *pvReserved)
+{
+  if (prvPublish(xBuffer, prvPayloadHeader(pvReserved)) != pdFALSE)
+  {
+    xSemaphoreGive(xBuffer->xDataReady);
+  }
+}
+
+void vMPMessageBufferCommitFromISR(MPMessageBufferHandle_t xBuffer, void *pvReserved,
+                                   BaseType_t *pxHigherPriorityTaskWoken)
+{
+  if (prvPublish(xBuffer, prvPayloadHeader(pvReserved)) != pdFALSE)
+  {
+    xSemaphoreGiveFromISR(xBuffer->xDataReady, pxHigherPriorityTaskWoken);
+  }
+}
+
+/* Clears a consumed record and hands its space back to the writers. */
+static void prvRelease(struct MPMessageBuffer *pxBuffer, uint32_t ulTail, uint32_t ulRecord)
+{
+  uint32_t ulWaiting;
+
+  memset(&pxBuffer->pucStorage[ulTail & (pxBuffer->ulSize - 1U)], 0, ulRecord);
+  atomic_store_explicit(&pxBuffer->ulTail, ulTail + ulRecord, memory_order_release);
+
+  ulWaiting = atomic_exchange(&pxBuffer->ulWritersWaiting, 0U);
+  while (ulWaiting-- > 0U)
+  {
+    if (xSemaphoreGive(pxBuffer->xSpaceFree) != pdTRUE)
+    {
+      break;
+    }
+  }
+}
+
+/* Returns the payload of the committed message at the read position (skip
+records are released on the way) or NULL when there is none yet. */
+static uint8_t *prvPeek(struct MPMessageBuffer *pxBuffer, size_t *pxLength)
+{
+  uint32_t ulTail = atomic_load_explicit(&pxBuffer->ulTail, memory_order_relaxed);
+
+  for (;;)
+  {
+    uint32_t ulHeader;
+
+    if (atomic_load_explicit(&pxBuffer->ulHead, memory_order_acquire) == ulTail)
+    {
+      return NULL;
+    }
+
+    ulHeader = atomic_load_explicit(prvHeader(pxBuffer, ulTail), memory_order_acquire);
+    if ((ulHeader & MPMB_COMMITTED) == 0U)
+    {
+      return NULL;
+    }
+
+    if ((ulHeader & MPMB_SKIP) != 0U)
+    {
+      prvRelease(pxBuffer, ulTail, ulHeader & MPMB_LENGTH_MASK);
+      ulTail += ulHeader & MPMB_LENGTH_MASK;
+      continue;
+    }
+
+    *pxLength = ulHeader & MPMB_LENGTH_MASK;
+    return &pxBuffer->pucStorage[(ulTail & (pxBuffer->ulSize - 1U)) + MPMB_HEADER_SIZE];
+  }
+}
+
+/* Blocks up to xTicksToWait for a message, see prvPeek(). */
+static uint8_t *prvWaitMessage(struct MPMessageBuffer *pxBuffer, size_t *pxLength, TickType_t xTicksToWait)
+{
+  uint8_t *pucPayload;
+  TimeOut_t xTimeOut;
+
+  vTaskSetTimeOutState(&xTimeOut);
+  for (;;)
+  {
+    pucPayload = prvPeek(pxBuffer, pxLength);
+    if (pucPayload != NULL || xTicksToWait == 0U)
+    {
+      return pucPayload;
+    }
+
+    atomic_store(&pxBuffer->xReaderWaiting, 1);
+    pucPayload = prvPeek(pxBuffer, pxLength);
+    if (pucPayload != NULL)
+    {
+      atomic_store(&pxBuffer->xReaderWaiting, 0);
+      return pucPayload;
+    }
+    if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+    {
+      atomic_store(&pxBuffer->xReaderWaiting, 0);
+      return NULL;
+    }
+    xSemaphoreTake(pxBuffer->xDataReady, xTicksToWait);
+  }
+}
+
+size_t xMPMessageBufferReceive(MPMessageBufferHandle_t xBuffer, void *pvRxData,
+                               size_t xBufferLengthBytes, TickType_t xTicksToWait)
+{
+  size_t xLength;
+  uint8_t *pucPayload = prvWaitMessage(xBuffer, &xLength, xTicksToWait);
+
+  if (pucPayload == NULL || xLength > xBufferLengthBytes)
+  {
+    return 0U;
+  }
+
+  memcpy(pvRxData, pucPayload, xLength);
+  vMPMessageBufferRelease(xBuffer);
+  return xLength;
+}
+
+const void *pvMPMessageBufferPeek(MPMessageBufferHandle_t xBuffer, size_t *pxLength, TickType_t xTicksToWait)
+{
+  return prvWaitMessage(xBuffer, pxLength, xTicksToWait);
+}
+
+void vMPMessageBufferRelease(MPMessageBufferHandle_t xBuffer)
+{
+  uint32_t ulTail = atomic_load_explicit(&xBuffer->ulTail, memory_order_relaxed);
+  uint32_t ulHeader = atomic_load_explicit(prvHeader(xBuffer, ulTail), memory_order_relaxed);
+
+  configASSERT((ulHeader & (MPMB_COMMITTED | MPMB_SKIP)) == MPMB_COMMITTED);
+  prvRelease(xBuffer, ulTail, prvRecordSize(ulHeader & MPMB_LENGTH_MASK));
+}
@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file           : mutex_profile.c
+  * @brief          : Mutex with contention and hold time statistics
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mutex_profile.h"
+#include "perf_counter.h"
+#include "task.h"
+
+static MutexProfile_t *pxProfiles = NULL;
+
+SemaphoreHandle_t xMutexProfileCreate(MutexProfile_t *pxProfile, const char *pcName)
+{
+  pxProfile->xMutex = xSemaphoreCreateMutex();
+  if (pxProfile->xMutex == NULL)
+  {
+    return NULL;
+  }
+
+  pxProfile->pcName = pcName;
+  vMutexProfileReset(pxProfile);
+
+  taskENTER_CRITICAL();
+  pxProfile->pxNext = pxProfiles;
+  pxProfiles = pxProfile;
+  taskEXIT_CRITICAL();
+
+  return pxProfile->xMutex;
+}
+
+void vMutexProfileReset(MutexProfile_t *pxProfile)
+{
+  pxProfile->ulAcquires = 0U;
+  pxProfile->ulContended = 0U;
+  pxProfile->ulTimeouts = 0U;
+  vLatencyHistReset(&pxProfile->xWait);
+  vLatencyHistReset(&pxProfile->xHold);
+  pxProfile->cLongestHolder[0] = '\0';
+}
+
+BaseType_t xMutexProfileTake(MutexProfile_t *pxProfile, TickType_t xTicksToWait)
+{
+  uint32_t ulStart = ulPerfCounterGet();
+  BaseType_t xContended = pdFALSE;
+
+  if (xSemaphoreTake(pxProfile->xMutex, 0) != pdPASS)
+  {
+    xContended = pdTRUE;
+    if (xTicksToWait == 0U || xSemaphoreTake(pxProfile->xMutex, xTicksToWait) != pdPASS)
+    {
+      taskENTER_CRITICAL();
+      pxProfile->ulTimeouts++;
+      taskEXIT_CRITICAL();
+      return pdFAIL;
+    }
+  }
+
+  /* Holding the mutex from here on: the statistics are ours. */
+  pxProfile->ulHoldStart = ulPerfCounterGet();
+  pxProfile->ulAcquires++;
+  if (xContended != pdFALSE)
+  {
+    pxProfile->ulContended++;
+    vLatencyHistAdd(&pxProfile->xWait, pxProfile->ulHoldStart - ulStart);
+  }
+  else
+  {
+    vLatencyHistAdd(&pxProfile->xWait, 0U);
+  }
+
+  return pdPASS;
+}
+
+BaseType_t xMutexProfileGive(MutexProfile_t *pxProfile)
+{
+  uint32_t ulHold = ulPerfCounterGet() - pxProfile->ulHoldStart;
+
+  if (ulHold > pxProfile->xHold.ulMax || pxProfile->xHold.ulCount == 0U)
+  {
+    strncpy(pxProfile->cLongestHolder, pcTaskGetName(NULL), sizeof(pxProfile->cLongestHolder) - 1U);
+    pxProfile->cLongestHolder[sizeof(pxProfile->cLongestHolder) - 1U] = '\0';
+  }
+  vLatencyHistAdd(&pxProfile->xHold, ulHold);
+
+  return xSemaphoreGive(pxProfile->xMutex);
+}
+
+void vMutexProfileDump(void (*pxWrite)(const char *pcLine))
+{
+  char cLine[96];
+  MutexProfile_t *pxProfile;
+
+  for (pxProfile = pxProfiles; pxProfile != NULL; pxProfile = pxProfile->pxNext)
+  {
+    const LatencyHist_t *pxWait = &pxProfile->xWait;
+    const LatencyHist_t *pxHold = &pxProfile->xHold;
+
+    snprintf(cLine, sizeof(cLine), "%s: acquires %lu, contended %lu (%lu%%), timeouts %lu\n",
+             pxProfile->pcName, (unsigned long)pxProfile->ulAcquires, (unsigned long)pxProfile->ulContended,
+             (unsigned long)(pxProfile->ulAcquires ? (100U * pxProfile->ulContended) / pxProfile->ulAcquires : 0U),
+             (unsigned long)pxProfile->ulTimeouts);
+    pxWrite(cLine);
+
+    snprintf(cLine, sizeof(cLine), "  wait us: p50 %lu, p99 %lu, max %lu\n",
+             (unsigned long)ulPerfCounterToUs(ulLatencyHistPercentile(pxWait, 500)),
+             (unsigned long)ulPerfCounterToUs(ulLatencyHistPercentile(pxWait, 990)),
+             (unsigned long)ulPerfCounterToUs(pxWait->ulMax));
+    pxWrite(cLine);
+
+    snprintf(cLine, sizeof(cLine), "  hold us: p50 %lu, p99 %lu, max %lu by %s\n",
+             (unsigned long)ulPerfCounterToUs(ulLatencyHistPercentile(pxHold, 500)),
+             (unsigned long)ulPerfCounterToUs(ulLatencyHistPercentile(pxHold, 990)),
+             (unsigned long)ulPerfCounterToUs(pxHold->ulMax), pxProfile->cLongestHolder);
+    pxWrite(cLine);
+  }
+}
@@ -0,0 +1,18 @@
+/**
+  ******************************************************************************
+  * @file           : perf_counter.c
+  * @brief          : Free running high resolution counter for measurements
+  ******************************************************************************
+  */
+
+#include "perf_counter.h"
+
+void vPerfCounterInit(void)
+{
+#ifndef HOST_BUILD
+  /* Enable the trace block, then start the cycle counter from zero. */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
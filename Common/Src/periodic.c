@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file           : periodic.c
+  * @brief          : Periodic tasks released on an absolute time grid
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+
+#include "periodic.h"
+#include "perf_counter.h"
+#include "task.h"
+
+static PeriodicTask_t *pxPeriodicTasks = NULL;
+
+void vPeriodicInit(PeriodicTask_t *pxTask, const char *pcName, TickType_t xPeriod, TickType_t xPhase)
+{
+  TickType_t xNow = xTaskGetTickCount();
+  TickType_t xRelease = xPhase;
+
+  configASSERT(xPeriod > 0U && xPhase < xPeriod);
+
+  if (xNow > xPhase)
+  {
+    /* Next grid point at or after now, it may wrap. */
+    xRelease = xPhase + ((xNow - xPhase) / xPeriod) * xPeriod;
+    if (xRelease != xNow)
+    {
+      xRelease += xPeriod;
+    }
+  }
+
+  pxTask->pcName = pcName;
+  pxTask->xPeriod = xPeriod;
+  pxTask->xPhase = xPhase;
+  /* vTaskDelayUntil() wakes at xLastWake + xPeriod; the subtraction may
+  wrap, it handles that. */
+  pxTask->xLastWake = xRelease - xPeriod;
+  pxTask->xLate = pdFALSE;
+  vPeriodicResetStats(pxTask);
+
+  taskENTER_CRITICAL();
+  pxTask->pxNext = pxPeriodicTasks;
+  pxPeriodicTasks = pxTask;
+  taskEXIT_CRITICAL();
+}
+
+void vPeriodicResetStats(PeriodicTask_t *pxTask)
+{
+  taskENTER_CRITICAL();
+  pxTask->ulReleases = 0U;
+  pxTask->ulOverruns = 0U;
+  pxTask->ulSkipped = 0U;
+  pxTask->ulMaxJitter = 0U;
+  pxTask->ulMaxExec = 0U;
+  taskEXIT_CRITICAL();
+}
+
+void vPeriodicWait(PeriodicTask_t *pxTask)
+{
+  TickType_t xNow = xTaskGetTickCount();
+  TickType_t xNext = pxTask->xLastWake + pxTask->xPeriod;
+  uint32_t ulPrevStart = pxTask->ulJobStart;
+  BaseType_t xFirst = (pxTask->ulReleases == 0U) ? pdTRUE : pdFALSE;
+  BaseType_t xPrevLate = pxTask->xLate;
+  uint32_t ulStart;
+
+  if (xFirst == pdFALSE)
+  {
+    uint32_t ulExec = ulPerfCounterGet() - ulPrevStart;
+    if (ulExec > pxTask->ulMaxExec)
+    {
+      pxTask->ulMaxExec = ulExec;
+    }
+  }
+
+  if ((int32_t)(xNow - xNext) > 0)
+  {
+    /* Releases at xLastWake + k * xPeriod, k = 1..ulMissed, are all due,
+    one landing on xNow included: run the last one now and skip the others. */
+    uint32_t ulMissed = (uint32_t)((xNow - pxTask->xLastWake) / pxTask->xPeriod);
+
+    pxTask->ulOverruns++;
+    pxTask->ulSkipped += ulMissed - 1U;
+    pxTask->xLastWake += (TickType_t)((ulMissed - 1U) * pxTask->xPeriod);
+    pxTask->xLate = pdTRUE;
+  }
+  else
+  {
+    pxTask->xLate = pdFALSE;
+  }
+
+  vTaskDelayUntil(&pxTask->xLastWake, pxTask->xPeriod);
+
+  ulStart = ulPerfCounterGet();
+  pxTask->ulJobStart = ulStart;
+  pxTask->ulReleases++;
+
+  /* A late start and the one after it are not a period apart. */
+  if (xFirst == pdFALSE && xPrevLate == pdFALSE && pxTask->xLate == pdFALSE)
+  {
+    uint64_t ullExpected = ((uint64_t)pxTask->xPeriod * ulPerfCounterHz()) / configTICK_RATE_HZ;
+
+    /* The interval is only meaningful while it fits the counter. */
+    if (ullExpected < 0x80000000ULL)
+    {
+      int32_t lJitter = (int32_t)((ulStart - ulPrevStart) - (uint32_t)ullExpected);
+      uint32_t ulJitter = (lJitter < 0) ? (uint32_t)(-lJitter) : (uint32_t)lJitter;
+
+      if (ulJitter > pxTask->ulMaxJitter)
+      {
+        pxTask->ulMaxJitter = ulJitter;
+      }
+    }
+  }
+}
+
+void vPeriodicDump(void (*pxWrite)(const char *pcLine))
+{
+  char cLine[96];
+  PeriodicTask_t *pxTask;
+
+  for (pxTask = pxPeriodicTasks; pxTask != NULL; pxTask = pxTask->pxNext)
+  {
+    snprintf(cLine, sizeof(cLine), "%s: %lu+%lu ms, releases %lu, overruns %lu, skipped %lu\n",
+             pxTask->pcName, (unsigned long)(pxTask->xPeriod * portTICK_PERIOD_MS),
+             (unsigned long)(pxTask->xPhase * portTICK_PERIOD_MS), (unsigned long)pxTask->ulReleases,
+             (unsigned long)pxTask->ulOverruns, (unsigned long)pxTask->ulSkipped);
+    pxWrite(cLine);
+
+    snprintf(cLine, sizeof(cLine), "  max jitter %lu us, max exec %lu us\n",
+             (unsigned long)ulPerfCounterToUs(pxTask->ulMaxJitter), (unsigned long)ulPerfCounterToUs(pxTask->ulMaxExec));
+    pxWrite(cLine);
+  }
+}
@@ -0,0 +1,355 @@
+/**
+  ******************************************************************************
+  * @file           : prio_inversion.c
+  * @brief          : Priority inversion detector with a timeline export
+  ******************************************************************************
+  * @attention
+  *
+  * The hooks run inside the kernel: take, give and the priority changes in
+  * a critical section, blocking with the scheduler suspended, gives from
+  * interrupts in the ISR. They only touch the tables below with interrupts
+  * masked and never block. The task priorities an inversion needs are read
+  * before masking, uxTaskPriorityGet() has its own critical section.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+
+#include "prio_inversion.h"
+#include "perf_counter.h"
+#include "task.h"
+#include "queue.h"
+
+typedef enum
+{
+  eEventBlock = 0,
+  eEventAcquire,
+  eEventTimeout,
+  eEventBoost,
+  eEventRestore
+} PrioInversionEventType_t;
+
+typedef struct
+{
+  TickType_t xTick;
+  void *pvLock;
+  TaskHandle_t xTask;
+  TaskHandle_t xOther;
+  uint32_t ulDurationUs;
+  uint8_t ucType;
+  uint8_t ucPriority;
+  uint8_t ucOtherPriority;
+} PrioInversionEvent_t;
+
+typedef struct
+{
+  void *pvLock;
+  TaskHandle_t xHolder;
+} PrioInversionLock_t;
+
+typedef struct
+{
+  TaskHandle_t xWaiter;
+  TaskHandle_t xHolder;
+  void *pvLock;
+  uint32_t ulStart;
+  UBaseType_t uxPriority;
+} PrioInversionOpen_t;
+
+static const char * const pcEventNames[] = { "block", "acquire", "timeout", "boost", "restore" };
+
+static PrioInversionEvent_t xTimeline[PRIO_INVERSION_TIMELINE_SIZE];
+static uint32_t ulHead;     /* next write, free running */
+static uint32_t ulTail;     /* next read, free running */
+
+static PrioInversionLock_t xLocks[PRIO_INVERSION_MAX_LOCKS];
+static PrioInversionOpen_t xOpen[PRIO_INVERSION_MAX_OPEN];
+static PrioInversionStats_t xStats;
+
+/* Interrupts masked. */
+static void prvRecord(PrioInversionEventType_t eType, void *pvLock, TaskHandle_t xTask, UBaseType_t uxPriority,
+                      TaskHandle_t xOther, UBaseType_t uxOtherPriority, uint32_t ulDurationUs)
+{
+  PrioInversionEvent_t *pxEvent;
+
+  if (ulHead - ulTail >= PRIO_INVERSION_TIMELINE_SIZE)
+  {
+    xStats.ulDropped++;
+    return;
+  }
+
+  pxEvent = &xTimeline[ulHead % PRIO_INVERSION_TIMELINE_SIZE];
+  pxEvent->xTick = xTaskGetTickCountFromISR();
+  pxEvent->pvLock = pvLock;
+  pxEvent->xTask = xTask;
+  pxEvent->xOther = xOther;
+  pxEvent->ulDurationUs = ulDurationUs;
+  pxEvent->ucType = (uint8_t)eType;
+  pxEvent->ucPriority = (uint8_t)uxPriority;
+  pxEvent->ucOtherPriority = (uint8_t)uxOtherPriority;
+  ulHead++;
+}
+
+/* Interrupts masked. Returns NULL when every slot is in use. */
+static PrioInversionLock_t *prvFindLock(void *pvLock, BaseType_t xCreate)
+{
+  PrioInversionLock_t *pxFree = NULL;
+  uint32_t i;
+
+  for (i = 0U; i < PRIO_INVERSION_MAX_LOCKS; i++)
+  {
+    if (xLocks[i].pvLock == pvLock)
+    {
+      return &xLocks[i];
+    }
+    if (pxFree == NULL && xLocks[i].pvLock == NULL)
+    {
+      pxFree = &xLocks[i];
+    }
+  }
+
+  if (xCreate != pdFALSE && pxFree != NULL)
+  {
+    pxFree->pvLock = pvLock;
+    pxFree->xHolder = NULL;
+    return pxFree;
+  }
+
+  return NULL;
+}
+
+static PrioInversionOpen_t *prvFindOpen(TaskHandle_t xWaiter)
+{
+  uint32_t i;
+
+  for (i = 0U; i < PRIO_INVERSION_MAX_OPEN; i++)
+  {
+    if (xOpen[i].xWaiter == xWaiter)
+    {
+      return &xOpen[i];
+    }
+  }
+
+  return NULL;
+}
+
+/* Interrupts masked. Ends the inversion of xWaiter, if it is in one. */
+static void prvEnd(TaskHandle_t xWaiter, PrioInversionEventType_t eType)
+{
+  PrioInversionOpen_t *pxOpen = prvFindOpen(xWaiter);
+  uint32_t ulDurationUs;
+
+  if (pxOpen == NULL)
+  {
+    return;
+  }
+
+  ulDurationUs = ulPerfCounterToUs(ulPerfCounterGet() - pxOpen->ulStart);
+  xStats.ulTotalUs += ulDurationUs;
+  if (ulDurationUs > xStats.ulWorstUs)
+  {
+    xStats.ulWorstUs = ulDurationUs;
+  }
+  if (eType == eEventTimeout)
+  {
+    xStats.ulTimeouts++;
+  }
+
+  prvRecord(eType, pxOpen->pvLock, xWaiter, pxOpen->uxPriority, pxOpen->xHolder, 0U, ulDurationUs);
+  pxOpen->xWaiter = NULL;
+}
+
+void vPrioInversionTraceTake(void *pvLock)
+{
+  TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+  PrioInversionLock_t *pxLock;
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  pxLock = prvFindLock(pvLock, pdTRUE);
+  if (pxLock != NULL)
+  {
+    pxLock->xHolder = xTask;
+  }
+  prvEnd(xTask, eEventAcquire);
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void vPrioInversionTraceTakeFailed(void *pvLock)
+{
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  (void)pvLock;
+  prvEnd(xTaskGetCurrentTaskHandle(), eEventTimeout);
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void vPrioInversionTraceGive(void *pvLock)
+{
+  PrioInversionLock_t *pxLock;
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  pxLock = prvFindLock(pvLock, pdFALSE);
+  if (pxLock != NULL)
+  {
+    pxLock->xHolder = NULL;
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void vPrioInversionTraceBlocking(void *pvLock)
+{
+  TaskHandle_t xWaiter = xTaskGetCurrentTaskHandle();
+  TaskHandle_t xHolder = NULL;
+  PrioInversionLock_t *pxLock;
+  PrioInversionOpen_t *pxOpen;
+  UBaseType_t uxWaiterPriority;
+  UBaseType_t uxHolderPriority;
+  UBaseType_t uxSavedInterruptStatus;
+
+  /* Called again each time the waiter loses the lock to another task after
+  a wakeup: the inversion that is already open goes on. */
+  if (prvFindOpen(xWaiter) != NULL)
+  {
+    return;
+  }
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  pxLock = prvFindLock(pvLock, pdFALSE);
+  if (pxLock != NULL)
+  {
+    xHolder = pxLock->xHolder;
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if (xHolder == NULL || xHolder == xWaiter)
+  {
+    return;
+  }
+
+  uxWaiterPriority = uxTaskPriorityGet(NULL);
+  uxHolderPriority = uxTaskPriorityGet(xHolder);
+  if (uxHolderPriority >= uxWaiterPriority)
+  {
+    return;
+  }
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  pxOpen = prvFindOpen(NULL);
+  if (pxOpen != NULL)
+  {
+    pxOpen->xWaiter = xWaiter;
+    pxOpen->xHolder = xHolder;
+    pxOpen->pvLock = pvLock;
+    pxOpen->uxPriority = uxWaiterPriority;
+    pxOpen->ulStart = ulPerfCounterGet();
+  }
+  xStats.ulInversions++;
+  prvRecord(eEventBlock, pvLock, xWaiter, uxWaiterPriority, xHolder, uxHolderPriority, 0U);
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void vPrioInversionTracePriority(void *pvTask, unsigned long ulFrom, unsigned long ulTo)
+{
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  if (ulTo > ulFrom)
+  {
+    xStats.ulBoosts++;
+    prvRecord(eEventBoost, NULL, (TaskHandle_t)pvTask, ulTo, NULL, ulFrom, 0U);
+  }
+  else if (ulTo < ulFrom)
+  {
+    xStats.ulRestores++;
+    prvRecord(eEventRestore, NULL, (TaskHandle_t)pvTask, ulTo, NULL, ulFrom, 0U);
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void vPrioInversionGetStats(PrioInversionStats_t *pxStats)
+{
+  taskENTER_CRITICAL();
+  *pxStats = xStats;
+  taskEXIT_CRITICAL();
+}
+
+void vPrioInversionResetStats(void)
+{
+  taskENTER_CRITICAL();
+  xStats.ulInversions = 0U;
+  xStats.ulTimeouts = 0U;
+  xStats.ulBoosts = 0U;
+  xStats.ulRestores = 0U;
+  xStats.ulTotalUs = 0U;
+  xStats.ulWorstUs = 0U;
+  xStats.ulDropped = 0U;
+  taskEXIT_CRITICAL();
+}
+
+static const char *prvLockName(void *pvLock, char *pcBuffer, size_t xSize)
+{
+  const char *pcName = NULL;
+
+  if (pvLock == NULL)
+  {
+    return "";
+  }
+#if (configQUEUE_REGISTRY_SIZE > 0)
+  pcName = pcQueueGetName((QueueHandle_t)pvLock);
+#endif
+  if (pcName == NULL)
+  {
+    snprintf(pcBuffer, xSize, "%p", pvLock);
+    pcName = pcBuffer;
+  }
+
+  return pcName;
+}
+
+void vPrioInversionExport(void (*pxWrite)(const char *pcLine))
+{
+  char cLine[128];
+  char cLock[20];
+  PrioInversionEvent_t xEvent;
+
+  pxWrite("tick,event,lock,task,priority,other,other_priority,duration_us\n");
+
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    if (ulTail == ulHead)
+    {
+      taskEXIT_CRITICAL();
+      break;
+    }
+    xEvent = xTimeline[ulTail % PRIO_INVERSION_TIMELINE_SIZE];
+    ulTail++;
+    taskEXIT_CRITICAL();
+
+    if (xEvent.ucType == (uint8_t)eEventBlock)
+    {
+      snprintf(cLine, sizeof(cLine), "%lu,%s,%s,%s,%u,%s,%u,\n", (unsigned long)xEvent.xTick,
+               pcEventNames[xEvent.ucType], prvLockName(xEvent.pvLock, cLock, sizeof(cLock)),
+               pcTaskGetName(xEvent.xTask), xEvent.ucPriority, pcTaskGetName(xEvent.xOther),
+               xEvent.ucOtherPriority);
+    }
+    else if (xEvent.ucType == (uint8_t)eEventAcquire || xEvent.ucType == (uint8_t)eEventTimeout)
+    {
+      snprintf(cLine, sizeof(cLine), "%lu,%s,%s,%s,%u,%s,,%lu\n", (unsigned long)xEvent.xTick,
+               pcEventNames[xEvent.ucType], prvLockName(xEvent.pvLock, cLock, sizeof(cLock)),
+               pcTaskGetName(xEvent.xTask), xEvent.ucPriority, pcTaskGetName(xEvent.xOther),
+               (unsigned long)xEvent.ulDurationUs);
+    }
+    else
+    {
+      snprintf(cLine, sizeof(cLine), "%lu,%s,,%s,%u,,%u,\n", (unsigned long)xEvent.xTick,
+               pcEventNames[xEvent.ucType], pcTaskGetName(xEvent.xTask), xEvent.ucPriority,
+               xEvent.ucOtherPriority);
+    }
+    pxWrite(cLine);
+  }
+}
@@ -0,0 +1,438 @@
+/**
+  ******************************************************************************
+  * @file           : prio_queue.c
+  * @brief          : Queue that always returns the most urgent item
+  ******************************************************************************
+  * @attention
+  *
+  * Behind the control block: the heap of entries, a stack of free slot
+  * numbers and the item slots. A send takes a free slot, copies the item in
+  * and sifts a new entry up; a receive copies the root's item out, returns
+  * its slot and sifts the last entry down.
+  *
+  * Blocked senders and receivers wait in FIFO lists of records that live on
+  * their own stacks. Every send or receive moves one item, so it wakes at
+  * most one task of the other side; the woken task tries again and waits
+  * again if another task was faster.
+  *
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "prio_queue.h"
+#include "task.h"
+
+/* Same idea as the kernel's traceQUEUE_xxx() macros: a trace header included
+by FreeRTOSConfig.h may define it, see queue_metrics_trace.h. */
+#ifndef tracePRIO_QUEUE_EVENT
+#define tracePRIO_QUEUE_EVENT(uxQueueNumber, ev, uxLevel)
+#endif
+
+typedef struct
+{
+  uint32_t ulKey;
+  uint32_t ulSeq;                    /* send order, breaks ties */
+  UBaseType_t uxSlot;
+} PrioQueueEntry_t;
+
+typedef struct PrioQueueWaiter
+{
+  TaskHandle_t xTask;
+  volatile BaseType_t xWoken;
+  struct PrioQueueWaiter *pxNext;
+} PrioQueueWaiter_t;
+
+typedef struct
+{
+  PrioQueueWaiter_t *pxHead;
+  PrioQueueWaiter_t *pxTail;
+} PrioQueueWaitList_t;
+
+struct PrioQueue
+{
+  PrioQueueEntry_t *pxHeap;
+  UBaseType_t *puxFreeSlots;
+  uint8_t *pucSlots;
+  UBaseType_t uxLength;
+  UBaseType_t uxItemSize;
+  UBaseType_t uxWaiting;             /* entries in the heap */
+  uint32_t ulNextSeq;
+  UBaseType_t uxQueueNumber;
+  PrioQueueWaitList_t xSenders;
+  PrioQueueWaitList_t xReceivers;
+};
+
+PrioQueueHandle_t xPrioQueueCreate(UBaseType_t uxLength, UBaseType_t uxItemSize)
+{
+  struct PrioQueue *pxQueue;
+  UBaseType_t i;
+
+  configASSERT(uxLength > 0U && uxItemSize > 0U);
+
+  pxQueue = pvPortMalloc(sizeof(struct PrioQueue) + (size_t)uxLength * sizeof(PrioQueueEntry_t) +
+                         (size_t)uxLength * sizeof(UBaseType_t) + (size_t)uxLength * uxItemSize);
+  if (pxQueue == NULL)
+  {
+    return NULL;
+  }
+
+  memset(pxQueue, 0, sizeof(struct PrioQueue));
+  pxQueue->pxHeap = (PrioQueueEntry_t *)(pxQueue + 1);
+  pxQueue->puxFreeSlots = (UBaseType_t *)(pxQueue->pxHeap + uxLength);
+  pxQueue->pucSlots = (uint8_t *)(pxQueue->puxFreeSlots + uxLength);
+  pxQueue->uxLength = uxLength;
+  pxQueue->uxItemSize = uxItemSize;
+
+  for (i = 0U; i < uxLength; i++)
+  {
+    pxQueue->puxFreeSlots[i] = i;
+  }
+
+  return pxQueue;
+}
+
+void vPrioQueueDelete(PrioQueueHandle_t xQueue)
+{
+  configASSERT(xQueue->xSenders.pxHead == NULL && xQueue->xReceivers.pxHead == NULL);
+
+  vPortFree(xQueue);
+}
+
+/* pdTRUE when a must come out before b. */
+static inline BaseType_t prvBefore(const PrioQueueEntry_t *pxA, const PrioQueueEntry_t *pxB)
+{
+  if (pxA->ulKey != pxB->ulKey)
+  {
+    return ((int32_t)(pxA->ulKey - pxB->ulKey) < 0) ? pdTRUE : pdFALSE;
+  }
+  return ((int32_t)(pxA->ulSeq - pxB->ulSeq) < 0) ? pdTRUE : pdFALSE;
+}
+
+/* Critical section. pdFALSE when full. */
+static BaseType_t prvPush(struct PrioQueue *pxQueue, const void *pvItem, uint32_t ulKey)
+{
+  PrioQueueEntry_t xEntry;
+  UBaseType_t uxHole;
+
+  if (pxQueue->uxWaiting == pxQueue->uxLength)
+  {
+    return pdFALSE;
+  }
+
+  /* The free stack holds uxLength - uxWaiting slots, its top is the last. */
+  xEntry.uxSlot = pxQueue->puxFreeSlots[pxQueue->uxLength - pxQueue->uxWaiting - 1U];
+  xEntry.ulKey = ulKey;
+  xEntry.ulSeq = pxQueue->ulNextSeq++;
+  memcpy(&pxQueue->pucSlots[(size_t)xEntry.uxSlot * pxQueue->uxItemSize], pvItem, pxQueue->uxItemSize);
+
+  uxHole = pxQueue->uxWaiting++;
+  while (uxHole > 0U)
+  {
+    UBaseType_t uxParent = (uxHole - 1U) / 2U;
+
+    if (prvBefore(&xEntry, &pxQueue->pxHeap[uxParent]) == pdFALSE)
+    {
+      break;
+    }
+    pxQueue->pxHeap[uxHole] = pxQueue->pxHeap[uxParent];
+    uxHole = uxParent;
+  }
+  pxQueue->pxHeap[uxHole] = xEntry;
+
+  return pdTRUE;
+}
+
+/* Critical section. pdFALSE when empty. */
+static BaseType_t prvPop(struct PrioQueue *pxQueue, void *pvItem, uint32_t *pulKey)
+{
+  PrioQueueEntry_t xLast;
+  UBaseType_t uxHole = 0U;
+  UBaseType_t uxSlot;
+
+  if (pxQueue->uxWaiting == 0U)
+  {
+    return pdFALSE;
+  }
+
+  uxSlot = pxQueue->pxHeap[0].uxSlot;
+  memcpy(pvItem, &pxQueue->pucSlots[(size_t)uxSlot * pxQueue->uxItemSize], pxQueue->uxItemSize);
+  if (pulKey != NULL)
+  {
+    *pulKey = pxQueue->pxHeap[0].ulKey;
+  }
+
+  xLast = pxQueue->pxHeap[--pxQueue->uxWaiting];
+  pxQueue->puxFreeSlots[pxQueue->uxLength - pxQueue->uxWaiting - 1U] = uxSlot;
+
+  for (;;)
+  {
+    UBaseType_t uxChild = 2U * uxHole + 1U;
+
+    if (uxChild >= pxQueue->uxWaiting)
+    {
+      break;
+    }
+    if (uxChild + 1U < pxQueue->uxWaiting &&
+        prvBefore(&pxQueue->pxHeap[uxChild + 1U], &pxQueue->pxHeap[uxChild]) != pdFALSE)
+    {
+      uxChild++;
+    }
+    if (prvBefore(&pxQueue->pxHeap[uxChild], &xLast) == pdFALSE)
+    {
+      break;
+    }
+    pxQueue->pxHeap[uxHole] = pxQueue->pxHeap[uxChild];
+    uxHole = uxChild;
+  }
+  pxQueue->pxHeap[uxHole] = xLast;
+
+  return pdTRUE;
+}
+
+/* Critical section. Wakes the first task of pxList, if any.
+pxHigherPriorityTaskWoken is NULL in a task. */
+static void prvWakeOne(PrioQueueWaitList_t *pxList, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  PrioQueueWaiter_t *pxWaiter = pxList->pxHead;
+
+  if (pxWaiter == NULL)
+  {
+    return;
+  }
+
+  pxList->pxHead = pxWaiter->pxNext;
+  if (pxList->pxHead == NULL)
+  {
+    pxList->pxTail = NULL;
+  }
+  pxWaiter->xWoken = pdTRUE;
+
+  if (pxHigherPriorityTaskWoken != NULL)
+  {
+    vTaskNotifyGiveFromISR(pxWaiter->xTask, pxHigherPriorityTaskWoken);
+  }
+  else
+  {
+    (void)xTaskNotifyGive(pxWaiter->xTask);
+  }
+}
+
+/* Critical section. */
+static void prvEnqueue(PrioQueueWaitList_t *pxList, PrioQueueWaiter_t *pxWaiter)
+{
+  pxWaiter->xTask = xTaskGetCurrentTaskHandle();
+  pxWaiter->xWoken = pdFALSE;
+  pxWaiter->pxNext = NULL;
+
+  if (pxList->pxTail == NULL)
+  {
+    pxList->pxHead = pxWaiter;
+  }
+  else
+  {
+    pxList->pxTail->pxNext = pxWaiter;
+  }
+  pxList->pxTail = pxWaiter;
+}
+
+/* Critical section. */
+static void prvRemove(PrioQueueWaitList_t *pxList, PrioQueueWaiter_t *pxWaiter)
+{
+  PrioQueueWaiter_t *pxPrevious = NULL;
+  PrioQueueWaiter_t *pxIterator = pxList->pxHead;
+
+  while (pxIterator != NULL && pxIterator != pxWaiter)
+  {
+    pxPrevious = pxIterator;
+    pxIterator = pxIterator->pxNext;
+  }
+  configASSERT(pxIterator != NULL);
+
+  if (pxPrevious == NULL)
+  {
+    pxList->pxHead = pxWaiter->pxNext;
+  }
+  else
+  {
+    pxPrevious->pxNext = pxWaiter->pxNext;
+  }
+  if (pxList->pxTail == pxWaiter)
+  {
+    pxList->pxTail = pxPrevious;
+  }
+}
+
+/* Blocks on pxList until woken or until the time runs out. */
+static void prvWait(PrioQueueWaitList_t *pxList, PrioQueueWaiter_t *pxWaiter, TimeOut_t *pxTimeOut,
+                    TickType_t *pxTicksToWait)
+{
+  (void)ulTaskNotifyTake(pdTRUE, *pxTicksToWait);
+
+  taskENTER_CRITICAL();
+  if (pxWaiter->xWoken == pdFALSE)
+  {
+    prvRemove(pxList, pxWaiter);
+  }
+  taskEXIT_CRITICAL();
+
+  if (xTaskCheckForTimeOut(pxTimeOut, pxTicksToWait) != pdFALSE)
+  {
+    /* One last try, then give up. */
+    *pxTicksToWait = 0U;
+  }
+}
+
+BaseType_t xPrioQueueSend(PrioQueueHandle_t xQueue, const void *pvItem, uint32_t ulKey, TickType_t xTicksToWait)
+{
+  PrioQueueWaiter_t xWaiter;
+  TimeOut_t xTimeOut;
+
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    {
+      if (prvPush(xQueue, pvItem, ulKey) != pdFALSE)
+      {
+        tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_SEND, xQueue->uxWaiting);
+        prvWakeOne(&xQueue->xReceivers, NULL);
+        taskEXIT_CRITICAL();
+        return pdPASS;
+      }
+
+      if (xTicksToWait == 0U)
+      {
+        tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_SEND_FAILED, xQueue->uxWaiting);
+        taskEXIT_CRITICAL();
+        return pdFAIL;
+      }
+
+      tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_BLOCK_SEND, xQueue->uxWaiting);
+      prvEnqueue(&xQueue->xSenders, &xWaiter);
+    }
+    taskEXIT_CRITICAL();
+
+    prvWait(&xQueue->xSenders, &xWaiter, &xTimeOut, &xTicksToWait);
+  }
+}
+
+BaseType_t xPrioQueueReceive(PrioQueueHandle_t xQueue, void *pvItem, uint32_t *pulKey, TickType_t xTicksToWait)
+{
+  PrioQueueWaiter_t xWaiter;
+  TimeOut_t xTimeOut;
+
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    {
+      if (prvPop(xQueue, pvItem, pulKey) != pdFALSE)
+      {
+        tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_RECEIVE, xQueue->uxWaiting);
+        prvWakeOne(&xQueue->xSenders, NULL);
+        taskEXIT_CRITICAL();
+        return pdPASS;
+      }
+
+      if (xTicksToWait == 0U)
+      {
+        tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_RECEIVE_FAILED, xQueue->uxWaiting);
+        taskEXIT_CRITICAL();
+        return pdFAIL;
+      }
+
+      tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_BLOCK_RECEIVE, xQueue->uxWaiting);
+      prvEnqueue(&xQueue->xReceivers, &xWaiter);
+    }
+    taskEXIT_CRITICAL();
+
+    prvWait(&xQueue->xReceivers, &xWaiter, &xTimeOut, &xTicksToWait);
+  }
+}
+
+BaseType_t xPrioQueueSendFromISR(PrioQueueHandle_t xQueue, const void *pvItem, uint32_t ulKey,
+                                 BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xWoken = pdFALSE;
+  BaseType_t xReturn;
+  UBaseType_t uxSavedInterruptStatus;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  xReturn = prvPush(xQueue, pvItem, ulKey);
+  if (xReturn != pdFALSE)
+  {
+    tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_SEND_FROM_ISR, xQueue->uxWaiting);
+    prvWakeOne(&xQueue->xReceivers, &xWoken);
+  }
+  else
+  {
+    tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_SEND_FROM_ISR_FAILED, xQueue->uxWaiting);
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if (pxHigherPriorityTaskWoken != NULL && xWoken != pdFALSE)
+  {
+    *pxHigherPriorityTaskWoken = pdTRUE;
+  }
+  return (xReturn != pdFALSE) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xPrioQueueReceiveFromISR(PrioQueueHandle_t xQueue, void *pvItem, uint32_t *pulKey,
+                                    BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xWoken = pdFALSE;
+  BaseType_t xReturn;
+  UBaseType_t uxSavedInterruptStatus;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  xReturn = prvPop(xQueue, pvItem, pulKey);
+  if (xReturn != pdFALSE)
+  {
+    tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_RECEIVE_FROM_ISR, xQueue->uxWaiting);
+    prvWakeOne(&xQueue->xSenders, &xWoken);
+  }
+  else
+  {
+    tracePRIO_QUEUE_EVENT(xQueue->uxQueueNumber, QUEUE_METRICS_RECEIVE_FROM_ISR_FAILED, xQueue->uxWaiting);
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if (pxHigherPriorityTaskWoken != NULL && xWoken != pdFALSE)
+  {
+    *pxHigherPriorityTaskWoken = pdTRUE;
+  }
+  return (xReturn != pdFALSE) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xPrioQueuePeekKey(PrioQueueHandle_t xQueue, uint32_t *pulKey)
+{
+  BaseType_t xReturn = pdFAIL;
+
+  taskENTER_CRITICAL();
+  if (xQueue->uxWaiting > 0U)
+  {
+    *pulKey = xQueue->pxHeap[0].ulKey;
+    xReturn = pdPASS;
+  }
+  taskEXIT_CRITICAL();
+
+  return xReturn;
+}
+
+UBaseType_t uxPrioQueueMessagesWaiting(PrioQueueHandle_t xQueue)
+{
+  return xQueue->uxWaiting;
+}
+
+UBaseType_t uxPrioQueueSpacesAvailable(PrioQueueHandle_t xQueue)
+{
+  return xQueue->uxLength - xQueue->uxWaiting;
+}
+
+void vPrioQueueSetQueueNumber(PrioQueueHandle_t xQueue, UBaseType_t uxQueueNumber)
+{
+  xQueue->uxQueueNumber = uxQueueNumber;
+}
@@ -0,0 +1,499 @@
+/**
+  ******************************************************************************
+  * @file           : queue_metrics.c
+  * @brief          : Occupancy, blocking time and failure counters per queue
+  ******************************************************************************
+  * @attention
+  *
+  * An object's number (uxQueueNumber, uxStreamBufferNumber or the PrioQueue
+  * one) is its index in xMetrics plus one, so a hook finds its counters
+  * without a search.
+  *
+  * The kernel reports "about to block" and, later in the same call, the
+  * send / receive or the failure, but not which task: a blocked task is
+  * remembered in xWaiters, by handle, from the first block until that end
+  * of the call. Waking up and blocking again keeps the first start time.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "queue_metrics.h"
+#include "perf_counter.h"
+#include "periodic.h"
+#include "task.h"
+
+/* Only for the examples whose FreeRTOSConfig.h includes
+queue_metrics_trace.h (configUSE_TRACE_FACILITY 1, for vQueueSetQueueNumber()
+and uxStreamBufferNumber), nothing else could call it. */
+#if defined(QUEUE_METRICS_TRACE_H)
+
+typedef struct
+{
+  uint32_t ulCount;
+  uint32_t ulMaxUs;
+  uint64_t ullTotalUs;
+  uint32_t ulBucket[QUEUE_METRICS_WAIT_BUCKETS];
+} QueueMetricsWait_t;
+
+typedef struct
+{
+  const char *pcName;
+  uint32_t ulCapacity;
+  uint32_t ulLevel;
+  uint32_t ulPeak;
+  uint32_t ulSends;
+  uint32_t ulSendFailed;
+  uint32_t ulReceives;
+  uint32_t ulReceiveFailed;
+  QueueMetricsWait_t xSendWait;
+  QueueMetricsWait_t xReceiveWait;
+  uint32_t ulFill[QUEUE_METRICS_FILL_BUCKETS];
+  uint16_t usSample[QUEUE_METRICS_SAMPLES];
+  uint32_t ulSamples;                  /* taken since the reset */
+} QueueMetrics_t;
+
+typedef struct
+{
+  TaskHandle_t xTask;                  /* NULL = free */
+  UBaseType_t uxIndex;
+  BaseType_t xSend;
+  uint32_t ulStartCount;
+  TickType_t xStartTick;
+} QueueMetricsWaiter_t;
+
+static QueueMetrics_t xMetrics[QUEUE_METRICS_MAX];
+static UBaseType_t uxMetricsCount;
+static QueueMetricsWaiter_t xWaiters[QUEUE_METRICS_MAX_WAITERS];
+static UBaseType_t uxWaitersInUse;
+static uint32_t ulWaitersLost;
+static PeriodicTask_t xSamplerTiming;
+
+/* Critical section. */
+static void prvBlockStart(UBaseType_t uxIndex, BaseType_t xSend)
+{
+  TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+  QueueMetricsWaiter_t *pxFree = NULL;
+  UBaseType_t i;
+
+  for (i = 0U; i < QUEUE_METRICS_MAX_WAITERS; i++)
+  {
+    if (xWaiters[i].xTask == xTask)
+    {
+      return;                          /* blocks again in the same call */
+    }
+    if (xWaiters[i].xTask == NULL && pxFree == NULL)
+    {
+      pxFree = &xWaiters[i];
+    }
+  }
+
+  if (pxFree == NULL)
+  {
+    ulWaitersLost++;
+    return;
+  }
+
+  pxFree->xTask = xTask;
+  pxFree->uxIndex = uxIndex;
+  pxFree->xSend = xSend;
+  pxFree->ulStartCount = ulPerfCounterGet();
+  pxFree->xStartTick = xTaskGetTickCount();
+  uxWaitersInUse++;
+}
+
+static uint32_t prvWaitBucket(uint32_t ulUs)
+{
+  uint32_t ulBucket = 0U;
+
+  while (ulUs >= 2U && ulBucket < QUEUE_METRICS_WAIT_BUCKETS - 1U)
+  {
+    ulUs >>= 1;
+    ulBucket++;
+  }
+  return ulBucket;
+}
+
+/* Critical section. Ends the wait of the calling task, if it had one. */
+static void prvBlockEnd(UBaseType_t uxIndex, BaseType_t xSend)
+{
+  TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+  QueueMetricsWait_t *pxWait;
+  TickType_t xTicks;
+  uint32_t ulUs;
+  UBaseType_t i;
+
+  for (i = 0U; i < QUEUE_METRICS_MAX_WAITERS; i++)
+  {
+    if (xWaiters[i].xTask == xTask)
+    {
+      break;
+    }
+  }
+  if (i == QUEUE_METRICS_MAX_WAITERS)
+  {
+    return;
+  }
+
+  xTicks = xTaskGetTickCount() - xWaiters[i].xStartTick;
+  if (xTicks < configTICK_RATE_HZ)
+  {
+    ulUs = ulPerfCounterToNs(ulPerfCounterGet() - xWaiters[i].ulStartCount) / 1000U;
+  }
+  else
+  {
+    /* The perf counter may have wrapped. */
+    ulUs = (uint32_t)(((uint64_t)xTicks * 1000000U) / configTICK_RATE_HZ);
+  }
+
+  /* A task that gave up on one object never ends the wait on another. */
+  if (xWaiters[i].uxIndex == uxIndex && xWaiters[i].xSend == xSend)
+  {
+    pxWait = xSend ? &xMetrics[uxIndex].xSendWait : &xMetrics[uxIndex].xReceiveWait;
+    pxWait->ulCount++;
+    pxWait->ullTotalUs += ulUs;
+    if (ulUs > pxWait->ulMaxUs)
+    {
+      pxWait->ulMaxUs = ulUs;
+    }
+    pxWait->ulBucket[prvWaitBucket(ulUs)]++;
+  }
+
+  xWaiters[i].xTask = NULL;
+  uxWaitersInUse--;
+}
+
+void vQueueMetricsEvent(unsigned long ulNumber, unsigned long ulEvent, unsigned long ulLevel)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  UBaseType_t uxIndex = (UBaseType_t)(ulNumber - 1U);
+  QueueMetrics_t *pxMetrics;
+
+  if (uxIndex >= uxMetricsCount)
+  {
+    return;
+  }
+  pxMetrics = &xMetrics[uxIndex];
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  /* An overwrite of a full queue of length 1 reports one more than fits. */
+  pxMetrics->ulLevel = (ulLevel < pxMetrics->ulCapacity) ? (uint32_t)ulLevel : pxMetrics->ulCapacity;
+  if (pxMetrics->ulLevel > pxMetrics->ulPeak)
+  {
+    pxMetrics->ulPeak = pxMetrics->ulLevel;
+  }
+
+  switch (ulEvent)
+  {
+    case QUEUE_METRICS_SEND:
+    case QUEUE_METRICS_SEND_FAILED:
+      if (ulEvent == QUEUE_METRICS_SEND)
+      {
+        pxMetrics->ulSends++;
+      }
+      else
+      {
+        pxMetrics->ulSendFailed++;
+      }
+      if (uxWaitersInUse != 0U)
+      {
+        prvBlockEnd(uxIndex, pdTRUE);
+      }
+      break;
+
+    case QUEUE_METRICS_RECEIVE:
+    case QUEUE_METRICS_RECEIVE_FAILED:
+      if (ulEvent == QUEUE_METRICS_RECEIVE)
+      {
+        pxMetrics->ulReceives++;
+      }
+      else
+      {
+        pxMetrics->ulReceiveFailed++;
+      }
+      if (uxWaitersInUse != 0U)
+      {
+        prvBlockEnd(uxIndex, pdFALSE);
+      }
+      break;
+
+    /* Interrupts never wait, and the task they interrupted may be in the
+    middle of its own call. */
+    case QUEUE_METRICS_SEND_FROM_ISR:
+      pxMetrics->ulSends++;
+      break;
+    case QUEUE_METRICS_SEND_FROM_ISR_FAILED:
+      pxMetrics->ulSendFailed++;
+      break;
+    case QUEUE_METRICS_RECEIVE_FROM_ISR:
+      pxMetrics->ulReceives++;
+      break;
+    case QUEUE_METRICS_RECEIVE_FROM_ISR_FAILED:
+      pxMetrics->ulReceiveFailed++;
+      break;
+
+    case QUEUE_METRICS_BLOCK_SEND:
+      prvBlockStart(uxIndex, pdTRUE);
+      break;
+    case QUEUE_METRICS_BLOCK_RECEIVE:
+      prvBlockStart(uxIndex, pdFALSE);
+      break;
+
+    default:
+      break;
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/* Number of the new entry, 0 when the table is full. */
+static UBaseType_t prvAdd(const char *pcName, uint32_t ulCapacity, uint32_t ulLevel)
+{
+  UBaseType_t uxNumber = 0U;
+
+  taskENTER_CRITICAL();
+  if (uxMetricsCount < QUEUE_METRICS_MAX)
+  {
+    QueueMetrics_t *pxMetrics = &xMetrics[uxMetricsCount];
+
+    memset(pxMetrics, 0, sizeof(QueueMetrics_t));
+    pxMetrics->pcName = pcName;
+    pxMetrics->ulCapacity = ulCapacity;
+    pxMetrics->ulLevel = ulLevel;
+    pxMetrics->ulPeak = ulLevel;
+    uxNumber = ++uxMetricsCount;
+  }
+  taskEXIT_CRITICAL();
+
+  return uxNumber;
+}
+
+BaseType_t xQueueMetricsAddQueue(QueueHandle_t xQueue, const char *pcName)
+{
+  UBaseType_t uxWaiting = uxQueueMessagesWaiting(xQueue);
+  UBaseType_t uxNumber = prvAdd(pcName, (uint32_t)(uxWaiting + uxQueueSpacesAvailable(xQueue)), (uint32_t)uxWaiting);
+
+  if (uxNumber == 0U)
+  {
+    return pdFAIL;
+  }
+
+#if (configQUEUE_REGISTRY_SIZE > 0)
+  vQueueAddToRegistry(xQueue, pcName);
+#endif
+  vQueueSetQueueNumber(xQueue, uxNumber);
+  return pdPASS;
+}
+
+BaseType_t xQueueMetricsAddStreamBuffer(StreamBufferHandle_t xStreamBuffer, const char *pcName)
+{
+  size_t xAvailable = xStreamBufferBytesAvailable(xStreamBuffer);
+  UBaseType_t uxNumber = prvAdd(pcName, (uint32_t)(xAvailable + xStreamBufferSpacesAvailable(xStreamBuffer)),
+                                (uint32_t)xAvailable);
+
+  if (uxNumber == 0U)
+  {
+    return pdFAIL;
+  }
+
+  vStreamBufferSetStreamBufferNumber(xStreamBuffer, uxNumber);
+  return pdPASS;
+}
+
+BaseType_t xQueueMetricsAddPrioQueue(PrioQueueHandle_t xQueue, const char *pcName)
+{
+  UBaseType_t uxWaiting = uxPrioQueueMessagesWaiting(xQueue);
+  UBaseType_t uxNumber = prvAdd(pcName, (uint32_t)(uxWaiting + uxPrioQueueSpacesAvailable(xQueue)),
+                                (uint32_t)uxWaiting);
+
+  if (uxNumber == 0U)
+  {
+    return pdFAIL;
+  }
+
+  vPrioQueueSetQueueNumber(xQueue, uxNumber);
+  return pdPASS;
+}
+
+void vQueueMetricsSample(void)
+{
+  UBaseType_t i;
+
+  for (i = 0U; i < uxMetricsCount; i++)
+  {
+    QueueMetrics_t *pxMetrics = &xMetrics[i];
+    uint32_t ulLevel = pxMetrics->ulLevel;   /* one aligned word, no lock */
+    uint32_t ulBucket;
+
+    if (ulLevel == 0U)
+    {
+      ulBucket = 0U;
+    }
+    else if (ulLevel >= pxMetrics->ulCapacity)
+    {
+      ulBucket = QUEUE_METRICS_FILL_BUCKETS - 1U;
+    }
+    else
+    {
+      /* 1 ... 4: up to 1/4, 1/2, 3/4 and below full */
+      ulBucket = (uint32_t)(((uint64_t)ulLevel * 4U + pxMetrics->ulCapacity - 1U) / pxMetrics->ulCapacity);
+    }
+
+    pxMetrics->ulFill[ulBucket]++;
+    pxMetrics->usSample[pxMetrics->ulSamples % QUEUE_METRICS_SAMPLES] =
+        (uint16_t)((ulLevel > 0xFFFFU) ? 0xFFFFU : ulLevel);
+    pxMetrics->ulSamples++;
+  }
+}
+
+static void prvSamplerTask(void *pvArgument)
+{
+  (void)pvArgument;
+
+  for (;;)
+  {
+    vPeriodicWait(&xSamplerTiming);
+    vQueueMetricsSample();
+  }
+}
+
+BaseType_t xQueueMetricsStartSampler(TickType_t xPeriod, UBaseType_t uxPriority)
+{
+  vPeriodicInit(&xSamplerTiming, "QMetrics", xPeriod, 0U);
+  return xTaskCreate(prvSamplerTask, "QMetrics", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL);
+}
+
+void vQueueMetricsReset(void)
+{
+  UBaseType_t i;
+
+  taskENTER_CRITICAL();
+  for (i = 0U; i < uxMetricsCount; i++)
+  {
+    QueueMetrics_t *pxMetrics = &xMetrics[i];
+
+    pxMetrics->ulPeak = pxMetrics->ulLevel;
+    pxMetrics->ulSends = 0U;
+    pxMetrics->ulSendFailed = 0U;
+    pxMetrics->ulReceives = 0U;
+    pxMetrics->ulReceiveFailed = 0U;
+    memset(&pxMetrics->xSendWait, 0, sizeof(QueueMetricsWait_t));
+    memset(&pxMetrics->xReceiveWait, 0, sizeof(QueueMetricsWait_t));
+    memset(pxMetrics->ulFill, 0, sizeof(pxMetrics->ulFill));
+    pxMetrics->ulSamples = 0U;
+  }
+  ulWaitersLost = 0U;
+  taskEXIT_CRITICAL();
+}
+
+static void prvDumpWait(void (*pxWrite)(const char *pcLine), const char *pcSide, const QueueMetricsWait_t *pxWait)
+{
+  char cLine[96];
+  int xLen;
+  uint32_t i;
+
+  if (pxWait->ulCount == 0U)
+  {
+    return;
+  }
+
+  snprintf(cLine, sizeof(cLine), "  %s blocked %lu times, mean %lu us, max %lu us\n", pcSide,
+           (unsigned long)pxWait->ulCount, (unsigned long)(pxWait->ullTotalUs / pxWait->ulCount),
+           (unsigned long)pxWait->ulMaxUs);
+  pxWrite(cLine);
+
+  /* "<2:3" is 3 waits below 2 us, "<4:1" one of 2 or 3 us ... */
+  xLen = snprintf(cLine, sizeof(cLine), "   ");
+  for (i = 0U; i < QUEUE_METRICS_WAIT_BUCKETS; i++)
+  {
+    if (pxWait->ulBucket[i] == 0U)
+    {
+      continue;
+    }
+    if (xLen > (int)sizeof(cLine) - 24)
+    {
+      pxWrite(strcat(cLine, "\n"));
+      xLen = snprintf(cLine, sizeof(cLine), "   ");
+    }
+    if (i == QUEUE_METRICS_WAIT_BUCKETS - 1U)
+    {
+      xLen += snprintf(&cLine[xLen], sizeof(cLine) - (size_t)xLen, " >=%lu:%lu", 1UL << i,
+                       (unsigned long)pxWait->ulBucket[i]);
+    }
+    else
+    {
+      xLen += snprintf(&cLine[xLen], sizeof(cLine) - (size_t)xLen, " <%lu:%lu", 2UL << i,
+                       (unsigned long)pxWait->ulBucket[i]);
+    }
+  }
+  pxWrite(strcat(cLine, "\n"));
+}
+
+void vQueueMetricsDump(void (*pxWrite)(const char *pcLine))
+{
+  static QueueMetrics_t xCopy;
+  char cLine[96];
+  UBaseType_t i;
+  uint32_t j;
+
+  for (i = 0U; i < uxMetricsCount; i++)
+  {
+    uint32_t ulFirst;
+    int xLen;
+
+    /* A consistent copy, the hooks keep running. */
+    taskENTER_CRITICAL();
+    xCopy = xMetrics[i];
+    taskEXIT_CRITICAL();
+
+    snprintf(cLine, sizeof(cLine), "%s: level %lu/%lu, peak %lu\n", xCopy.pcName, (unsigned long)xCopy.ulLevel,
+             (unsigned long)xCopy.ulCapacity, (unsigned long)xCopy.ulPeak);
+    pxWrite(cLine);
+
+    snprintf(cLine, sizeof(cLine), "  sends %lu, failed full %lu; receives %lu, failed empty %lu\n",
+             (unsigned long)xCopy.ulSends, (unsigned long)xCopy.ulSendFailed, (unsigned long)xCopy.ulReceives,
+             (unsigned long)xCopy.ulReceiveFailed);
+    pxWrite(cLine);
+
+    prvDumpWait(pxWrite, "send", &xCopy.xSendWait);
+    prvDumpWait(pxWrite, "receive", &xCopy.xReceiveWait);
+
+    if (xCopy.ulSamples == 0U)
+    {
+      continue;
+    }
+
+    snprintf(cLine, sizeof(cLine), "  %lu samples: empty %lu, 1/4 %lu, 1/2 %lu, 3/4 %lu, <full %lu, full %lu\n",
+             (unsigned long)xCopy.ulSamples, (unsigned long)xCopy.ulFill[0], (unsigned long)xCopy.ulFill[1],
+             (unsigned long)xCopy.ulFill[2], (unsigned long)xCopy.ulFill[3], (unsigned long)xCopy.ulFill[4],
+             (unsigned long)xCopy.ulFill[5]);
+    pxWrite(cLine);
+
+    /* The last samples, oldest first. */
+    ulFirst = (xCopy.ulSamples > QUEUE_METRICS_SAMPLES) ? xCopy.ulSamples - QUEUE_METRICS_SAMPLES : 0U;
+    xLen = snprintf(cLine, sizeof(cLine), "  last:");
+    for (j = ulFirst; j != xCopy.ulSamples; j++)
+    {
+      if (xLen > (int)sizeof(cLine) - 8)
+      {
+        pxWrite(strcat(cLine, "\n"));
+        xLen = snprintf(cLine, sizeof(cLine), "       ");
+      }
+      xLen += snprintf(&cLine[xLen], sizeof(cLine) - (size_t)xLen, " %u",
+                       (unsigned)xCopy.usSample[j % QUEUE_METRICS_SAMPLES]);
+    }
+    pxWrite(strcat(cLine, "\n"));
+  }
+
+  if (ulWaitersLost != 0U)
+  {
+    snprintf(cLine, sizeof(cLine), "queue metrics: %lu waits not timed, raise QUEUE_METRICS_MAX_WAITERS\n",
+             (unsigned long)ulWaitersLost);
+    pxWrite(cLine);
+  }
+}
+
+#endif /* QUEUE_METRICS_TRACE_H */
@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @file           : resource_pool.c
+  * @brief          : Counting semaphore that hands out the resources themselves
+  ******************************************************************************
+  * @attention
+  *
+  * The free list is a stack of handles, the count is its depth. Everything
+  * happens in short critical sections, the only kernel calls are the
+  * notifications of the tasks that are served. A waiter's record lives on
+  * its own stack and is filled by the giver before the task is woken.
+  *
+  ******************************************************************************
+  */
+
+#include "resource_pool.h"
+#include "task.h"
+
+typedef struct ResourcePoolWaiter
+{
+  TaskHandle_t xTask;
+  void **ppvResources;
+  UBaseType_t uxCount;
+  volatile BaseType_t xGranted;
+  struct ResourcePoolWaiter *pxNext;
+} ResourcePoolWaiter_t;
+
+struct ResourcePool
+{
+  void **ppvFree;
+  UBaseType_t uxFree;
+  UBaseType_t uxSize;
+  ResourcePoolWaiter_t *pxHead;
+  ResourcePoolWaiter_t *pxTail;
+};
+
+ResourcePoolHandle_t xResourcePoolCreate(void * const *ppvResources, UBaseType_t uxCount)
+{
+  struct ResourcePool *pxPool;
+  UBaseType_t i;
+
+  configASSERT(uxCount > 0U);
+
+  pxPool = pvPortMalloc(sizeof(struct ResourcePool) + uxCount * sizeof(void *));
+  if (pxPool == NULL)
+  {
+    return NULL;
+  }
+
+  pxPool->ppvFree = (void **)(pxPool + 1);
+  for (i = 0U; i < uxCount; i++)
+  {
+    pxPool->ppvFree[i] = ppvResources[i];
+  }
+  pxPool->uxFree = uxCount;
+  pxPool->uxSize = uxCount;
+  pxPool->pxHead = NULL;
+  pxPool->pxTail = NULL;
+
+  return pxPool;
+}
+
+void vResourcePoolDelete(ResourcePoolHandle_t xPool)
+{
+  configASSERT(xPool->pxHead == NULL);
+
+  vPortFree(xPool);
+}
+
+/* Critical section. */
+static void prvPop(struct ResourcePool *pxPool, void **ppvResources, UBaseType_t uxCount)
+{
+  UBaseType_t i;
+
+  for (i = 0U; i < uxCount; i++)
+  {
+    ppvResources[i] = pxPool->ppvFree[--pxPool->uxFree];
+  }
+}
+
+/* Critical section. */
+static void prvPush(struct ResourcePool *pxPool, void * const *ppvResources, UBaseType_t uxCount)
+{
+  UBaseType_t i;
+
+  configASSERT(pxPool->uxFree + uxCount <= pxPool->uxSize);
+
+  for (i = 0U; i < uxCount; i++)
+  {
+    pxPool->ppvFree[pxPool->uxFree++] = ppvResources[i];
+  }
+}
+
+/* Critical section. Hands units to waiters in arrival order while the
+first one can be served. pxHigherPriorityTaskWoken is NULL in a task. */
+static void prvServe(struct ResourcePool *pxPool, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  while (pxPool->pxHead != NULL && pxPool->pxHead->uxCount <= pxPool->uxFree)
+  {
+    ResourcePoolWaiter_t *pxWaiter = pxPool->pxHead;
+
+    pxPool->pxHead = pxWaiter->pxNext;
+    if (pxPool->pxHead == NULL)
+    {
+      pxPool->pxTail = NULL;
+    }
+
+    prvPop(pxPool, pxWaiter->ppvResources, pxWaiter->uxCount);
+    pxWaiter->xGranted = pdTRUE;
+
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+      vTaskNotifyGiveFromISR(pxWaiter->xTask, pxHigherPriorityTaskWoken);
+    }
+    else
+    {
+      (void)xTaskNotifyGive(pxWaiter->xTask);
+    }
+  }
+}
+
+/* Critical section. */
+static void prvRemove(struct ResourcePool *pxPool, ResourcePoolWaiter_t *pxWaiter)
+{
+  ResourcePoolWaiter_t *pxPrevious = NULL;
+  ResourcePoolWaiter_t *pxIterator = pxPool->pxHead;
+
+  while (pxIterator != NULL && pxIterator != pxWaiter)
+  {
+    pxPrevious = pxIterator;
+    pxIterator = pxIterator->pxNext;
+  }
+  configASSERT(pxIterator != NULL);
+
+  if (pxPrevious == NULL)
+  {
+    pxPool->pxHead = pxWaiter->pxNext;
+  }
+  else
+  {
+    pxPrevious->pxNext = pxWaiter->pxNext;
+  }
+  if (pxPool->pxTail == pxWaiter)
+  {
+    pxPool->pxTail = pxPrevious;
+  }
+}
+
+BaseType_t xResourcePoolTakeBatch(ResourcePoolHandle_t xPool, void **ppvResources, UBaseType_t uxCount,
+                                  TickType_t xTicksToWait)
+{
+  ResourcePoolWaiter_t xWaiter;
+  TimeOut_t xTimeOut;
+
+  configASSERT(uxCount > 0U && uxCount <= xPool->uxSize);
+
+  taskENTER_CRITICAL();
+  {
+    /* Nobody waiting: first come, first served. */
+    if (xPool->pxHead == NULL && xPool->uxFree >= uxCount)
+    {
+      prvPop(xPool, ppvResources, uxCount);
+      taskEXIT_CRITICAL();
+      return pdPASS;
+    }
+
+    if (xTicksToWait == 0U)
+    {
+      taskEXIT_CRITICAL();
+      return pdFAIL;
+    }
+
+    xWaiter.xTask = xTaskGetCurrentTaskHandle();
+    xWaiter.ppvResources = ppvResources;
+    xWaiter.uxCount = uxCount;
+    xWaiter.xGranted = pdFALSE;
+    xWaiter.pxNext = NULL;
+    if (xPool->pxTail == NULL)
+    {
+      xPool->pxHead = &xWaiter;
+    }
+    else
+    {
+      xPool->pxTail->pxNext = &xWaiter;
+    }
+    xPool->pxTail = &xWaiter;
+  }
+  taskEXIT_CRITICAL();
+
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    (void)ulTaskNotifyTake(pdTRUE, xTicksToWait);
+
+    if (xWaiter.xGranted != pdFALSE)
+    {
+      return pdPASS;
+    }
+
+    if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+    {
+      BaseType_t xGranted;
+
+      taskENTER_CRITICAL();
+      {
+        xGranted = xWaiter.xGranted;
+        if (xGranted == pdFALSE)
+        {
+          prvRemove(xPool, &xWaiter);
+          /* The waiters behind this one may fit now. */
+          prvServe(xPool, NULL);
+        }
+      }
+      taskEXIT_CRITICAL();
+
+      if (xGranted != pdFALSE)
+      {
+        /* Served between the timeout and the critical section: drop the
+        notification that came with it. */
+        (void)ulTaskNotifyTake(pdTRUE, 0);
+        return pdPASS;
+      }
+      return pdFAIL;
+    }
+  }
+}
+
+BaseType_t xResourcePoolTakeBatchFromISR(ResourcePoolHandle_t xPool, void **ppvResources, UBaseType_t uxCount)
+{
+  BaseType_t xReturn = pdFAIL;
+  UBaseType_t uxSavedInterruptStatus;
+
+  configASSERT(uxCount > 0U && uxCount <= xPool->uxSize);
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  if (xPool->pxHead == NULL && xPool->uxFree >= uxCount)
+  {
+    prvPop(xPool, ppvResources, uxCount);
+    xReturn = pdPASS;
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  return xReturn;
+}
+
+void vResourcePoolGiveBatch(ResourcePoolHandle_t xPool, void * const *ppvResources, UBaseType_t uxCount)
+{
+  taskENTER_CRITICAL();
+  prvPush(xPool, ppvResources, uxCount);
+  prvServe(xPool, NULL);
+  taskEXIT_CRITICAL();
+}
+
+void vResourcePoolGiveBatchFromISR(ResourcePoolHandle_t xPool, void * const *ppvResources, UBaseType_t uxCount,
+                                   BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xWoken = pdFALSE;
+  UBaseType_t uxSavedInterruptStatus;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  prvPush(xPool, ppvResources, uxCount);
+  prvServe(xPool, &xWoken);
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if (pxHigherPriorityTaskWoken != NULL && xWoken != pdFALSE)
+  {
+    *pxHigherPriorityTaskWoken = pdTRUE;
+  }
+}
+
+void *pvResourcePoolTake(ResourcePoolHandle_t xPool, TickType_t xTicksToWait)
+{
+  void *pvResource;
+
+  return (xResourcePoolTakeBatch(xPool, &pvResource, 1U, xTicksToWait) == pdPASS) ? pvResource : NULL;
+}
+
+void *pvResourcePoolTakeFromISR(ResourcePoolHandle_t xPool)
+{
+  void *pvResource;
+
+  return (xResourcePoolTakeBatchFromISR(xPool, &pvResource, 1U) == pdPASS) ? pvResource : NULL;
+}
+
+void vResourcePoolGive(ResourcePoolHandle_t xPool, void *pvResource)
+{
+  vResourcePoolGiveBatch(xPool, &pvResource, 1U);
+}
+
+void vResourcePoolGiveFromISR(ResourcePoolHandle_t xPool, void *pvResource, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  vResourcePoolGiveBatchFromISR(xPool, &pvResource, 1U, pxHigherPriorityTaskWoken);
+}
+
+UBaseType_t uxResourcePoolGetFree(ResourcePoolHandle_t xPool)
+{
+  return xPool->uxFree;
+}
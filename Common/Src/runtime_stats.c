@@ -0,0 +1,144 @@
+/**
+  ******************************************************************************
+  * @file           : runtime_stats.c
+  * @brief          : Per task CPU usage and context switch counts
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+
+#include "runtime_stats.h"
+#include "perf_counter.h"
+#include "task.h"
+
+/* Written by the hooks, with the kernel's context switch and tick
+interrupts masked against each other. */
+static uint64_t ullRunCounts[RUNTIME_STATS_MAX_TASKS];
+static uint32_t ulSwitches[RUNTIME_STATS_MAX_TASKS];
+static UBaseType_t uxRunning = RUNTIME_STATS_MAX_TASKS;  /* none yet */
+static uint32_t ulChargedUpTo;
+
+static void prvCharge(uint32_t ulNow)
+{
+  if (uxRunning < RUNTIME_STATS_MAX_TASKS)
+  {
+    ullRunCounts[uxRunning] += (uint32_t)(ulNow - ulChargedUpTo);
+  }
+  ulChargedUpTo = ulNow;
+}
+
+void vRuntimeStatsSwitchedIn(unsigned long ulTaskNumber)
+{
+  UBaseType_t uxSlot = (UBaseType_t)(ulTaskNumber % RUNTIME_STATS_MAX_TASKS);
+
+  prvCharge(ulPerfCounterGet());
+
+  /* The kernel also passes here when it selects the task that was already
+  running, that is no switch. */
+  if (uxSlot != uxRunning)
+  {
+    ulSwitches[uxSlot]++;
+    uxRunning = uxSlot;
+  }
+}
+
+void vRuntimeStatsTick(void)
+{
+  prvCharge(ulPerfCounterGet());
+}
+
+/* uxTaskGetSystemState() only exists with configUSE_TRACE_FACILITY 1, the
+examples without it never take a snapshot. */
+#if (configUSE_TRACE_FACILITY == 1)
+
+/* Snapshot state, owned by the one task taking snapshots. */
+static TaskStatus_t xStatus[RUNTIME_STATS_MAX_TASKS];
+static uint64_t ullNowCounts[RUNTIME_STATS_MAX_TASKS];
+static uint64_t ullPrevCounts[RUNTIME_STATS_MAX_TASKS];
+static uint32_t ulNowSwitches[RUNTIME_STATS_MAX_TASKS];
+static uint32_t ulPrevSwitches[RUNTIME_STATS_MAX_TASKS];
+static TickType_t xPrevTick;
+
+UBaseType_t uxRuntimeStatsSnapshot(RuntimeStatsTask_t *pxTasks, UBaseType_t uxMaxTasks, TickType_t *pxInterval)
+{
+  UBaseType_t uxCount;
+  UBaseType_t i;
+  uint64_t ullTotal = 0U;
+  TickType_t xNow;
+
+  uxCount = uxTaskGetSystemState(xStatus, RUNTIME_STATS_MAX_TASKS, NULL);
+  if (uxCount == 0U || uxCount > uxMaxTasks)
+  {
+    return 0U;
+  }
+
+  taskENTER_CRITICAL();
+  prvCharge(ulPerfCounterGet());
+  for (i = 0U; i < RUNTIME_STATS_MAX_TASKS; i++)
+  {
+    ullNowCounts[i] = ullRunCounts[i];
+    ulNowSwitches[i] = ulSwitches[i];
+  }
+  xNow = xTaskGetTickCount();
+  taskEXIT_CRITICAL();
+
+  /* Over all slots, so time of a task deleted in the meantime still counts. */
+  for (i = 0U; i < RUNTIME_STATS_MAX_TASKS; i++)
+  {
+    ullTotal += ullNowCounts[i] - ullPrevCounts[i];
+  }
+
+  for (i = 0U; i < uxCount; i++)
+  {
+    UBaseType_t uxSlot = (UBaseType_t)(xStatus[i].xTaskNumber % RUNTIME_STATS_MAX_TASKS);
+    uint64_t ullRun = ullNowCounts[uxSlot] - ullPrevCounts[uxSlot];
+
+    pxTasks[i].pcName = xStatus[i].pcTaskName;
+    pxTasks[i].ulCpuPermille = (ullTotal != 0U) ? (uint32_t)((ullRun * 1000U) / ullTotal) : 0U;
+    pxTasks[i].ulSwitches = ulNowSwitches[uxSlot] - ulPrevSwitches[uxSlot];
+    pxTasks[i].ulStackFree = (uint32_t)xStatus[i].usStackHighWaterMark;
+  }
+
+  for (i = 0U; i < RUNTIME_STATS_MAX_TASKS; i++)
+  {
+    ullPrevCounts[i] = ullNowCounts[i];
+    ulPrevSwitches[i] = ulNowSwitches[i];
+  }
+
+  if (pxInterval != NULL)
+  {
+    *pxInterval = xNow - xPrevTick;
+  }
+  xPrevTick = xNow;
+
+  return uxCount;
+}
+
+void vRuntimeStatsPrint(void (*pxWrite)(const char *pcLine))
+{
+  static RuntimeStatsTask_t xTasks[RUNTIME_STATS_MAX_TASKS];
+  char cLine[96];
+  TickType_t xInterval;
+  UBaseType_t uxCount;
+  UBaseType_t i;
+
+  uxCount = uxRuntimeStatsSnapshot(xTasks, RUNTIME_STATS_MAX_TASKS, &xInterval);
+  if (uxCount == 0U)
+  {
+    pxWrite("CPU: more tasks than RUNTIME_STATS_MAX_TASKS\n");
+    return;
+  }
+
+  snprintf(cLine, sizeof(cLine), "CPU over the last %lu ms:\n", (unsigned long)(xInterval * portTICK_PERIOD_MS));
+  pxWrite(cLine);
+
+  for (i = 0U; i < uxCount; i++)
+  {
+    snprintf(cLine, sizeof(cLine), "%-12s %3lu.%lu%%  switches %lu  stack free %lu\n", xTasks[i].pcName,
+             (unsigned long)(xTasks[i].ulCpuPermille / 10U), (unsigned long)(xTasks[i].ulCpuPermille % 10U),
+             (unsigned long)xTasks[i].ulSwitches, (unsigned long)xTasks[i].ulStackFree);
+    pxWrite(cLine);
+  }
+}
+
+#endif /* configUSE_TRACE_FACILITY */
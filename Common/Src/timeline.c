@@ -0,0 +1,217 @@
+/**
+  ******************************************************************************
+  * @file           : timeline.c
+  * @brief          : Kernel event recorder for a scheduling timeline
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timeline.h"
+#include "perf_counter.h"
+
+#ifdef HOST_BUILD
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+#if (TIMELINE_RECORDS & (TIMELINE_RECORDS - 1U)) != 0U
+#error "TIMELINE_RECORDS must be a power of two"
+#endif
+
+/* A record more than this many counts after the previous one could be
+taken for a wrap of the 32 bit time, the tick hook writes a sync record
+before that happens. */
+#define TIMELINE_SYNC_COUNTS   0x40000000UL
+
+static TimelineRecord_t xRing[TIMELINE_RECORDS];
+static uint32_t ulWritten;
+static uint32_t ulLastTime;
+static uint8_t ucCurrentTask;
+static uint8_t ucPaused;
+
+static TimelineName_t xNames[TIMELINE_MAX_NAMES];
+static uint32_t ulNameCount;
+
+static void prvRecord(uint32_t ulEvent, uint32_t ulObject, uint32_t ulValue)
+{
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  if (ucPaused == 0U)
+  {
+    TimelineRecord_t *pxRecord = &xRing[ulWritten & (TIMELINE_RECORDS - 1U)];
+
+    ulLastTime = ulPerfCounterGet();
+    pxRecord->ulTime = ulLastTime;
+    pxRecord->ulObject = ulObject;
+    pxRecord->ucEvent = (uint8_t)ulEvent;
+    pxRecord->ucTask = ucCurrentTask;
+    pxRecord->usValue = (uint16_t)ulValue;
+    ulWritten++;
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+static void prvSetName(uint32_t ulId, uint8_t ucIsTask, const char *pcName)
+{
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  uint32_t i;
+
+  /* A task number is never reused, a handle is when an object is deleted
+  and another one created at the same address. */
+  for (i = 0U; i < ulNameCount; i++)
+  {
+    if (xNames[i].ulId == ulId && xNames[i].ucIsTask == ucIsTask)
+    {
+      break;
+    }
+  }
+
+  if (i < TIMELINE_MAX_NAMES)
+  {
+    xNames[i].ulId = ulId;
+    xNames[i].ucIsTask = ucIsTask;
+    strncpy(xNames[i].cName, pcName, TIMELINE_NAME_LEN - 1U);
+    xNames[i].cName[TIMELINE_NAME_LEN - 1U] = '\0';
+    if (i == ulNameCount)
+    {
+      ulNameCount++;
+    }
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void vTimelineEvent(uint32_t ulEvent, const void *pvObject, uint32_t ulValue)
+{
+  prvRecord(ulEvent, (uint32_t)(uintptr_t)pvObject, ulValue);
+}
+
+void vTimelineSwitchedOut(void)
+{
+  prvRecord(TIMELINE_TASK_OUT, ucCurrentTask, 0U);
+}
+
+void vTimelineSwitchedIn(uint32_t ulTask)
+{
+  ucCurrentTask = (uint8_t)ulTask;
+  prvRecord(TIMELINE_TASK_IN, ulTask, 0U);
+}
+
+void vTimelineTaskCreated(uint32_t ulTask, const char *pcName)
+{
+  prvSetName(ulTask, 1U, pcName);
+}
+
+void vTimelineTick(void)
+{
+  if ((uint32_t)(ulPerfCounterGet() - ulLastTime) > TIMELINE_SYNC_COUNTS)
+  {
+    prvRecord(TIMELINE_SYNC, 0U, 0U);
+  }
+}
+
+void vTimelineSetName(const void *pvObject, const char *pcName)
+{
+  prvSetName((uint32_t)(uintptr_t)pvObject, 0U, pcName);
+}
+
+void vTimelineIsrEnter(uint32_t ulIrq)
+{
+  prvRecord(TIMELINE_ISR_ENTER, 0U, ulIrq);
+}
+
+void vTimelineIsrExit(void)
+{
+  prvRecord(TIMELINE_ISR_EXIT, 0U, 0U);
+}
+
+uint32_t ulTimelineSave(void (*pxWrite)(const void *pvData, size_t xLength))
+{
+  TimelineHeader_t xHeader;
+  UBaseType_t uxSavedInterruptStatus;
+  uint32_t ulCount;
+  uint32_t ulFirst;
+  uint32_t ulTail;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  ucPaused = 1U;
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  ulCount = (ulWritten < TIMELINE_RECORDS) ? ulWritten : TIMELINE_RECORDS;
+  ulFirst = (ulWritten - ulCount) & (TIMELINE_RECORDS - 1U);
+
+  memcpy(xHeader.cMagic, "FRTL", 4U);
+  xHeader.usVersion = TIMELINE_VERSION;
+  xHeader.usRecordSize = (uint16_t)sizeof(TimelineRecord_t);
+  xHeader.ulCounterHz = ulPerfCounterHz();
+  xHeader.ulNames = ulNameCount;
+  xHeader.ulRecords = ulCount;
+  xHeader.ulOverwritten = ulWritten - ulCount;
+
+  pxWrite(&xHeader, sizeof(xHeader));
+  pxWrite(xNames, ulNameCount * sizeof(TimelineName_t));
+
+  /* Oldest first: from ulFirst to the end of the array, then the rest. */
+  ulTail = TIMELINE_RECORDS - ulFirst;
+  if (ulTail >= ulCount)
+  {
+    pxWrite(&xRing[ulFirst], ulCount * sizeof(TimelineRecord_t));
+  }
+  else
+  {
+    pxWrite(&xRing[ulFirst], ulTail * sizeof(TimelineRecord_t));
+    pxWrite(&xRing[0], (ulCount - ulTail) * sizeof(TimelineRecord_t));
+  }
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  ucPaused = 0U;
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  return ulCount;
+}
+
+#ifdef HOST_BUILD
+
+static const char *pcTracePath;
+static FILE *pxTraceFile;
+
+static void prvFileWrite(const void *pvData, size_t xLength)
+{
+  fwrite(pvData, 1U, xLength, pxTraceFile);
+}
+
+static void prvSaveAtExit(void)
+{
+  uint32_t ulCount;
+
+  pxTraceFile = fopen(pcTracePath, "wb");
+  if (pxTraceFile == NULL)
+  {
+    fprintf(stderr, "[host] cannot write %s\n", pcTracePath);
+    return;
+  }
+  ulCount = ulTimelineSave(prvFileWrite);
+  fclose(pxTraceFile);
+  fprintf(stderr, "[host] %lu trace records written to %s\n", (unsigned long)ulCount, pcTracePath);
+}
+
+void vTimelineInit(void)
+{
+  pcTracePath = getenv("HOST_TRACE");
+  if (pcTracePath != NULL && pcTracePath[0] != '\0')
+  {
+    atexit(prvSaveAtExit);
+  }
+}
+
+#else
+
+void vTimelineInit(void)
+{
+}
+
+#endif /* HOST_BUILD */
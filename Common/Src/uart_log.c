@@ -0,0 +1,256 @@
+/**
+  ******************************************************************************
+  * @file           : uart_log.c
+  * @brief          : Non-blocking log output on a UART
+  ******************************************************************************
+  * @attention
+  *
+  * Every record carries a sequence number that tells which lap of the ring
+  * it belongs to and whether it is free or holds data:
+  *
+  *   free for position p       ulSeq == prvFreeSeq(p)
+  *   written for position p    ulSeq == prvFreeSeq(p) + 1
+  *
+  * Writers claim positions by advancing ulWritePos, only the "Log" task
+  * advances ulReadPos. Neither side ever waits for the other.
+  *
+  ******************************************************************************
+  */
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "uart_log.h"
+#include "task.h"
+
+#if (UART_LOG_RECORDS & (UART_LOG_RECORDS - 1U)) != 0U
+#error "UART_LOG_RECORDS must be a power of two"
+#endif
+
+/* Records sent to the UART with one HAL_UART_Transmit() call */
+#define UART_LOG_TX_RECORDS      8U
+
+typedef struct
+{
+  atomic_uint ulSeq;
+  uint32_t ulLength;
+  char cData[UART_LOG_RECORD_SIZE];
+} LogRecord_t;
+
+static LogRecord_t xRing[UART_LOG_RECORDS];
+static atomic_uint ulWritePos;
+static uint32_t ulReadPos;          /* "Log" task only */
+
+static atomic_uint ulDropped;
+static atomic_int xLogTaskWaiting;
+
+static TaskHandle_t xLogTaskHandle = NULL;
+static UART_HandleTypeDef *pxLogUart = NULL;
+
+static inline uint32_t prvFreeSeq(uint32_t ulPos)
+{
+  return (ulPos / UART_LOG_RECORDS) * 2U;
+}
+
+static inline LogRecord_t *prvRecord(uint32_t ulPos)
+{
+  return &xRing[ulPos & (UART_LOG_RECORDS - 1U)];
+}
+
+/* Claims ulCount consecutive records, returns pdFALSE when the ring is full. */
+static BaseType_t prvClaim(uint32_t ulCount, uint32_t *pulPos)
+{
+  for (;;)
+  {
+    uint32_t ulPos = atomic_load_explicit(&ulWritePos, memory_order_relaxed);
+    uint32_t i;
+
+    for (i = 0; i < ulCount; i++)
+    {
+      if (atomic_load_explicit(&prvRecord(ulPos + i)->ulSeq, memory_order_acquire) != prvFreeSeq(ulPos + i))
+      {
+        break;
+      }
+    }
+
+    if (i < ulCount)
+    {
+      /* Either the "Log" task has not sent these records yet, or another
+      writer claimed them since ulPos was read. */
+      if (atomic_load_explicit(&ulWritePos, memory_order_relaxed) == ulPos)
+      {
+        return pdFALSE;
+      }
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(&ulWritePos, &ulPos, ulPos + ulCount,
+                                              memory_order_relaxed, memory_order_relaxed))
+    {
+      *pulPos = ulPos;
+      return pdTRUE;
+    }
+  }
+}
+
+/* Copies the text into the claimed records and publishes them. Returns
+pdTRUE when the "Log" task is blocked and has to be woken. */
+static BaseType_t prvFill(uint32_t ulPos, const char *pcData, size_t xLength)
+{
+  while (xLength > 0U)
+  {
+    LogRecord_t *pxRecord = prvRecord(ulPos);
+    uint32_t ulChunk = (xLength < UART_LOG_RECORD_SIZE) ? (uint32_t)xLength : UART_LOG_RECORD_SIZE;
+
+    memcpy(pxRecord->cData, pcData, ulChunk);
+    pxRecord->ulLength = ulChunk;
+    atomic_store_explicit(&pxRecord->ulSeq, prvFreeSeq(ulPos) + 1U, memory_order_release);
+
+    pcData += ulChunk;
+    xLength -= ulChunk;
+    ulPos++;
+  }
+
+  return (xLogTaskHandle != NULL) && (atomic_exchange(&xLogTaskWaiting, 0) != 0);
+}
+
+/* Claims and fills the records for one line. Returns pdFALSE when the line
+was dropped, *pxWake tells whether the "Log" task has to be notified. */
+static BaseType_t prvWrite(const char *pcData, size_t xLength, BaseType_t *pxWake)
+{
+  uint32_t ulCount = (uint32_t)((xLength + UART_LOG_RECORD_SIZE - 1U) / UART_LOG_RECORD_SIZE);
+  uint32_t ulPos;
+
+  *pxWake = pdFALSE;
+  if (xLength == 0U)
+  {
+    return pdFALSE;
+  }
+
+  if (ulCount > UART_LOG_RECORDS || prvClaim(ulCount, &ulPos) == pdFALSE)
+  {
+    atomic_fetch_add_explicit(&ulDropped, (unsigned int)xLength, memory_order_relaxed);
+    return pdFALSE;
+  }
+
+  *pxWake = prvFill(ulPos, pcData, xLength);
+  return pdTRUE;
+}
+
+size_t xUartLogWrite(const char *pcData, size_t xLength)
+{
+  BaseType_t xWake;
+
+  if (prvWrite(pcData, xLength, &xWake) == pdFALSE)
+  {
+    return 0U;
+  }
+  if (xWake != pdFALSE)
+  {
+    xTaskNotifyGive(xLogTaskHandle);
+  }
+  return xLength;
+}
+
+/* On a single core a claim from an ISR can only be disturbed by a nested
+interrupt that logs as well, so the retry loop in prvClaim() is bounded by
+the interrupt nesting depth. */
+size_t xUartLogWriteFromISR(const char *pcData, size_t xLength, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xWake;
+
+  if (prvWrite(pcData, xLength, &xWake) == pdFALSE)
+  {
+    return 0U;
+  }
+  if (xWake != pdFALSE)
+  {
+    vTaskNotifyGiveFromISR(xLogTaskHandle, pxHigherPriorityTaskWoken);
+  }
+  return xLength;
+}
+
+size_t xUartLogPrintf(const char *pcFormat, ...)
+{
+  char cLine[UART_LOG_LINE_MAX];
+  va_list xArgs;
+  int xLength;
+
+  va_start(xArgs, pcFormat);
+  xLength = vsnprintf(cLine, sizeof(cLine), pcFormat, xArgs);
+  va_end(xArgs);
+
+  if (xLength < 0)
+  {
+    return 0U;
+  }
+  if ((size_t)xLength >= sizeof(cLine))
+  {
+    xLength = (int)sizeof(cLine) - 1;
+  }
+  return xUartLogWrite(cLine, (size_t)xLength);
+}
+
+uint32_t ulUartLogGetDropped(void)
+{
+  return atomic_load_explicit(&ulDropped, memory_order_relaxed);
+}
+
+/* Moves written records into pucTx and frees them, returns the byte count. */
+static uint32_t prvCollect(uint8_t *pucTx)
+{
+  uint32_t ulBytes = 0U;
+  uint32_t ulRecords;
+
+  for (ulRecords = 0U; ulRecords < UART_LOG_TX_RECORDS; ulRecords++)
+  {
+    LogRecord_t *pxRecord = prvRecord(ulReadPos);
+
+    if (atomic_load_explicit(&pxRecord->ulSeq, memory_order_acquire) != prvFreeSeq(ulReadPos) + 1U)
+    {
+      break;
+    }
+    memcpy(&pucTx[ulBytes], pxRecord->cData, pxRecord->ulLength);
+    ulBytes += pxRecord->ulLength;
+    atomic_store_explicit(&pxRecord->ulSeq, prvFreeSeq(ulReadPos + UART_LOG_RECORDS), memory_order_release);
+    ulReadPos++;
+  }
+  return ulBytes;
+}
+
+static void prvLogTask(void *pvParameters)
+{
+  uint8_t ucTx[UART_LOG_TX_RECORDS * UART_LOG_RECORD_SIZE];
+
+  (void)pvParameters;
+
+  for (;;)
+  {
+    uint32_t ulBytes = prvCollect(ucTx);
+
+    if (ulBytes == 0U)
+    {
+      /* Announce the wait first, then look again: a writer that finished
+      in between either sees the flag or its records are found here. */
+      atomic_store(&xLogTaskWaiting, 1);
+      ulBytes = prvCollect(ucTx);
+      if (ulBytes == 0U)
+      {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        continue;
+      }
+      atomic_store(&xLogTaskWaiting, 0);
+    }
+
+    HAL_UART_Transmit(pxLogUart, ucTx, (uint16_t)ulBytes, HAL_MAX_DELAY);
+  }
+}
+
+BaseType_t xUartLogInit(UART_HandleTypeDef *huart)
+{
+  pxLogUart = huart;
+  return xTaskCreate(prvLogTask, "Log", UART_LOG_TASK_STACK, NULL,
+                     UART_LOG_TASK_PRIORITY, &xLogTaskHandle);
+}
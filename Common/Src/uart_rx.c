@@ -0,0 +1,308 @@
+/**
+  ******************************************************************************
+  * @file           : uart_rx.c
+  * @brief          : UART reception with circular DMA and idle line detection
+  ******************************************************************************
+  * @attention
+  *
+  * ulHead counts every byte the DMA has reported, ulTail every byte the
+  * reader has taken, both free running. The byte number n lives at
+  * ucRxBuffer[n % UART_RX_BUFFER_SIZE], so ulHead - ulTail is the fill level.
+  *
+  * The HAL reports the DMA position inside the buffer (1 .. size), the
+  * event handler turns the step from the previous position into bytes. The
+  * half and full buffer events make sure no step is ever a whole lap, and
+  * that the DMA is never more than half a buffer ahead of ulHead. Bytes are
+  * therefore only safe to read while the fill level is at most half the
+  * buffer (RX_SAFE_LEVEL), above that the DMA may already be overwriting
+  * them.
+  *
+  * After a line error the DMA starts again at index 0, ulHead skips ahead to
+  * the next lap so the mapping above still holds. The bytes announced before
+  * the error stay where they are: the reader drains them up to the old head
+  * (ulGapStart) and only then jumps over the padding to ulRestartPos. If a
+  * second error comes before the reader got past the first padding, what
+  * arrived in between is dropped and the two gaps become one.
+  *
+  ******************************************************************************
+  */
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "uart_rx.h"
+#include "task.h"
+
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1U)) != 0U || UART_RX_BUFFER_SIZE > 0x8000U
+#error "UART_RX_BUFFER_SIZE must be a power of two, at most 32 KB"
+#endif
+
+#define RX_SAFE_LEVEL            (UART_RX_BUFFER_SIZE / 2U)
+
+/* Written by the DMA only. Plain SRAM: the CCM RAM of the F429 is not
+reachable by the DMA. */
+static uint8_t ucRxBuffer[UART_RX_BUFFER_SIZE];
+
+static atomic_uint ulHead;          /* event handler only */
+static atomic_uint ulTail;          /* reader only, read by the error handler */
+static uint16_t usDmaPos;           /* event handler only, 0 .. size - 1 */
+
+static atomic_uint ulGapStart;      /* ulHead when the last error came */
+static atomic_uint ulRestartPos;    /* byte number at buffer index 0 after it */
+static atomic_uint ulDropped;
+static atomic_int xReaderWaiting;
+
+static TaskHandle_t xReaderHandle = NULL;
+static UART_HandleTypeDef *pxRxUart = NULL;
+
+static BaseType_t prvStart(void)
+{
+  usDmaPos = 0U;
+  return (HAL_UARTEx_ReceiveToIdle_DMA(pxRxUart, ucRxBuffer, UART_RX_BUFFER_SIZE) == HAL_OK) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xUartRxInit(UART_HandleTypeDef *huart)
+{
+  pxRxUart = huart;
+  return prvStart();
+}
+
+void vUartRxEventFromISR(UART_HandleTypeDef *huart, uint16_t Size, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  uint16_t usPos = (uint16_t)(Size & (UART_RX_BUFFER_SIZE - 1U));
+  uint32_t ulNew = (uint32_t)(usPos - usDmaPos) & (UART_RX_BUFFER_SIZE - 1U);
+
+  if (huart != pxRxUart || ulNew == 0U)
+  {
+    return;
+  }
+
+  usDmaPos = usPos;
+  atomic_fetch_add_explicit(&ulHead, ulNew, memory_order_release);
+
+  if (xReaderHandle != NULL && atomic_exchange(&xReaderWaiting, 0) != 0)
+  {
+    vTaskNotifyGiveFromISR(xReaderHandle, pxHigherPriorityTaskWoken);
+  }
+}
+
+/* Overrun, noise or framing error: the HAL has stopped the DMA. Whatever
+arrived since the last event is lost, the stream continues at the start of
+the buffer. */
+void vUartRxErrorFromISR(UART_HandleTypeDef *huart)
+{
+  uint32_t ulHeadNow;
+  uint32_t ulGap;
+  uint32_t ulRestart;
+  uint32_t ulPrevRestart;
+
+  if (huart != pxRxUart)
+  {
+    return;
+  }
+
+  ulHeadNow = atomic_load_explicit(&ulHead, memory_order_relaxed);
+  ulGap = ulHeadNow;
+  ulPrevRestart = atomic_load_explicit(&ulRestartPos, memory_order_relaxed);
+  if ((int32_t)(ulPrevRestart - atomic_load_explicit(&ulTail, memory_order_relaxed)) > 0)
+  {
+    /* The reader has not passed the previous padding yet: keep its start,
+    the bytes received since that restart are given up. */
+    atomic_fetch_add_explicit(&ulDropped, ulHeadNow - ulPrevRestart, memory_order_relaxed);
+    ulGap = atomic_load_explicit(&ulGapStart, memory_order_relaxed);
+  }
+
+  ulRestart = (ulHeadNow + UART_RX_BUFFER_SIZE - 1U) & ~(UART_RX_BUFFER_SIZE - 1U);
+
+  /* The reader takes ulHead with acquire, then the gap. */
+  atomic_store_explicit(&ulGapStart, ulGap, memory_order_relaxed);
+  atomic_store_explicit(&ulRestartPos, ulRestart, memory_order_relaxed);
+  atomic_store_explicit(&ulHead, ulRestart, memory_order_release);
+
+  if (prvStart() == pdFAIL)
+  {
+    configASSERT(0);
+  }
+}
+
+/* Reads the padding left by the last error, [*pulGap, *pulRestart). The
+error handler may run in between, read again until both belong to it. */
+static void prvGetGap(uint32_t *pulGap, uint32_t *pulRestart)
+{
+  uint32_t ulRestart;
+
+  do
+  {
+    ulRestart = atomic_load_explicit(&ulRestartPos, memory_order_relaxed);
+    *pulGap = atomic_load_explicit(&ulGapStart, memory_order_relaxed);
+  } while (atomic_load_explicit(&ulRestartPos, memory_order_relaxed) != ulRestart);
+  *pulRestart = ulRestart;
+}
+
+/* Moves ulTail past bytes that are gone, returns pdTRUE when it did. */
+static BaseType_t prvSkipLost(uint32_t ulHeadNow)
+{
+  uint32_t ulTailNow = atomic_load_explicit(&ulTail, memory_order_relaxed);
+  uint32_t ulGap;
+  uint32_t ulRestart;
+  BaseType_t xGapAhead;
+
+  prvGetGap(&ulGap, &ulRestart);
+  xGapAhead = ((int32_t)(ulRestart - ulTailNow) > 0) ? pdTRUE : pdFALSE;
+
+  if (xGapAhead != pdFALSE && (int32_t)(ulTailNow - ulGap) >= 0)
+  {
+    /* Everything before the error is read, the rest up to the restart is
+    padding. */
+    atomic_store_explicit(&ulTail, ulRestart, memory_order_relaxed);
+    return pdTRUE;
+  }
+  if (ulHeadNow - ulTailNow > RX_SAFE_LEVEL)
+  {
+    /* The DMA may have overwritten the oldest bytes, drop them all. With a
+    padding ahead only the bytes before it, the ones after the restart are
+    checked again. */
+    if (xGapAhead != pdFALSE)
+    {
+      atomic_fetch_add_explicit(&ulDropped, ulGap - ulTailNow, memory_order_relaxed);
+      atomic_store_explicit(&ulTail, ulRestart, memory_order_relaxed);
+    }
+    else
+    {
+      atomic_fetch_add_explicit(&ulDropped, ulHeadNow - ulTailNow, memory_order_relaxed);
+      atomic_store_explicit(&ulTail, ulHeadNow, memory_order_relaxed);
+    }
+    return pdTRUE;
+  }
+  return pdFALSE;
+}
+
+/* Copies up to xLength bytes starting at ulTail, not past the padding of an
+error, returns the count. */
+static size_t prvCopy(uint8_t *pucBuffer, size_t xLength, uint32_t ulHeadNow)
+{
+  uint32_t ulTailNow = atomic_load_explicit(&ulTail, memory_order_relaxed);
+  uint32_t ulGap;
+  uint32_t ulRestart;
+  uint32_t ulAvailable;
+  uint32_t ulOffset = ulTailNow & (UART_RX_BUFFER_SIZE - 1U);
+  uint32_t ulCount;
+  uint32_t ulFirst = UART_RX_BUFFER_SIZE - ulOffset;
+
+  prvGetGap(&ulGap, &ulRestart);
+  if ((int32_t)(ulGap - ulTailNow) > 0 && (int32_t)(ulHeadNow - ulGap) > 0)
+  {
+    ulHeadNow = ulGap;
+  }
+  ulAvailable = ulHeadNow - ulTailNow;
+  ulCount = (xLength < ulAvailable) ? (uint32_t)xLength : ulAvailable;
+
+  if (ulFirst > ulCount)
+  {
+    ulFirst = ulCount;
+  }
+  memcpy(pucBuffer, &ucRxBuffer[ulOffset], ulFirst);
+  memcpy(&pucBuffer[ulFirst], ucRxBuffer, ulCount - ulFirst);
+
+  return ulCount;
+}
+
+/* Takes up to xLength of the bytes before ulHeadNow (there is at least one).
+Returns 0 when bytes were skipped instead, the caller looks again. */
+static size_t prvTake(void *pvBuffer, size_t xLength, uint32_t ulHeadNow)
+{
+  size_t xCount;
+
+  if (prvSkipLost(ulHeadNow) != pdFALSE)
+  {
+    return 0U;
+  }
+
+  xCount = prvCopy(pvBuffer, xLength, ulHeadNow);
+
+  /* The DMA keeps writing during the copy: if it may have reached the
+  bytes that were copied, the copy is torn. */
+  if (prvSkipLost(atomic_load_explicit(&ulHead, memory_order_acquire)) != pdFALSE)
+  {
+    return 0U;
+  }
+
+  atomic_fetch_add_explicit(&ulTail, (uint32_t)xCount, memory_order_relaxed);
+  return xCount;
+}
+
+size_t xUartRxRead(void *pvBuffer, size_t xLength, TickType_t xTicksToWait)
+{
+  TimeOut_t xTimeOut;
+
+  if (xLength == 0U)
+  {
+    return 0U;
+  }
+  if (xReaderHandle == NULL)
+  {
+    xReaderHandle = xTaskGetCurrentTaskHandle();
+  }
+  configASSERT(xReaderHandle == xTaskGetCurrentTaskHandle());
+
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    uint32_t ulHeadNow = atomic_load_explicit(&ulHead, memory_order_acquire);
+    size_t xCount;
+
+    if (ulHeadNow == atomic_load_explicit(&ulTail, memory_order_relaxed))
+    {
+      /* Announce the wait first, then look again: an event that came in
+      between either sees the flag or its bytes are found here. */
+      atomic_store(&xReaderWaiting, 1);
+      if (atomic_load_explicit(&ulHead, memory_order_acquire) == atomic_load_explicit(&ulTail, memory_order_relaxed))
+      {
+        if (xTicksToWait == 0U || xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+        {
+          atomic_store(&xReaderWaiting, 0);
+          return 0U;
+        }
+        (void)ulTaskNotifyTake(pdTRUE, xTicksToWait);
+        continue;
+      }
+      atomic_store(&xReaderWaiting, 0);
+      continue;
+    }
+
+    xCount = prvTake(pvBuffer, xLength, ulHeadNow);
+    if (xCount != 0U)
+    {
+      return xCount;
+    }
+  }
+}
+
+size_t xUartRxReadFromISR(void *pvBuffer, size_t xLength)
+{
+  /* Either a task or the interrupt reads, not both. */
+  configASSERT(xReaderHandle == NULL);
+
+  for (;;)
+  {
+    uint32_t ulHeadNow = atomic_load_explicit(&ulHead, memory_order_acquire);
+    size_t xCount;
+
+    if (xLength == 0U || ulHeadNow == atomic_load_explicit(&ulTail, memory_order_relaxed))
+    {
+      return 0U;
+    }
+
+    xCount = prvTake(pvBuffer, xLength, ulHeadNow);
+    if (xCount != 0U)
+    {
+      return xCount;
+    }
+  }
+}
+
+uint32_t ulUartRxGetDropped(void)
+{
+  return atomic_load_explicit(&ulDropped, memory_order_relaxed);
+}
@@ -0,0 +1,555 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "latency_hist.h"
+
+#include "string.h"
+#include "stdio.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Wake-up handoff benchmark: how long does it take from "give" until the
+ * waiting task runs?
+ *
+ *   notify     xTaskNotifyGive()      / ulTaskNotifyTake()   (Simple_Task_to_Task_Notification)
+ *   semaphore  xSemaphoreGive()       / xSemaphoreTake()     (Semaphore/Binary)
+ *   event grp  xEventGroupSetBits()   / xEventGroupWaitBits()
+ *   queue[1]   xQueueSend()           / xQueueReceive()      (queue of length 1)
+ *
+ * task->task: the Waker stamps the perf counter and gives, the Waiter has the
+ * higher priority, so it runs inside the give and stamps again.
+ * ISR->task:  the Waker triggers EXTI0 by software, HAL_GPIO_EXTI_Callback()
+ * stamps and gives with the FromISR variant. xEventGroupSetBitsFromISR()
+ * does not set the bits itself, it queues the call for the timer task, so
+ * that row includes a second context switch.
+ *
+ * "heap" is what creating the object took from the FreeRTOS heap. A task
+ * notification needs no object, its state is part of every task's TCB.
+ */
+
+#define BENCH_HANDOFFS        10000U  /* task->task, per mechanism */
+#define BENCH_ISR_HANDOFFS    1000U   /* ISR->task, one per tick */
+
+#define BENCH_WAKER_PRIO      2
+#define BENCH_WAITER_PRIO     3
+#define BENCH_CONTROL_PRIO    4       /* below configTIMER_TASK_PRIORITY */
+
+#define BENCH_EVENT_BIT       (1U << 0)
+
+#ifdef HOST_BUILD
+#define BENCH_TRIGGER_IRQ()   HostPort_RaiseExti(GPIO_PIN_0)
+#else
+#define BENCH_TRIGGER_IRQ()   (EXTI->SWIER = GPIO_PIN_0)   // software interrupt on EXTI0 (PA0 button line)
+#endif
+
+typedef enum {
+	BENCH_NOTIFY,
+	BENCH_SEMAPHORE,
+	BENCH_EVENT_GROUP,
+	BENCH_QUEUE,
+	BENCH_MECHANISMS
+}BenchMechanism;
+
+static const char* mechanismNames[] = { "notify", "semaphore", "event grp", "queue[1]" };
+
+/* *************************** Kernel objects ******************************* */
+SemaphoreHandle_t Semaphore_Handle;
+EventGroupHandle_t EventGroup_Handle;
+QueueHandle_t Queue_Handle;
+
+/* *************************** Task Handles ******************************* */
+TaskHandle_t Control_Handle;
+TaskHandle_t Waker_Handle;
+TaskHandle_t Waiter_Handle;
+
+static BenchMechanism mechanism;
+static volatile BaseType_t fromISR;
+static volatile uint32_t giveStamp;
+static uint32_t handoffs;
+static LatencyHist_t latency;
+
+static char line[96];
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+/* *************************** Task Functions ***************************** */
+void Waiter(void* pv)
+{
+	uint32_t item;
+
+	for (uint32_t i = 0; i < handoffs; i++)
+	{
+		switch (mechanism) {
+		case BENCH_NOTIFY:
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			break;
+		case BENCH_SEMAPHORE:
+			xSemaphoreTake(Semaphore_Handle, portMAX_DELAY);
+			break;
+		case BENCH_EVENT_GROUP:
+			xEventGroupWaitBits(EventGroup_Handle, BENCH_EVENT_BIT, pdTRUE, pdFALSE, portMAX_DELAY);
+			break;
+		default:
+			xQueueReceive(Queue_Handle, &item, portMAX_DELAY);
+			break;
+		}
+		vLatencyHistAdd(&latency, ulPerfCounterGet() - giveStamp);
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Control
+}
+
+void Waker(void* pv)
+{
+	for (uint32_t i = 0; i < handoffs; i++)
+	{
+		if (fromISR) {
+			vTaskDelay(1); // the Waiter is done with the previous one
+			BENCH_TRIGGER_IRQ();
+			continue;
+		}
+
+		giveStamp = ulPerfCounterGet();
+		switch (mechanism) {
+		case BENCH_NOTIFY:
+			xTaskNotifyGive(Waiter_Handle);
+			break;
+		case BENCH_SEMAPHORE:
+			xSemaphoreGive(Semaphore_Handle);
+			break;
+		case BENCH_EVENT_GROUP:
+			xEventGroupSetBits(EventGroup_Handle, BENCH_EVENT_BIT);
+			break;
+		default:
+			xQueueSend(Queue_Handle, (void*)&giveStamp, portMAX_DELAY);
+			break;
+		}
+	}
+
+	vTaskSuspend(NULL); // deleted by Control
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+	if (GPIO_Pin != GPIO_PIN_0 || !fromISR || Waiter_Handle == NULL)
+	{
+		return;
+	}
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t item;
+
+	giveStamp = ulPerfCounterGet();
+	item = giveStamp;
+	switch (mechanism) {
+	case BENCH_NOTIFY:
+		vTaskNotifyGiveFromISR(Waiter_Handle, &xHigherPriorityTaskWoken);
+		break;
+	case BENCH_SEMAPHORE:
+		xSemaphoreGiveFromISR(Semaphore_Handle, &xHigherPriorityTaskWoken);
+		break;
+	case BENCH_EVENT_GROUP:
+		xEventGroupSetBitsFromISR(EventGroup_Handle, BENCH_EVENT_BIT, &xHigherPriorityTaskWoken);
+		break;
+	default:
+		xQueueSendFromISR(Queue_Handle, &item, &xHigherPriorityTaskWoken);
+		break;
+	}
+
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/* Returns the heap taken by the kernel object, 0 for a notification. */
+static size_t Bench_CreateObject(BenchMechanism m)
+{
+	size_t freeBefore = xPortGetFreeHeapSize();
+
+	switch (m) {
+	case BENCH_NOTIFY:
+		break;
+	case BENCH_SEMAPHORE:
+		Semaphore_Handle = xSemaphoreCreateBinary();
+		break;
+	case BENCH_EVENT_GROUP:
+		EventGroup_Handle = xEventGroupCreate();
+		break;
+	default:
+		Queue_Handle = xQueueCreate(1, sizeof(uint32_t));
+		break;
+	}
+	return freeBefore - xPortGetFreeHeapSize();
+}
+
+static void Bench_DeleteObject(BenchMechanism m)
+{
+	switch (m) {
+	case BENCH_NOTIFY:
+		break;
+	case BENCH_SEMAPHORE:
+		vSemaphoreDelete(Semaphore_Handle);
+		break;
+	case BENCH_EVENT_GROUP:
+		vEventGroupDelete(EventGroup_Handle);
+		break;
+	default:
+		vQueueDelete(Queue_Handle);
+		break;
+	}
+}
+
+static void Bench_Run(BenchMechanism m, BaseType_t isr)
+{
+	mechanism = m;
+	handoffs = isr ? BENCH_ISR_HANDOFFS : BENCH_HANDOFFS;
+	vLatencyHistReset(&latency);
+
+	fromISR = isr;
+
+	size_t heapBytes = Bench_CreateObject(m);
+
+	// Waiter first, so it is blocked before the first give
+	xTaskCreate(Waiter, "Waiter", 256, NULL, BENCH_WAITER_PRIO, &Waiter_Handle);
+	xTaskCreate(Waker, "Waker", 256, NULL, BENCH_WAKER_PRIO, &Waker_Handle);
+
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	fromISR = pdFALSE;
+	vTaskDelete(Waker_Handle);
+	vTaskDelete(Waiter_Handle);
+	Waiter_Handle = NULL;
+	Bench_DeleteObject(m);
+
+	sprintf(line, "%-10s %-10s %8lu %8lu %8lu %8lu %6u\n",
+			mechanismNames[m], isr ? "ISR->task" : "task->task",
+			(unsigned long)ulLatencyHistPercentile(&latency, 500),
+			(unsigned long)ulLatencyHistPercentile(&latency, 990),
+			(unsigned long)latency.ulMax,
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&latency, 500)),
+			(unsigned)heapBytes);
+	Bench_Print(line);
+}
+
+void Control(void* pv)
+{
+	sprintf(line, "\nHandoff benchmark, counter %lu Hz (cycles on the target)\n", (unsigned long)ulPerfCounterHz());
+	Bench_Print(line);
+	Bench_Print("mechanism  path            p50      p99      max   p50 ns   heap\n");
+
+	for (BenchMechanism m = BENCH_NOTIFY; m < BENCH_MECHANISMS; m++) {
+		Bench_Run(m, pdFALSE);
+		Bench_Run(m, pdTRUE);
+	}
+
+	// ulNotifiedValue + ucNotifyState, present in every TCB whether used or not
+	Bench_Print("notify uses no heap, its state is 5 bytes in every TCB\n");
+	Bench_Print("done\n");
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+
+  /* ********************** Create Tasks ************************ */
+  xTaskCreate(Control, "Control", 256, NULL, BENCH_CONTROL_PRIO, &Control_Handle);
+
+  /* ********************** Start Scheduler *********************** */
+  vTaskStartScheduler();
+
+  /* USER CODE END 2 */
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pin : PA0 */
+  GPIO_InitStruct.Pin = GPIO_PIN_0;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI0_IRQn, 7, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
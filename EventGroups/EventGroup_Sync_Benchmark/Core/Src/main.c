@@ -0,0 +1,472 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+//#include "timers.h"
+//#include "queue.h"
+//#include "semphr.h"
+#include "event_groups.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "latency_hist.h"
+#include "barrier.h"
+
+#include "string.h"
+#include "stdio.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * xEventGroupSync() barrier with N participants, N = 2 ... 24 (24 event bits
+ * with 32 bit ticks, configUSE_16_BIT_TICKS 0).
+ *
+ * N-1 Waiter tasks are blocked in xEventGroupSync() when the Arriver, the
+ * last participant, stamps the perf counter and calls it too. Its set bits
+ * walks the list of all N-1 waiters with the scheduler suspended and moves
+ * every one to the ready list; only then does the first waiter run. Each
+ * waiter stamps when it is released and syncs again for the next round.
+ * The waiters have the higher priority, so the Arriver only continues once
+ * all of them are blocked again.
+ *
+ *   first  last arrival -> first waiter runs: the O(waiters) wake walk
+ *   all    last arrival -> last waiter runs: walk + N-1 context switches
+ *
+ * Per round both are taken from the stamps, per N the p50/max over
+ * BENCH_ROUNDS rounds is printed.
+ *
+ * The same rounds are then run with the generation counted barrier of
+ * Common/barrier.h, which is not limited by the event bits (N = 32).
+ */
+
+#define BENCH_ROUNDS          500U
+#define BENCH_MAX_PARTICIPANTS 32U
+#define BENCH_EVENT_BITS      24U     /* event bits available with 32 bit ticks */
+
+#define BENCH_ARRIVER_PRIO    2
+#define BENCH_WAITER_PRIO     3
+#define BENCH_CONTROL_PRIO    4
+
+typedef enum {
+	BENCH_EVENT_GROUP,
+	BENCH_BARRIER,
+}BenchVariant;
+
+static const char* variantNames[] = { "sync", "barrier" };
+static const uint32_t participantCounts[] = { 2, 3, 4, 8, 12, 16, 20, 24, 32 };
+
+/* ************************ Event Group Handle ***************************** */
+EventGroupHandle_t EventGroup_Handle;
+BarrierHandle_t Barrier_Handle;
+
+/* ************************ Task Handlers ***************************** */
+TaskHandle_t Control_Handle;
+TaskHandle_t Arriver_Handle;
+TaskHandle_t Waiter_Handles[BENCH_MAX_PARTICIPANTS - 1];
+
+static BenchVariant variant;
+static uint32_t participants;
+static EventBits_t allSyncBits;
+static volatile uint32_t arriveStamp;
+static volatile uint32_t releaseStamp[BENCH_MAX_PARTICIPANTS - 1];
+static LatencyHist_t firstReleased;
+static LatencyHist_t allReleased;
+
+static char line[96];
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+/* ************************ Task Functions ************************* */
+void Waiter(void* pv)
+{
+	uint32_t index = (uint32_t)(uintptr_t)pv;
+
+	for(;;)
+	{
+		if (variant == BENCH_EVENT_GROUP) {
+			xEventGroupSync(EventGroup_Handle, (EventBits_t)1 << index, allSyncBits, portMAX_DELAY);
+		} else {
+			xBarrierWait(Barrier_Handle, portMAX_DELAY, NULL);
+		}
+		releaseStamp[index] = ulPerfCounterGet();
+	}
+}
+
+void Arriver(void* pv)
+{
+	const EventBits_t arriverBit = (EventBits_t)1 << (participants - 1);
+
+	for (uint32_t round = 0; round < BENCH_ROUNDS; round++)
+	{
+		arriveStamp = ulPerfCounterGet();
+		if (variant == BENCH_EVENT_GROUP) {
+			xEventGroupSync(EventGroup_Handle, arriverBit, allSyncBits, portMAX_DELAY);
+		} else {
+			xBarrierWait(Barrier_Handle, portMAX_DELAY, NULL);
+		}
+
+		// Every waiter ran and is blocked again for the next round
+		uint32_t first = releaseStamp[0] - arriveStamp;
+		uint32_t all = first;
+		for (uint32_t i = 1; i < participants - 1; i++) {
+			uint32_t released = releaseStamp[i] - arriveStamp;
+			if (released < first) first = released;
+			if (released > all) all = released;
+		}
+		vLatencyHistAdd(&firstReleased, first);
+		vLatencyHistAdd(&allReleased, all);
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Control
+}
+
+static void Bench_Run(BenchVariant v, uint32_t n)
+{
+	if (v == BENCH_EVENT_GROUP && n > BENCH_EVENT_BITS) {
+		return;
+	}
+
+	variant = v;
+	participants = n;
+	vLatencyHistReset(&firstReleased);
+	vLatencyHistReset(&allReleased);
+
+	if (v == BENCH_EVENT_GROUP) {
+		allSyncBits = ((EventBits_t)1 << n) - 1;
+		EventGroup_Handle = xEventGroupCreate();
+	} else {
+		Barrier_Handle = xBarrierCreate(n);
+	}
+
+	// The waiters run first and block in the barrier, then the Arriver
+	for (uint32_t i = 0; i < n - 1; i++) {
+		xTaskCreate(Waiter, "Waiter", 128, (void*)(uintptr_t)i, BENCH_WAITER_PRIO, &Waiter_Handles[i]);
+	}
+	xTaskCreate(Arriver, "Arriver", 128, NULL, BENCH_ARRIVER_PRIO, &Arriver_Handle);
+
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	vTaskDelete(Arriver_Handle);
+	for (uint32_t i = 0; i < n - 1; i++) {
+		vTaskDelete(Waiter_Handles[i]);
+	}
+	if (v == BENCH_EVENT_GROUP) {
+		vEventGroupDelete(EventGroup_Handle);
+	} else {
+		vBarrierDelete(Barrier_Handle);
+	}
+
+	uint32_t firstP50 = ulLatencyHistPercentile(&firstReleased, 500);
+	uint32_t allP50 = ulLatencyHistPercentile(&allReleased, 500);
+
+	sprintf(line, "%-7s %3lu %9lu %9lu %9lu %9lu %9lu\n", variantNames[v], (unsigned long)n,
+			(unsigned long)firstP50, (unsigned long)(firstP50 / (n - 1)),
+			(unsigned long)allP50, (unsigned long)allReleased.ulMax,
+			(unsigned long)ulPerfCounterToNs(allP50));
+	Bench_Print(line);
+}
+
+void Control(void* pv)
+{
+	sprintf(line, "\nBarrier benchmark, %u rounds per N, counter %lu Hz\n",
+			(unsigned)BENCH_ROUNDS, (unsigned long)ulPerfCounterHz());
+	Bench_Print(line);
+	Bench_Print("variant   N first p50 per waiter   all p50   all max all p50 ns\n");
+
+	for (uint32_t i = 0; i < sizeof(participantCounts) / sizeof(participantCounts[0]); i++) {
+		Bench_Run(BENCH_EVENT_GROUP, participantCounts[i]);
+		Bench_Run(BENCH_BARRIER, participantCounts[i]);
+	}
+
+	Bench_Print("done\n");
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+
+	// Create Tasks
+	xTaskCreate(Control, "Control", 256, NULL, BENCH_CONTROL_PRIO, &Control_Handle);
+
+	// Start Scheduler
+	vTaskStartScheduler();
+
+  /* USER CODE END 2 */
+
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
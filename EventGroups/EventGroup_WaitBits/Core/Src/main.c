@@ -27,6 +27,9 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include <string.h>
+#include "periodic.h"
+#include "perf_counter.h"
 
 /* USER CODE END Includes */
 
@@ -80,13 +83,27 @@ const uint32_t task03_id = ( 1 << 2 ); // 0x04 bit 2
 
 const uint32_t all_sync_bits = ( task01_id | task02_id | task03_id ); // 0x07 bits 0, 1, 2
 
+/* ********************* Periodic releases *********************************** */
+// Same 1 s grid for the three tasks, 100 ms apart, so the watchdog window
+// always sees them in the same order and none of them drifts out of it
+PeriodicTask_t Task01Periodic;
+PeriodicTask_t Task02Periodic;
+PeriodicTask_t Task03Periodic;
+
+#define STATS_EVERY_ROUNDS   10
+
+void PrintLine(const char *line)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)line, strlen(line), HAL_MAX_DELAY);
+}
+
 void Task01(void* pvParameters)
 {
 	for(;;)
 	{
+		vPeriodicWait(&Task01Periodic);
 		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13);
 		xEventGroupSetBits(xEventBits, task01_id);
-		vTaskDelay(pdMS_TO_TICKS(1000));
 	}
 }
 
@@ -94,9 +111,9 @@ void Task02(void *pvParameters)
 {
 	for(;;)
 	{
+		vPeriodicWait(&Task02Periodic);
 		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
 		xEventGroupSetBits(xEventBits, task02_id);
-		vTaskDelay(pdMS_TO_TICKS(1000));
 	}
 }
 
@@ -105,6 +122,7 @@ void Task03(void *pvParameters)
 	int count = 0;
 	for(;;)
 	{
+		vPeriodicWait(&Task03Periodic);
 		if (count >= 4 && count <= 9) // every 4th to 9th iteration the task will not set its bit
 		{
 			// do nothing, simulating a task failure
@@ -115,12 +133,13 @@ void Task03(void *pvParameters)
 		}
 		count++;
 		if(count > 11) count = 0;
-		vTaskDelay(pdMS_TO_TICKS(1000));
 	}
 }
 
 void Tasks_WatchDog(void *pvParameters)
 {
+	uint32_t rounds = 0;
+
 	for(;;)
 	{
 		uint32_t result = xEventGroupWaitBits(
@@ -145,6 +164,10 @@ void Tasks_WatchDog(void *pvParameters)
 				HAL_UART_Transmit(&huart1, (uint8_t*) "Task03 is not running. Task03 failure. \n", 40 , HAL_MAX_DELAY);
 			}
 		}
+
+		if (++rounds % STATS_EVERY_ROUNDS == 0) {
+			vPeriodicDump(PrintLine);
+		}
 	}
 }
 
@@ -182,6 +205,8 @@ int main(void)
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
 
+  vPerfCounterInit();
+
   /* *********************** Create Event Group ************************** */
   xEventBits = xEventGroupCreate();
 
@@ -191,12 +216,17 @@ int main(void)
 	HAL_UART_Transmit(&huart1, (uint8_t *)"Event Group was created\n", 26, HAL_MAX_DELAY);
   }
 
+  /* *********************** Periodic releases *************************** */
+  vPeriodicInit(&Task01Periodic, "T1", pdMS_TO_TICKS(1000), pdMS_TO_TICKS(0));
+  vPeriodicInit(&Task02Periodic, "T2", pdMS_TO_TICKS(1000), pdMS_TO_TICKS(100));
+  vPeriodicInit(&Task03Periodic, "T3", pdMS_TO_TICKS(1000), pdMS_TO_TICKS(200));
+
   /* *********************** Create Tasks ******************************** */
   xTaskCreate(Task01, "T1", 128, NULL, 1, &Task01Handle);
   xTaskCreate(Task02, "T2", 128, NULL, 1, &Task02Handle);
   xTaskCreate(Task03, "T3", 128, NULL, 1, &Task03Handle);
 
-  xTaskCreate(Tasks_WatchDog, "WD", 128, NULL, 2, &Tasks_WatchDogHandle);
+  xTaskCreate(Tasks_WatchDog, "WD", 256, NULL, 2, &Tasks_WatchDogHandle);
 
   vTaskStartScheduler();
 
@@ -0,0 +1,424 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include <string.h>
+#include "heartbeat.h"
+#include "periodic.h"
+#include "perf_counter.h"
+#include "uart_log.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Tasks_WatchDog of EventGroup_WaitBits on the heartbeat service: every
+ * task registers with its own timeout and checks in once per loop, the
+ * "Heartbeat" task reports a task when it goes silent and when it is back.
+ */
+
+/* ********************* Task Handles *************************************** */
+TaskHandle_t Task01Handle = NULL;
+TaskHandle_t Task02Handle = NULL;
+TaskHandle_t Task03Handle = NULL;
+
+TaskHandle_t ReportHandle = NULL;
+
+/* ********************* Heartbeat ids ************************************** */
+BaseType_t task01_id;
+BaseType_t task02_id;
+BaseType_t task03_id;
+
+/* ********************* Periodic releases *********************************** */
+// Absolute releases: a 1 s task checks in every 1000 ms exactly, however long
+// its loop body takes, and never drifts towards the end of its window
+PeriodicTask_t Task01Periodic;
+PeriodicTask_t Task02Periodic;
+PeriodicTask_t Task03Periodic;
+PeriodicTask_t ReportPeriodic;
+
+#define REPORT_PERIOD_MS   10000
+
+void PrintLine(const char *line)
+{
+	xUartLogWrite(line, strlen(line));
+}
+
+/* Runs in the "Heartbeat" task */
+void OnHeartbeat(BaseType_t xId, BaseType_t xMissing)
+{
+	if (xMissing) {
+		xUartLogPrintf("%s is not running. %s failure.\n", pcHeartbeatGetName(xId), pcHeartbeatGetName(xId));
+	} else {
+		xUartLogPrintf("%s is running again\n", pcHeartbeatGetName(xId));
+	}
+}
+
+void Task01(void* pvParameters)
+{
+	for(;;)
+	{
+		vPeriodicWait(&Task01Periodic);
+		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13);
+		vHeartbeatCheckIn(task01_id);
+	}
+}
+
+void Task02(void *pvParameters)
+{
+	for(;;)
+	{
+		vPeriodicWait(&Task02Periodic);
+		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
+		vHeartbeatCheckIn(task02_id);
+	}
+}
+
+void Task03(void *pvParameters)
+{
+	int count = 0;
+	for(;;)
+	{
+		vPeriodicWait(&Task03Periodic);
+		if (count >= 4 && count <= 9) // every 4th to 9th iteration the task will not check in
+		{
+			// do nothing, simulating a task failure
+		} else
+		{
+			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_11);
+			vHeartbeatCheckIn(task03_id);
+		}
+		count++;
+		if(count > 11) count = 0;
+	}
+}
+
+void Report(void *pvParameters)
+{
+	const BaseType_t ids[] = { task01_id, task02_id, task03_id };
+
+	for(;;)
+	{
+		vPeriodicWait(&ReportPeriodic);
+
+		for (uint32_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+			xUartLogPrintf("%s: misses %lu, worst gap %lu ms\n", pcHeartbeatGetName(ids[i]),
+					(unsigned long)ulHeartbeatGetMisses(ids[i]),
+					(unsigned long)(xHeartbeatGetWorstGap(ids[i]) * portTICK_PERIOD_MS));
+		}
+		vPeriodicDump(PrintLine);
+	}
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+
+  vPerfCounterInit();
+  xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
+
+  /* *********************** Start Heartbeat Watchdog ******************** */
+  if (xHeartbeatInit(OnHeartbeat) != pdPASS) {
+	HAL_UART_Transmit(&huart1, (uint8_t *)"Heartbeat task was not created\n", 31, HAL_MAX_DELAY);
+  } else {
+	HAL_UART_Transmit(&huart1, (uint8_t *)"Heartbeat task was created\n", 27, HAL_MAX_DELAY);
+  }
+
+  // Every task gets its own timeout
+  task01_id = xHeartbeatRegister("Task01", pdMS_TO_TICKS(1500));
+  task02_id = xHeartbeatRegister("Task02", pdMS_TO_TICKS(500));
+  task03_id = xHeartbeatRegister("Task03", pdMS_TO_TICKS(2000));
+
+  // Phases keep the tasks out of each other's tick
+  vPeriodicInit(&Task01Periodic, "T1", pdMS_TO_TICKS(1000), pdMS_TO_TICKS(0));
+  vPeriodicInit(&Task02Periodic, "T2", pdMS_TO_TICKS(250), pdMS_TO_TICKS(50));
+  vPeriodicInit(&Task03Periodic, "T3", pdMS_TO_TICKS(1000), pdMS_TO_TICKS(100));
+  vPeriodicInit(&ReportPeriodic, "Report", pdMS_TO_TICKS(REPORT_PERIOD_MS), pdMS_TO_TICKS(500));
+
+  /* *********************** Create Tasks ******************************** */
+  xTaskCreate(Task01, "T1", 128, NULL, 1, &Task01Handle);
+  xTaskCreate(Task02, "T2", 128, NULL, 1, &Task02Handle);
+  xTaskCreate(Task03, "T3", 128, NULL, 1, &Task03Handle);
+
+  xTaskCreate(Report, "Report", 256, NULL, 1, &ReportHandle);
+
+  vTaskStartScheduler();
+
+  /* USER CODE END 2 */
+
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
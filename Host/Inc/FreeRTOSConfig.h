@@ -0,0 +1,62 @@
+/*
+ * Host (FreeRTOS POSIX port) configuration.
+ *
+ * The Makefile points HOST_APP_CONFIG at the example's own
+ * Core/Inc/FreeRTOSConfig.h, so every kernel feature an example enables on
+ * the STM32F429 (timers, recursive mutexes, counting semaphores, ...) is
+ * enabled identically here. Only the settings that belong to the Cortex-M4
+ * port are overridden below.
+ */
+
+#ifndef HOST_FREERTOS_CONFIG_H
+#define HOST_FREERTOS_CONFIG_H
+
+#include HOST_APP_CONFIG
+
+/* Cortex-M4 exception handler names have no meaning on the POSIX port. */
+#undef vPortSVCHandler
+#undef xPortPendSVHandler
+#undef xPortSysTickHandler
+
+/* TCBs and stack words are twice as wide on a 64-bit host. An example that
+needs more can set configHOST_TOTAL_HEAP_SIZE, the target build ignores it. */
+#undef configTOTAL_HEAP_SIZE
+#ifdef configHOST_TOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                    configHOST_TOTAL_HEAP_SIZE
+#else
+#define configTOTAL_HEAP_SIZE                    ((size_t)(64 * 1024))
+#endif
+
+/* Generic C task selection, the CLZ variant is specific to the ARM port. */
+#undef configUSE_PORT_OPTIMISED_TASK_SELECTION
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+
+/* No example creates kernel objects statically, so the host does not have to
+supply idle/timer task buffers. */
+#undef configSUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION          0
+
+/* The tick hook plays TIM6 (HAL_IncTick) and releases the simulated
+interrupt task, see Host/Src/host_port.c. */
+#undef configUSE_TICK_HOOK
+#define configUSE_TICK_HOOK                      1
+
+/* HOST_FAST_FORWARD=1: when every task is blocked the idle task jumps the
+tick count straight to the next wakeup instead of waiting for it in real time.
+Mode 2 means the suppression routine is supplied by the application. */
+void vHostSuppressTicksAndSleep( uint32_t ulExpectedIdleTime );
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                  2
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vHostSuppressTicksAndSleep( xExpectedIdleTime )
+
+/* Priority of the task that runs HAL_GPIO_EXTI_Callback() and
+HAL_UART_RxCpltCallback(). It sits above every example task, the same way an
+ISR preempts all of them on the target. */
+#define configHOST_IRQ_TASK_PRIORITY             ( configMAX_PRIORITIES - 1 )
+
+/* A failed assert must stop a CI run instead of spinning forever. */
+void vHostAssertCalled( const char *pcFile, unsigned long ulLine );
+#undef configASSERT
+#define configASSERT( x ) if ((x) == 0) { vHostAssertCalled( __FILE__, __LINE__ ); }
+
+#endif /* HOST_FREERTOS_CONFIG_H */
@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file           : host_gpio.h
+  * @brief          : GPIO edge recorder for the host build
+  ******************************************************************************
+  * @attention
+  *
+  * Every HAL_GPIO_WritePin() / HAL_GPIO_TogglePin() that changes an output is
+  * stored as one edge in a preallocated ring, so the PG11/PG13/PG14 probes the
+  * examples toggle can be inspected after a run without a logic analyzer.
+  *
+  * HOST_VCD=<file> writes the edges still in the ring as a VCD waveform at
+  * exit, one signal per pin that moved (PG13 ...), for GTKWave or any other
+  * waveform viewer. The time is host ns; with HOST_VCD_TICKS=1 it is the
+  * kernel tick instead, which is the same from run to run under
+  * HOST_FAST_FORWARD=1, so two builds can be compared with diff.
+  *
+  ******************************************************************************
+  */
+
+#ifndef HOST_GPIO_H
+#define HOST_GPIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define HOST_GPIO_EDGE_LOG_SIZE   65536U   /* power of two */
+
+typedef struct
+{
+  uint64_t ullTimeNs;   /* host time since HAL_Init() */
+  uint32_t ulTick;      /* kernel tick count */
+  uint8_t  ucPort;      /* 0 = GPIOA ... 6 = GPIOG */
+  uint8_t  ucPin;       /* 0 ... 15 */
+  uint8_t  ucLevel;     /* level after the edge */
+} HostGpioEdge_t;
+
+typedef void (*HostGpioEdgeFn_t)(const HostGpioEdge_t *pxEdge, void *pvContext);
+
+void HostGpio_Init(void);
+void HostGpio_RecordEdges(uint32_t ulPort, uint32_t ulOld, uint32_t ulNew);
+
+/* Edges recorded for one pin since HAL_Init(), including overwritten ones. */
+uint32_t HostGpio_GetEdgeCount(uint32_t ulPort, uint32_t ulPin);
+
+/* Visits the edges still in the ring, oldest first. */
+void HostGpio_ForEachEdge(HostGpioEdgeFn_t pxFn, void *pvContext);
+
+/* Writes the edges still in the ring as a VCD file, time in ns or, with
+xTicks, in kernel ticks. Returns 0, -1 when the file cannot be written. */
+int HostGpio_WriteVcd(const char *pcPath, int xTicks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_GPIO_H */
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file           : host_port.h
+  * @brief          : Simulated interrupts and run control for the host build
+  ******************************************************************************
+  * @attention
+  *
+  * On the POSIX port only one FreeRTOS task thread runs at a time, but a plain
+  * pthread (stdin reader, test driver, ...) runs truly in parallel and must
+  * not touch kernel objects. Interrupt sources therefore only post their
+  * request here; the tick hook releases a top priority "IRQ" task that runs
+  * HAL_GPIO_EXTI_Callback() / HAL_UART_RxCpltCallback() /
+  * HAL_UARTEx_RxEventCallback() with the same preemption behaviour an ISR
+  * has on the STM32.
+  *
+  * Environment variables read by HostPort_Init():
+  *   HOST_UART=pty           UART1 on a pseudo terminal instead of stdio
+  *   HOST_EXTI_PERIOD_MS=n   fire every configured EXTI line each n ms
+  *   HOST_RUN_MS=n           exit(0) after n ms of kernel time
+  *   HOST_FAST_FORWARD=1     skip idle time, see vHostSuppressTicksAndSleep()
+  *   HOST_GPIO_TRACE=1       print every GPIO edge to stderr
+  *   HOST_VCD=file           write the GPIO edges as VCD at exit, see host_gpio.h
+  *
+  ******************************************************************************
+  */
+
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Called from HAL_Init(), before any example task is created. */
+void HostPort_Init(void);
+
+/* Interrupt requests, callable from any thread. */
+void HostPort_RaiseExti(uint16_t GPIO_Pin);
+void HostPort_RaiseUartRx(const uint8_t *pData, size_t Size);
+void HostPort_Kick(void);
+
+/* Starts the thread that feeds bytes read from fd into UART1 RX. */
+void HostPort_StartUartRx(int fd);
+
+/* write(2) that survives EINTR from the port's tick signal. */
+void HostPort_Write(int fd, const void *pData, size_t Size);
+
+/* Monotonic host time in nanoseconds. */
+uint64_t HostPort_TimeNs(void);
+
+uint32_t HostPort_EnvU32(const char *pcName, uint32_t ulDefault);
+uint64_t HostPort_EnvU64(const char *pcName, uint64_t ullDefault);
+
+/* Non-zero when HOST_FAST_FORWARD is set. */
+int HostPort_IsFastForward(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_PORT_H */
@@ -0,0 +1,344 @@
+/**
+  ******************************************************************************
+  * @file           : stm32f4xx_hal.h
+  * @brief          : Host stand-in for the STM32F4 HAL
+  ******************************************************************************
+  * @attention
+  *
+  * Only the part of the HAL that the examples in this repository touch is
+  * provided. The types keep the field names of the real HAL so the generated
+  * MX_xxx_Init() code in every main.c compiles unchanged, but the register
+  * blocks behind GPIOx / USART1 / TIM6 / DMA2_Stream2 are plain host memory.
+  *
+  * UART1 is mapped to stdout/stdin (or a pty), GPIO writes are recorded as
+  * pin edges and the EXTI / UART RX callbacks are fired from the simulated
+  * interrupt task in host_port.c.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __STM32F4xx_HAL_H
+#define __STM32F4xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define __IO     volatile
+#define __weak   __attribute__((weak))
+
+#define HAL_MAX_DELAY      0xFFFFFFFFU
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  EXTI0_IRQn          = 6,
+  EXTI1_IRQn          = 7,
+  EXTI2_IRQn          = 8,
+  EXTI3_IRQn          = 9,
+  EXTI4_IRQn          = 10,
+  EXTI9_5_IRQn        = 23,
+  USART1_IRQn         = 37,
+  EXTI15_10_IRQn      = 40,
+  TIM6_DAC_IRQn       = 54,
+  DMA2_Stream2_IRQn   = 58,
+  HOST_IRQn_COUNT     = 96
+} IRQn_Type;
+
+/* ------------------------------- Peripherals ------------------------------ */
+typedef struct
+{
+  __IO uint32_t MODER;
+  __IO uint32_t IDR;
+  __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+  __IO uint32_t SR;
+  __IO uint32_t DR;
+  __IO uint32_t BRR;
+} USART_TypeDef;
+
+typedef struct
+{
+  __IO uint32_t CNT;
+  __IO uint32_t ARR;
+} TIM_TypeDef;
+
+typedef struct
+{
+  __IO uint32_t CR;
+  __IO uint32_t NDTR;
+} DMA_Stream_TypeDef;
+
+#define HOST_GPIO_PORT_COUNT   11U   /* GPIOA .. GPIOK */
+
+extern GPIO_TypeDef  HostGpioPorts[HOST_GPIO_PORT_COUNT];
+extern USART_TypeDef HostUsart1;
+extern TIM_TypeDef   HostTim6;
+extern DMA_Stream_TypeDef HostDma2Stream2;
+
+#define GPIOA   (&HostGpioPorts[0])
+#define GPIOB   (&HostGpioPorts[1])
+#define GPIOC   (&HostGpioPorts[2])
+#define GPIOD   (&HostGpioPorts[3])
+#define GPIOE   (&HostGpioPorts[4])
+#define GPIOF   (&HostGpioPorts[5])
+#define GPIOG   (&HostGpioPorts[6])
+#define GPIOH   (&HostGpioPorts[7])
+#define GPIOI   (&HostGpioPorts[8])
+#define GPIOJ   (&HostGpioPorts[9])
+#define GPIOK   (&HostGpioPorts[10])
+#define USART1  (&HostUsart1)
+#define TIM6    (&HostTim6)
+#define DMA2_Stream2 (&HostDma2Stream2)
+
+/* ---------------------------------- GPIO ---------------------------------- */
+typedef struct
+{
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef enum
+{
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0                 ((uint16_t)0x0001)
+#define GPIO_PIN_1                 ((uint16_t)0x0002)
+#define GPIO_PIN_2                 ((uint16_t)0x0004)
+#define GPIO_PIN_3                 ((uint16_t)0x0008)
+#define GPIO_PIN_4                 ((uint16_t)0x0010)
+#define GPIO_PIN_5                 ((uint16_t)0x0020)
+#define GPIO_PIN_6                 ((uint16_t)0x0040)
+#define GPIO_PIN_7                 ((uint16_t)0x0080)
+#define GPIO_PIN_8                 ((uint16_t)0x0100)
+#define GPIO_PIN_9                 ((uint16_t)0x0200)
+#define GPIO_PIN_10                ((uint16_t)0x0400)
+#define GPIO_PIN_11                ((uint16_t)0x0800)
+#define GPIO_PIN_12                ((uint16_t)0x1000)
+#define GPIO_PIN_13                ((uint16_t)0x2000)
+#define GPIO_PIN_14                ((uint16_t)0x4000)
+#define GPIO_PIN_15                ((uint16_t)0x8000)
+#define GPIO_PIN_All               ((uint16_t)0xFFFF)
+
+#define GPIO_MODE_INPUT            0x00000000U
+#define GPIO_MODE_OUTPUT_PP        0x00000001U
+#define GPIO_MODE_OUTPUT_OD        0x00000011U
+#define GPIO_MODE_IT_RISING        0x10110000U
+#define GPIO_MODE_IT_FALLING       0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING 0x10310000U
+
+#define GPIO_NOPULL                0x00000000U
+#define GPIO_PULLUP                0x00000001U
+#define GPIO_PULLDOWN              0x00000002U
+
+#define GPIO_SPEED_FREQ_LOW        0x00000000U
+#define GPIO_SPEED_FREQ_MEDIUM     0x00000001U
+#define GPIO_SPEED_FREQ_HIGH       0x00000002U
+#define GPIO_SPEED_FREQ_VERY_HIGH  0x00000003U
+
+/* ---------------------------------- DMA ----------------------------------- */
+typedef struct
+{
+  uint32_t Channel;
+  uint32_t Direction;
+  uint32_t PeriphInc;
+  uint32_t MemInc;
+  uint32_t PeriphDataAlignment;
+  uint32_t MemDataAlignment;
+  uint32_t Mode;
+  uint32_t Priority;
+  uint32_t FIFOMode;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+  DMA_Stream_TypeDef            *Instance;
+  DMA_InitTypeDef               Init;
+  void                          *Parent;
+} DMA_HandleTypeDef;
+
+#define DMA_CIRCULAR               0x00000100U
+
+/* ---------------------------------- UART ---------------------------------- */
+typedef struct
+{
+  uint32_t BaudRate;
+  uint32_t WordLength;
+  uint32_t StopBits;
+  uint32_t Parity;
+  uint32_t Mode;
+  uint32_t HwFlowCtl;
+  uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef enum
+{
+  HAL_UART_STATE_RESET   = 0x00U,
+  HAL_UART_STATE_READY   = 0x20U,
+  HAL_UART_STATE_BUSY_TX = 0x21U,
+  HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+typedef uint32_t HAL_UART_RxTypeTypeDef;
+
+#define HAL_UART_RECEPTION_STANDARD 0x00000000U
+#define HAL_UART_RECEPTION_TOIDLE   0x00000001U
+
+typedef struct __UART_HandleTypeDef
+{
+  USART_TypeDef                 *Instance;
+  UART_InitTypeDef              Init;
+  uint8_t                       *pRxBuffPtr;
+  uint16_t                      RxXferSize;
+  __IO uint16_t                 RxXferCount;
+  __IO HAL_UART_RxTypeTypeDef   ReceptionType;
+  DMA_HandleTypeDef             *hdmarx;
+  __IO HAL_UART_StateTypeDef    gState;
+  __IO HAL_UART_StateTypeDef    RxState;
+  __IO uint32_t                 ErrorCode;
+} UART_HandleTypeDef;
+
+#define UART_WORDLENGTH_8B         0x00000000U
+#define UART_STOPBITS_1            0x00000000U
+#define UART_PARITY_NONE           0x00000000U
+#define UART_MODE_RX               0x00000004U
+#define UART_MODE_TX               0x00000008U
+#define UART_MODE_TX_RX            0x0000000CU
+#define UART_HWCONTROL_NONE        0x00000000U
+#define UART_OVERSAMPLING_16       0x00000000U
+
+/* ---------------------------------- TIM ----------------------------------- */
+typedef struct
+{
+  TIM_TypeDef *Instance;
+} TIM_HandleTypeDef;
+
+extern TIM_HandleTypeDef htim6;
+
+/* ------------------------------- RCC / PWR -------------------------------- */
+typedef struct
+{
+  uint32_t PLLState;
+  uint32_t PLLSource;
+  uint32_t PLLM;
+  uint32_t PLLN;
+  uint32_t PLLP;
+  uint32_t PLLQ;
+} RCC_PLLInitTypeDef;
+
+typedef struct
+{
+  uint32_t OscillatorType;
+  uint32_t HSEState;
+  uint32_t LSEState;
+  uint32_t HSIState;
+  uint32_t HSICalibrationValue;
+  uint32_t LSIState;
+  RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct
+{
+  uint32_t ClockType;
+  uint32_t SYSCLKSource;
+  uint32_t AHBCLKDivider;
+  uint32_t APB1CLKDivider;
+  uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_HSE     0x00000001U
+#define RCC_HSE_ON                 0x00000001U
+#define RCC_PLL_ON                 0x00000002U
+#define RCC_PLLSOURCE_HSE          0x00400000U
+#define RCC_PLLP_DIV2              0x00000002U
+#define RCC_CLOCKTYPE_SYSCLK       0x00000001U
+#define RCC_CLOCKTYPE_HCLK         0x00000002U
+#define RCC_CLOCKTYPE_PCLK1        0x00000004U
+#define RCC_CLOCKTYPE_PCLK2        0x00000008U
+#define RCC_SYSCLKSOURCE_PLLCLK    0x00000002U
+#define RCC_SYSCLK_DIV1            0x00000000U
+#define RCC_HCLK_DIV2              0x00001000U
+#define RCC_HCLK_DIV4              0x00001400U
+#define FLASH_LATENCY_5            0x00000005U
+#define PWR_REGULATOR_VOLTAGE_SCALE1 0x0000C000U
+
+#define __HAL_RCC_PWR_CLK_ENABLE()          do { } while (0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()        do { } while (0)
+#define __HAL_RCC_GPIOG_CLK_ENABLE()        do { } while (0)
+#define __HAL_RCC_GPIOH_CLK_ENABLE()        do { } while (0)
+#define __HAL_RCC_DMA2_CLK_ENABLE()         do { } while (0)
+#define __HAL_PWR_VOLTAGESCALING_CONFIG(__REGULATOR__)  ((void)(__REGULATOR__))
+
+/* -------------------------------- CMSIS core ------------------------------ */
+void HostHal_DisableIrq(void);
+#define __disable_irq()   HostHal_DisableIrq()
+#define __enable_irq()    do { } while (0)
+
+extern uint32_t SystemCoreClock;
+extern __IO uint32_t uwTick;
+
+/* Exported functions --------------------------------------------------------*/
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+HAL_StatusTypeDef HAL_PWREx_EnableOverDrive(void);
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+/* Host-only hooks used by host_port.c ---------------------------------------*/
+uint32_t HostHal_GetExtiLines(void);
+uint32_t HostHal_IsExtiLineEnabled(uint16_t GPIO_Pin);
+int HostHal_UartRxPending(void);
+void HostHal_UartRxByte(uint8_t Byte);
+int HostHal_UartRxDmaActive(void);
+void HostHal_UartRxDmaWrite(const uint8_t *pData, size_t Size);
+void HostHal_UartRxDmaEvent(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F4xx_HAL_H */
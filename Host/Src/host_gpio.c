@@ -0,0 +1,203 @@
+/**
+  ******************************************************************************
+  * @file           : host_gpio.c
+  * @brief          : GPIO edge recorder for the host build
+  ******************************************************************************
+  */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "host_gpio.h"
+#include "host_port.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+static HostGpioEdge_t xEdgeLog[HOST_GPIO_EDGE_LOG_SIZE];
+static atomic_uint ulEdgeHead;
+static atomic_uint ulEdgeCount[HOST_GPIO_PORT_COUNT][16];
+
+static uint64_t ullStartNs;
+static int xTrace;
+static const char *pcVcdPath;
+
+static void prvWriteVcdAtExit(void)
+{
+  int xTicks = (int)HostPort_EnvU32("HOST_VCD_TICKS", 0U);
+
+  if (HostGpio_WriteVcd(pcVcdPath, xTicks) != 0)
+  {
+    fprintf(stderr, "[host] cannot write %s\n", pcVcdPath);
+  }
+}
+
+void HostGpio_Init(void)
+{
+  ullStartNs = HostPort_TimeNs();
+  xTrace = (int)HostPort_EnvU32("HOST_GPIO_TRACE", 0U);
+
+  pcVcdPath = getenv("HOST_VCD");
+  if (pcVcdPath != NULL && pcVcdPath[0] != '\0')
+  {
+    atexit(prvWriteVcdAtExit);
+  }
+}
+
+void HostGpio_RecordEdges(uint32_t ulPort, uint32_t ulOld, uint32_t ulNew)
+{
+  uint32_t ulChanged = (ulOld ^ ulNew) & 0xFFFFU;
+  uint64_t ullNow = HostPort_TimeNs() - ullStartNs;
+  uint32_t ulTick = (uint32_t)xTaskGetTickCount();
+
+  while (ulChanged != 0U)
+  {
+    uint32_t ulPin = (uint32_t)__builtin_ctz(ulChanged);
+    unsigned int ulSlot = atomic_fetch_add_explicit(&ulEdgeHead, 1U, memory_order_relaxed);
+    HostGpioEdge_t *pxEdge = &xEdgeLog[ulSlot & (HOST_GPIO_EDGE_LOG_SIZE - 1U)];
+
+    ulChanged &= ulChanged - 1U;
+
+    pxEdge->ullTimeNs = ullNow;
+    pxEdge->ulTick = ulTick;
+    pxEdge->ucPort = (uint8_t)ulPort;
+    pxEdge->ucPin = (uint8_t)ulPin;
+    pxEdge->ucLevel = (uint8_t)((ulNew >> ulPin) & 1U);
+    atomic_fetch_add_explicit(&ulEdgeCount[ulPort][ulPin], 1U, memory_order_relaxed);
+
+    if (xTrace)
+    {
+      char cLine[80];
+      int xLen = snprintf(cLine, sizeof(cLine), "[gpio] %10lu ms  P%c%-2lu -> %u\n",
+                          (unsigned long)ulTick, (char)('A' + ulPort),
+                          (unsigned long)ulPin, (unsigned)pxEdge->ucLevel);
+
+      HostPort_Write(STDERR_FILENO, cLine, (size_t)xLen);
+    }
+  }
+}
+
+uint32_t HostGpio_GetEdgeCount(uint32_t ulPort, uint32_t ulPin)
+{
+  if (ulPort >= HOST_GPIO_PORT_COUNT || ulPin >= 16U)
+  {
+    return 0U;
+  }
+  return atomic_load_explicit(&ulEdgeCount[ulPort][ulPin], memory_order_relaxed);
+}
+
+void HostGpio_ForEachEdge(HostGpioEdgeFn_t pxFn, void *pvContext)
+{
+  unsigned int ulHead = atomic_load_explicit(&ulEdgeHead, memory_order_acquire);
+  unsigned int ulFirst = (ulHead > HOST_GPIO_EDGE_LOG_SIZE) ? (ulHead - HOST_GPIO_EDGE_LOG_SIZE) : 0U;
+  unsigned int ulIndex;
+
+  for (ulIndex = ulFirst; ulIndex != ulHead; ulIndex++)
+  {
+    pxFn(&xEdgeLog[ulIndex & (HOST_GPIO_EDGE_LOG_SIZE - 1U)], pvContext);
+  }
+}
+
+/* VCD output ----------------------------------------------------------------*/
+typedef struct
+{
+  FILE *pxFile;
+  int xTicks;
+  uint64_t ullLastTime;
+  int xStarted;
+  /* Level before the first edge still in the ring, 2 = pin never moved. */
+  uint8_t ucInitial[HOST_GPIO_PORT_COUNT][16];
+} VcdContext_t;
+
+static uint64_t prvVcdTime(const VcdContext_t *pxCtx, const HostGpioEdge_t *pxEdge)
+{
+  /* VCD only allows 1, 10 or 100 units per step: ticks are written in us. */
+  return pxCtx->xTicks ? (uint64_t)pxEdge->ulTick * (1000000U / configTICK_RATE_HZ) : pxEdge->ullTimeNs;
+}
+
+static void prvVcdFirstLevels(const HostGpioEdge_t *pxEdge, void *pvContext)
+{
+  VcdContext_t *pxCtx = pvContext;
+
+  if (pxCtx->ucInitial[pxEdge->ucPort][pxEdge->ucPin] == 2U)
+  {
+    pxCtx->ucInitial[pxEdge->ucPort][pxEdge->ucPin] = (uint8_t)(pxEdge->ucLevel ^ 1U);
+  }
+}
+
+static void prvVcdChange(const HostGpioEdge_t *pxEdge, void *pvContext)
+{
+  VcdContext_t *pxCtx = pvContext;
+  uint64_t ullTime = prvVcdTime(pxCtx, pxEdge);
+
+  /* Edges from different threads can be stored slightly out of order,
+  VCD time must never go back. */
+  if (ullTime < pxCtx->ullLastTime)
+  {
+    ullTime = pxCtx->ullLastTime;
+  }
+  if (!pxCtx->xStarted || ullTime != pxCtx->ullLastTime)
+  {
+    fprintf(pxCtx->pxFile, "#%llu\n", (unsigned long long)ullTime);
+    pxCtx->ullLastTime = ullTime;
+    pxCtx->xStarted = 1;
+  }
+  fprintf(pxCtx->pxFile, "%u%c%u\n", (unsigned)pxEdge->ucLevel, (char)('A' + pxEdge->ucPort),
+          (unsigned)pxEdge->ucPin);
+}
+
+int HostGpio_WriteVcd(const char *pcPath, int xTicks)
+{
+  static VcdContext_t xCtx;
+  uint32_t ulPort;
+  uint32_t ulPin;
+
+  memset(&xCtx, 0, sizeof(xCtx));
+  memset(xCtx.ucInitial, 2, sizeof(xCtx.ucInitial));
+  xCtx.xTicks = xTicks;
+  xCtx.pxFile = fopen(pcPath, "w");
+  if (xCtx.pxFile == NULL)
+  {
+    return -1;
+  }
+
+  HostGpio_ForEachEdge(prvVcdFirstLevels, &xCtx);
+
+  /* The identifier of a pin is its name: PG13 is "G13". */
+  fprintf(xCtx.pxFile, "$version FreeRTOS host build GPIO edges $end\n");
+  fprintf(xCtx.pxFile, "$timescale %s $end\n", xTicks ? "1us" : "1ns");
+  fprintf(xCtx.pxFile, "$scope module gpio $end\n");
+  for (ulPort = 0; ulPort < HOST_GPIO_PORT_COUNT; ulPort++)
+  {
+    for (ulPin = 0; ulPin < 16U; ulPin++)
+    {
+      if (xCtx.ucInitial[ulPort][ulPin] != 2U)
+      {
+        fprintf(xCtx.pxFile, "$var wire 1 %c%lu P%c%lu $end\n", (char)('A' + ulPort), (unsigned long)ulPin,
+                (char)('A' + ulPort), (unsigned long)ulPin);
+      }
+    }
+  }
+  fprintf(xCtx.pxFile, "$upscope $end\n$enddefinitions $end\n");
+
+  fprintf(xCtx.pxFile, "$dumpvars\n");
+  for (ulPort = 0; ulPort < HOST_GPIO_PORT_COUNT; ulPort++)
+  {
+    for (ulPin = 0; ulPin < 16U; ulPin++)
+    {
+      if (xCtx.ucInitial[ulPort][ulPin] != 2U)
+      {
+        fprintf(xCtx.pxFile, "%u%c%lu\n", (unsigned)xCtx.ucInitial[ulPort][ulPin], (char)('A' + ulPort),
+                (unsigned long)ulPin);
+      }
+    }
+  }
+  fprintf(xCtx.pxFile, "$end\n");
+
+  HostGpio_ForEachEdge(prvVcdChange, &xCtx);
+
+  return (fclose(xCtx.pxFile) == 0) ? 0 : -1;
+}
@@ -0,0 +1,371 @@
+/**
+  ******************************************************************************
+  * @file           : host_port.c
+  * @brief          : Simulated interrupts and run control for the host build
+  ******************************************************************************
+  */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "host_port.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define HOST_UART_RX_RING_SIZE   256U   /* power of two */
+
+/* Interrupt requests posted by foreign threads ------------------------------*/
+static atomic_uint ulExtiPending;
+static atomic_int  xIrqPending;
+
+static uint8_t ucRxRing[HOST_UART_RX_RING_SIZE];
+static atomic_uint ulRxHead;   /* written by the RX thread only */
+static atomic_uint ulRxTail;   /* written by the IRQ task only */
+
+static TaskHandle_t xIrqTaskHandle = NULL;
+
+/* Run control ---------------------------------------------------------------*/
+static TickType_t xExtiPeriod = 0;
+static TickType_t xNextExti = 0;
+static uint64_t ullRunTicksLeft = 0;   /* 64 bit: long runs wrap the tick count */
+static BaseType_t xRunLimited = pdFALSE;
+
+static TickType_t xLastTick = 0;
+static uint64_t ullTicksElapsed = 0;
+
+static int xFastForward = 0;
+static uint64_t ullSkippedTicks = 0;
+static uint64_t ullStartNs = 0;
+
+uint32_t HostPort_EnvU32(const char *pcName, uint32_t ulDefault)
+{
+  const char *pcValue = getenv(pcName);
+
+  if (pcValue == NULL || *pcValue == '\0')
+  {
+    return ulDefault;
+  }
+  return (uint32_t)strtoul(pcValue, NULL, 0);
+}
+
+uint64_t HostPort_EnvU64(const char *pcName, uint64_t ullDefault)
+{
+  const char *pcValue = getenv(pcName);
+
+  if (pcValue == NULL || *pcValue == '\0')
+  {
+    return ullDefault;
+  }
+  return (uint64_t)strtoull(pcValue, NULL, 0);
+}
+
+int HostPort_IsFastForward(void)
+{
+  return xFastForward;
+}
+
+uint64_t HostPort_TimeNs(void)
+{
+  struct timespec xNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &xNow);
+  return (uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec;
+}
+
+void HostPort_Write(int fd, const void *pData, size_t Size)
+{
+  const uint8_t *pucData = pData;
+
+  while (Size > 0U)
+  {
+    ssize_t xWritten = write(fd, pucData, Size);
+
+    if (xWritten < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return;
+    }
+    pucData += xWritten;
+    Size -= (size_t)xWritten;
+  }
+}
+
+void HostPort_Kick(void)
+{
+  atomic_store_explicit(&xIrqPending, 1, memory_order_release);
+}
+
+void HostPort_RaiseExti(uint16_t GPIO_Pin)
+{
+  atomic_fetch_or_explicit(&ulExtiPending, GPIO_Pin, memory_order_relaxed);
+  HostPort_Kick();
+}
+
+void HostPort_RaiseUartRx(const uint8_t *pData, size_t Size)
+{
+  unsigned int ulHead = atomic_load_explicit(&ulRxHead, memory_order_relaxed);
+
+  while (Size > 0U)
+  {
+    unsigned int ulTail = atomic_load_explicit(&ulRxTail, memory_order_acquire);
+
+    if (ulHead - ulTail == HOST_UART_RX_RING_SIZE)
+    {
+      /* Ring full: let the IRQ task drain it, like RTS flow control. */
+      HostPort_Kick();
+      usleep(1000);
+      continue;
+    }
+    ucRxRing[ulHead & (HOST_UART_RX_RING_SIZE - 1U)] = *pData++;
+    ulHead++;
+    Size--;
+    atomic_store_explicit(&ulRxHead, ulHead, memory_order_release);
+  }
+  HostPort_Kick();
+}
+
+static BaseType_t prvRxPop(uint8_t *pucByte)
+{
+  unsigned int ulTail = atomic_load_explicit(&ulRxTail, memory_order_relaxed);
+
+  if (atomic_load_explicit(&ulRxHead, memory_order_acquire) == ulTail)
+  {
+    return pdFALSE;
+  }
+  *pucByte = ucRxRing[ulTail & (HOST_UART_RX_RING_SIZE - 1U)];
+  atomic_store_explicit(&ulRxTail, ulTail + 1U, memory_order_release);
+  return pdTRUE;
+}
+
+static void *prvUartRxThread(void *pvArg)
+{
+  int fd = (int)(intptr_t)pvArg;
+  sigset_t xAll;
+  uint8_t ucBuf[64];
+
+  /* The port delivers its tick as a signal; keep it off this thread. */
+  sigfillset(&xAll);
+  pthread_sigmask(SIG_SETMASK, &xAll, NULL);
+
+  for (;;)
+  {
+    ssize_t xRead = read(fd, ucBuf, sizeof(ucBuf));
+
+    if (xRead < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (xRead <= 0)
+    {
+      break;
+    }
+    if (HostHal_UartRxDmaActive())
+    {
+      /* Circular DMA: this thread is the DMA, the end of a read() is the
+      idle line. */
+      HostHal_UartRxDmaWrite(ucBuf, (size_t)xRead);
+      HostPort_Kick();
+    }
+    else
+    {
+      HostPort_RaiseUartRx(ucBuf, (size_t)xRead);
+    }
+  }
+  return NULL;
+}
+
+void HostPort_StartUartRx(int fd)
+{
+  pthread_t xThread;
+
+  if (pthread_create(&xThread, NULL, prvUartRxThread, (void *)(intptr_t)fd) == 0)
+  {
+    pthread_detach(xThread);
+  }
+}
+
+/* The simulated NVIC --------------------------------------------------------*/
+static void prvDispatch(void)
+{
+  uint32_t ulLines = atomic_exchange_explicit(&ulExtiPending, 0U, memory_order_relaxed);
+  uint8_t ucByte;
+
+  while (ulLines != 0U)
+  {
+    uint16_t usPin = (uint16_t)(ulLines & (~ulLines + 1U));
+
+    ulLines &= ulLines - 1U;
+    if (HostHal_IsExtiLineEnabled(usPin))
+    {
+      HAL_GPIO_EXTI_IRQHandler(usPin);
+    }
+  }
+
+  /* Bytes that arrive while no reception is armed stay queued until the
+  application calls HAL_UART_Receive_IT() again. */
+  while (HostHal_UartRxPending() && prvRxPop(&ucByte))
+  {
+    HostHal_UartRxByte(ucByte);
+  }
+  HostHal_UartRxDmaEvent();
+}
+
+static TickType_t prvTicksUntil(TickType_t xNow, TickType_t xWhen)
+{
+  return ((int32_t)(xWhen - xNow) > 0) ? (TickType_t)(xWhen - xNow) : 0;
+}
+
+static void prvHostIrqTask(void *pvParameters)
+{
+  (void)pvParameters;
+  xLastTick = xTaskGetTickCount();
+  xNextExti = xLastTick + xExtiPeriod;
+
+  for (;;)
+  {
+    TickType_t xNow = xTaskGetTickCount();
+    TickType_t xWait = portMAX_DELAY;
+
+    if (xExtiPeriod != 0)
+    {
+      TickType_t xUntil = prvTicksUntil(xNow, xNextExti);
+      xWait = (xUntil < xWait) ? xUntil : xWait;
+    }
+    if (xRunLimited)
+    {
+      TickType_t xSince = (TickType_t)(xNow - xLastTick);
+      uint64_t ullLeft = (ullRunTicksLeft > xSince) ? (ullRunTicksLeft - xSince) : 0U;
+      TickType_t xUntil = (ullLeft < (uint64_t)(portMAX_DELAY / 2U)) ?
+                          (TickType_t)ullLeft : (TickType_t)(portMAX_DELAY / 2U);
+      xWait = (xUntil < xWait) ? xUntil : xWait;
+    }
+
+    ulTaskNotifyTake(pdTRUE, xWait);
+    atomic_store_explicit(&xIrqPending, 0, memory_order_relaxed);
+
+    xNow = xTaskGetTickCount();
+    {
+      TickType_t xElapsed = (TickType_t)(xNow - xLastTick);
+
+      xLastTick = xNow;
+      ullTicksElapsed += xElapsed;
+      if (xRunLimited)
+      {
+        if (ullRunTicksLeft <= xElapsed)
+        {
+          exit(EXIT_SUCCESS);
+        }
+        ullRunTicksLeft -= xElapsed;
+      }
+    }
+
+    if (xExtiPeriod != 0 && prvTicksUntil(xNow, xNextExti) == 0)
+    {
+      atomic_fetch_or_explicit(&ulExtiPending, HostHal_GetExtiLines(), memory_order_relaxed);
+      xNextExti += xExtiPeriod;
+    }
+
+    prvDispatch();
+  }
+}
+
+void vApplicationTickHook(void)
+{
+  /* TIM6 is the HAL time base on the target. */
+  HAL_TIM_PeriodElapsedCallback(&htim6);
+
+  if (xIrqTaskHandle != NULL && atomic_load_explicit(&xIrqPending, memory_order_acquire) != 0)
+  {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(xIrqTaskHandle, &xHigherPriorityTaskWoken);
+    /* The kernel picks up the pending yield when the tick handler returns. */
+    (void)xHigherPriorityTaskWoken;
+  }
+}
+
+/*
+ * Called by the idle task with the scheduler suspended when no task can run
+ * for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks. Instead of
+ * sleeping, the tick count (and the TIM6 time base) is stepped to the next
+ * wakeup, so only the order of events is simulated, not the waiting.
+ */
+void vHostSuppressTicksAndSleep(uint32_t ulExpectedIdleTime)
+{
+  TickType_t xJump = (TickType_t)ulExpectedIdleTime;
+
+  if (!xFastForward)
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  {
+    /* Nothing is delayed at all: only a real interrupt can wake a task, so
+    keep ticking in real time. The same holds while an interrupt request from
+    another thread is still waiting for the tick hook. */
+    BaseType_t xForever = ((TickType_t)(xTaskGetTickCount() + xJump) == portMAX_DELAY);
+    BaseType_t xIrq = (atomic_load_explicit(&xIrqPending, memory_order_acquire) != 0);
+
+    if (!xForever && !xIrq && eTaskConfirmSleepModeStatus() != eAbortSleep)
+    {
+      vTaskStepTick(xJump);
+      uwTick += xJump;
+      ullSkippedTicks += xJump;
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+static void prvPrintRunSummary(void)
+{
+  char cMsg[160];
+  uint64_t ullWallMs = (HostPort_TimeNs() - ullStartNs) / 1000000ULL;
+  int xLen = snprintf(cMsg, sizeof(cMsg),
+                      "[host] %llu ticks simulated (%llu fast-forwarded) in %llu ms wall time\n",
+                      (unsigned long long)(ullTicksElapsed + (TickType_t)(xTaskGetTickCount() - xLastTick)),
+                      (unsigned long long)ullSkippedTicks, (unsigned long long)ullWallMs);
+
+  HostPort_Write(STDERR_FILENO, cMsg, (size_t)xLen);
+}
+
+void vHostAssertCalled(const char *pcFile, unsigned long ulLine)
+{
+  char cMsg[256];
+  int xLen = snprintf(cMsg, sizeof(cMsg), "configASSERT failed: %s:%lu\n", pcFile, ulLine);
+
+  HostPort_Write(STDERR_FILENO, cMsg, (size_t)xLen);
+  abort();
+}
+
+void HostPort_Init(void)
+{
+  uint64_t ullRunMs = HostPort_EnvU64("HOST_RUN_MS", 0U);
+
+  ullStartNs = HostPort_TimeNs();
+  xExtiPeriod = pdMS_TO_TICKS(HostPort_EnvU32("HOST_EXTI_PERIOD_MS", 0U));
+  xRunLimited = (ullRunMs != 0U) ? pdTRUE : pdFALSE;
+  ullRunTicksLeft = (ullRunMs * configTICK_RATE_HZ) / 1000U;
+  xFastForward = (int)HostPort_EnvU32("HOST_FAST_FORWARD", 0U);
+
+  if (xFastForward)
+  {
+    atexit(prvPrintRunSummary);
+  }
+
+  xTaskCreate(prvHostIrqTask, "IRQ", configMINIMAL_STACK_SIZE * 2, NULL,
+              configHOST_IRQ_TASK_PRIORITY, &xIrqTaskHandle);
+}
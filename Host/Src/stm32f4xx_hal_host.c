@@ -0,0 +1,398 @@
+/**
+  ******************************************************************************
+  * @file           : stm32f4xx_hal_host.c
+  * @brief          : Host stand-in for the STM32F4 HAL
+  ******************************************************************************
+  * @attention
+  *
+  * UART1 TX goes to stdout (or the pty selected with HOST_UART=pty), RX bytes
+  * are delivered through HAL_UART_RxCpltCallback() by the simulated interrupt
+  * task, and every GPIO output change is recorded as a timestamped edge.
+  *
+  * HAL_UARTEx_ReceiveToIdle_DMA() in circular mode is simulated by the stdin
+  * reader thread: it is the "DMA" and stores the bytes straight into the
+  * application's buffer, the interrupt task then reports the new position
+  * through HAL_UARTEx_RxEventCallback(), at the half / full buffer boundaries
+  * and once at the end of every read() (the "idle line").
+  *
+  ******************************************************************************
+  */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "host_port.h"
+#include "host_gpio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Peripheral "registers" ----------------------------------------------------*/
+GPIO_TypeDef  HostGpioPorts[HOST_GPIO_PORT_COUNT];
+USART_TypeDef HostUsart1;
+TIM_TypeDef   HostTim6;
+DMA_Stream_TypeDef HostDma2Stream2;
+
+TIM_HandleTypeDef htim6 = { .Instance = TIM6 };
+
+uint32_t SystemCoreClock = 180000000U;
+__IO uint32_t uwTick;
+
+static uint32_t ulExtiLines;        /* pins configured as GPIO_MODE_IT_xxx */
+static uint8_t  ucNvicEnabled[HOST_IRQn_COUNT];
+
+static UART_HandleTypeDef *pxUart1 = NULL;
+static int xUartFd = STDOUT_FILENO;
+
+/* Circular DMA reception: bytes stored by the RX thread and bytes reported
+to the application, both free running. */
+static atomic_int  xRxDmaActive;
+static atomic_uint ulRxDmaWritten;    /* RX thread only */
+static atomic_uint ulRxDmaReported;   /* IRQ task only */
+
+/* CMSIS / core --------------------------------------------------------------*/
+void HostHal_DisableIrq(void)
+{
+  static const char cMsg[] = "Error_Handler() reached, stopping host run\n";
+
+  HostPort_Write(STDERR_FILENO, cMsg, sizeof(cMsg) - 1U);
+  exit(EXIT_FAILURE);
+}
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+  HostGpio_Init();
+  HostPort_Init();
+  return HAL_OK;
+}
+
+void HAL_IncTick(void)
+{
+  uwTick += 1U;
+}
+
+uint32_t HAL_GetTick(void)
+{
+  return uwTick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+  uint32_t tickstart = HAL_GetTick();
+
+  while ((HAL_GetTick() - tickstart) < Delay)
+  {
+  }
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+  (void)RCC_OscInitStruct;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+  (void)RCC_ClkInitStruct;
+  (void)FLatency;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_PWREx_EnableOverDrive(void)
+{
+  return HAL_OK;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+  (void)IRQn;
+  (void)PreemptPriority;
+  (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+  if ((uint32_t)IRQn < HOST_IRQn_COUNT)
+  {
+    ucNvicEnabled[IRQn] = 1U;
+  }
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+  if ((uint32_t)IRQn < HOST_IRQn_COUNT)
+  {
+    ucNvicEnabled[IRQn] = 0U;
+  }
+}
+
+/* GPIO ----------------------------------------------------------------------*/
+static IRQn_Type prvExtiIrqn(uint16_t GPIO_Pin)
+{
+  uint32_t ulLine = (uint32_t)__builtin_ctz(GPIO_Pin);
+
+  if (ulLine <= 4U)
+  {
+    return (IRQn_Type)(EXTI0_IRQn + (int)ulLine);
+  }
+  return (ulLine <= 9U) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+  if ((GPIO_Init->Mode & 0x10000000U) != 0U)
+  {
+    ulExtiLines |= GPIO_Init->Pin;
+  }
+  (void)GPIOx;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  return ((GPIOx->IDR | GPIOx->ODR) & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  uint32_t odr = GPIOx->ODR;
+  uint32_t next = (PinState != GPIO_PIN_RESET) ? (odr | GPIO_Pin) : (odr & ~(uint32_t)GPIO_Pin);
+
+  GPIOx->ODR = next;
+  HostGpio_RecordEdges((uint32_t)(GPIOx - HostGpioPorts), odr, next);
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  uint32_t odr = GPIOx->ODR;
+  uint32_t next = odr ^ GPIO_Pin;
+
+  GPIOx->ODR = next;
+  HostGpio_RecordEdges((uint32_t)(GPIOx - HostGpioPorts), odr, next);
+}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin)
+{
+  HAL_GPIO_EXTI_Callback(GPIO_Pin);
+}
+
+__weak void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  (void)GPIO_Pin;
+}
+
+uint32_t HostHal_GetExtiLines(void)
+{
+  return ulExtiLines;
+}
+
+uint32_t HostHal_IsExtiLineEnabled(uint16_t GPIO_Pin)
+{
+  return ((ulExtiLines & GPIO_Pin) != 0U) && (ucNvicEnabled[prvExtiIrqn(GPIO_Pin)] != 0U);
+}
+
+/* UART ----------------------------------------------------------------------*/
+static int prvOpenPty(void)
+{
+  struct termios xTio;
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+  {
+    return -1;
+  }
+  if (tcgetattr(fd, &xTio) == 0)
+  {
+    cfmakeraw(&xTio);
+    tcsetattr(fd, TCSANOW, &xTio);
+  }
+  fprintf(stderr, "USART1 is on %s\n", ptsname(fd));
+  return fd;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+  const char *pcMode = getenv("HOST_UART");
+  int xRxFd = STDIN_FILENO;
+
+  if (huart->Instance != USART1)
+  {
+    return HAL_ERROR;
+  }
+
+  if (pcMode != NULL && strcmp(pcMode, "pty") == 0)
+  {
+    int fd = prvOpenPty();
+
+    if (fd < 0)
+    {
+      return HAL_ERROR;
+    }
+    xUartFd = fd;
+    xRxFd = fd;
+  }
+
+  huart->gState = HAL_UART_STATE_READY;
+  huart->RxState = HAL_UART_STATE_READY;
+  pxUart1 = huart;
+  HostPort_StartUartRx(xRxFd);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  (void)Timeout;
+
+  if (huart->gState != HAL_UART_STATE_READY)
+  {
+    return HAL_BUSY;
+  }
+  huart->gState = HAL_UART_STATE_BUSY_TX;
+  HostPort_Write(xUartFd, pData, Size);
+  huart->gState = HAL_UART_STATE_READY;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+  if (huart->RxState != HAL_UART_STATE_READY || pData == NULL || Size == 0U)
+  {
+    return HAL_BUSY;
+  }
+  huart->pRxBuffPtr = pData;
+  huart->RxXferSize = Size;
+  huart->RxXferCount = Size;
+  huart->RxState = HAL_UART_STATE_BUSY_RX;
+
+  /* Deliver bytes that were typed while reception was not armed. */
+  HostPort_Kick();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+  if (huart->RxState != HAL_UART_STATE_READY || pData == NULL || Size == 0U)
+  {
+    return HAL_BUSY;
+  }
+  /* Only armed once on the host: the transfer never stops by itself, there
+  are no line errors to abort it. */
+  if (atomic_load_explicit(&xRxDmaActive, memory_order_relaxed) != 0)
+  {
+    return HAL_ERROR;
+  }
+  huart->pRxBuffPtr = pData;
+  huart->RxXferSize = Size;
+  huart->RxXferCount = Size;
+  huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+  huart->RxState = HAL_UART_STATE_BUSY_RX;
+  atomic_store_explicit(&xRxDmaActive, 1, memory_order_release);
+  return HAL_OK;
+}
+
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+  (void)huart;
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  (void)huart;
+}
+
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  (void)huart;
+  (void)Size;
+}
+
+int HostHal_UartRxPending(void)
+{
+  return (pxUart1 != NULL) && (pxUart1->RxState == HAL_UART_STATE_BUSY_RX) &&
+         (atomic_load_explicit(&xRxDmaActive, memory_order_acquire) == 0);
+}
+
+void HostHal_UartRxByte(uint8_t Byte)
+{
+  UART_HandleTypeDef *huart = pxUart1;
+
+  *huart->pRxBuffPtr++ = Byte;
+  if (--huart->RxXferCount == 0U)
+  {
+    huart->RxState = HAL_UART_STATE_READY;
+    HAL_UART_RxCpltCallback(huart);
+  }
+}
+
+int HostHal_UartRxDmaActive(void)
+{
+  return atomic_load_explicit(&xRxDmaActive, memory_order_acquire);
+}
+
+void HostHal_UartRxDmaWrite(const uint8_t *pData, size_t Size)
+{
+  UART_HandleTypeDef *huart = pxUart1;
+  unsigned int ulWritten = atomic_load_explicit(&ulRxDmaWritten, memory_order_relaxed);
+
+  while (Size > 0U)
+  {
+    unsigned int ulReported = atomic_load_explicit(&ulRxDmaReported, memory_order_acquire);
+
+    if (ulWritten - ulReported >= (huart->RxXferSize + 1U) / 2U)
+    {
+      /* The real DMA would raise HT / TC here, wait until the interrupt task
+      has reported it so no event covers more than half the buffer. */
+      HostPort_Kick();
+      usleep(1000);
+      continue;
+    }
+    huart->pRxBuffPtr[ulWritten % huart->RxXferSize] = *pData++;
+    ulWritten++;
+    Size--;
+    atomic_store_explicit(&ulRxDmaWritten, ulWritten, memory_order_release);
+  }
+}
+
+void HostHal_UartRxDmaEvent(void)
+{
+  UART_HandleTypeDef *huart = pxUart1;
+  unsigned int ulWritten = atomic_load_explicit(&ulRxDmaWritten, memory_order_acquire);
+  unsigned int ulReported = atomic_load_explicit(&ulRxDmaReported, memory_order_relaxed);
+
+  if (!HostHal_UartRxDmaActive())
+  {
+    return;
+  }
+
+  while (ulReported != ulWritten)
+  {
+    uint16_t usOffset = (uint16_t)(ulReported % huart->RxXferSize);
+    uint16_t usBoundary = (usOffset < huart->RxXferSize / 2U) ? (uint16_t)(huart->RxXferSize / 2U) : huart->RxXferSize;
+    unsigned int ulStep = usBoundary - usOffset;
+
+    if (ulWritten - ulReported < ulStep)
+    {
+      ulStep = ulWritten - ulReported;       /* idle line */
+    }
+    ulReported += ulStep;
+    atomic_store_explicit(&ulRxDmaReported, ulReported, memory_order_release);
+
+    huart->RxXferCount = (uint16_t)(huart->RxXferSize - (usOffset + ulStep));
+    HAL_UARTEx_RxEventCallback(huart, (uint16_t)(usOffset + ulStep));
+  }
+}
+
+/* TIM -----------------------------------------------------------------------*/
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+}
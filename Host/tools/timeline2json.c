@@ -0,0 +1,248 @@
+/*
+ * Converts a timeline recording (Common/Inc/timeline.h) to Chrome trace JSON,
+ * for chrome://tracing or https://ui.perfetto.dev.
+ *
+ *   HOST_TRACE=counting.trace HOST_RUN_MS=5000 ./build/Semaphore/Counting/Counting
+ *   ./build/timeline2json counting.trace > counting.json
+ *
+ * One track per task (the slices are the times it was running), one track
+ * for interrupts marked with vTimelineIsrEnter() / vTimelineIsrExit(), kernel
+ * events as instants on the track of the task or interrupt that caused them,
+ * and one counter per queue / semaphore with the number of items.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timeline.h"
+
+#define ISR_TID        0U
+#define MAX_TASKS      256U
+
+typedef struct
+{
+  const char *pcName;
+  int xCounter;        /* +1 send, -1 receive: emit an item counter */
+  int xFromIsr;
+} EventInfo_t;
+
+static const EventInfo_t xInfo[TIMELINE_EVENT_COUNT] = {
+  [TIMELINE_QUEUE_SEND]                    = { "send",                  1, 0 },
+  [TIMELINE_QUEUE_SEND_FAILED]             = { "send failed",           0, 0 },
+  [TIMELINE_QUEUE_SEND_FROM_ISR]           = { "send from ISR",         1, 1 },
+  [TIMELINE_QUEUE_SEND_FROM_ISR_FAILED]    = { "send from ISR failed",  0, 1 },
+  [TIMELINE_QUEUE_BLOCK_SEND]              = { "block on send",         0, 0 },
+  [TIMELINE_QUEUE_RECEIVE]                 = { "receive",              -1, 0 },
+  [TIMELINE_QUEUE_RECEIVE_FAILED]          = { "receive failed",        0, 0 },
+  [TIMELINE_QUEUE_RECEIVE_FROM_ISR]        = { "receive from ISR",     -1, 1 },
+  [TIMELINE_QUEUE_RECEIVE_FROM_ISR_FAILED] = { "receive from ISR failed", 0, 1 },
+  [TIMELINE_QUEUE_BLOCK_RECEIVE]           = { "block on receive",      0, 0 },
+  [TIMELINE_EVENT_SET]                     = { "set bits",              0, 0 },
+  [TIMELINE_EVENT_SET_FROM_ISR]            = { "set bits from ISR",     0, 1 },
+  [TIMELINE_EVENT_WAIT_BLOCK]              = { "block on wait bits",    0, 0 },
+  [TIMELINE_EVENT_WAIT_END]                = { "wait bits end",         0, 0 },
+  [TIMELINE_EVENT_SYNC_BLOCK]              = { "block on sync",         0, 0 },
+  [TIMELINE_EVENT_SYNC_END]                = { "sync end",              0, 0 },
+  [TIMELINE_STREAM_SEND]                   = { "send",                  0, 0 },
+  [TIMELINE_STREAM_SEND_FAILED]            = { "send failed",           0, 0 },
+  [TIMELINE_STREAM_SEND_FROM_ISR]          = { "send from ISR",         0, 1 },
+  [TIMELINE_STREAM_BLOCK_SEND]             = { "block on send",         0, 0 },
+  [TIMELINE_STREAM_RECEIVE]                = { "receive",               0, 0 },
+  [TIMELINE_STREAM_RECEIVE_FAILED]         = { "receive failed",        0, 0 },
+  [TIMELINE_STREAM_RECEIVE_FROM_ISR]       = { "receive from ISR",      0, 1 },
+  [TIMELINE_STREAM_BLOCK_RECEIVE]          = { "block on receive",      0, 0 },
+};
+
+static TimelineName_t *pxNames;
+static uint32_t ulNames;
+static int xFirstEvent = 1;
+
+static const char *prvName(uint32_t ulId, uint8_t ucIsTask)
+{
+  static char cUnnamed[2][24];
+  uint32_t i;
+
+  for (i = 0; i < ulNames; i++)
+  {
+    if (pxNames[i].ulId == ulId && pxNames[i].ucIsTask == ucIsTask)
+    {
+      return pxNames[i].cName;
+    }
+  }
+  snprintf(cUnnamed[ucIsTask], sizeof(cUnnamed[0]), ucIsTask ? "task %lu" : "0x%08lx", (unsigned long)ulId);
+  return cUnnamed[ucIsTask];
+}
+
+/* Opens the next element of traceEvents. */
+static void prvBegin(void)
+{
+  printf(xFirstEvent ? "\n  {" : ",\n  {");
+  xFirstEvent = 0;
+}
+
+static void prvTs(unsigned long long ullNs)
+{
+  printf("\"ts\":%llu.%03llu", ullNs / 1000ULL, ullNs % 1000ULL);
+}
+
+static void prvSlice(char cPhase, uint32_t ulTid, const char *pcName, unsigned long long ullNs)
+{
+  prvBegin();
+  printf("\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%lu,", pcName, cPhase, (unsigned long)ulTid);
+  prvTs(ullNs);
+  printf("}");
+}
+
+int main(int argc, char **argv)
+{
+  TimelineHeader_t xHeader;
+  TimelineRecord_t xRecord;
+  static unsigned char ucOpen[MAX_TASKS];
+  unsigned long long ullCounts = 0;
+  unsigned long long ullNs = 0;
+  uint32_t ulPrev = 0;
+  uint32_t ulIsrDepth = 0;
+  uint32_t i;
+  FILE *pxIn;
+
+  if (argc != 2)
+  {
+    fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+    return 2;
+  }
+  pxIn = fopen(argv[1], "rb");
+  if (pxIn == NULL || fread(&xHeader, sizeof(xHeader), 1, pxIn) != 1 ||
+      memcmp(xHeader.cMagic, "FRTL", 4) != 0 || xHeader.usVersion != TIMELINE_VERSION ||
+      xHeader.usRecordSize != sizeof(TimelineRecord_t) || xHeader.ulCounterHz == 0U)
+  {
+    fprintf(stderr, "%s: not a timeline recording (version %u)\n", argv[1], TIMELINE_VERSION);
+    return 1;
+  }
+
+  ulNames = xHeader.ulNames;
+  pxNames = calloc(ulNames ? ulNames : 1U, sizeof(TimelineName_t));
+  if (pxNames == NULL || fread(pxNames, sizeof(TimelineName_t), ulNames, pxIn) != ulNames)
+  {
+    fprintf(stderr, "%s: truncated name table\n", argv[1]);
+    return 1;
+  }
+  for (i = 0; i < ulNames; i++)
+  {
+    pxNames[i].cName[TIMELINE_NAME_LEN - 1U] = '\0';
+  }
+
+  printf("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"records\":%lu,\"overwritten\":%lu},\"traceEvents\":[",
+         (unsigned long)xHeader.ulRecords, (unsigned long)xHeader.ulOverwritten);
+
+  prvBegin();
+  printf("\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"FreeRTOS\"}}");
+  prvBegin();
+  printf("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"ISR\"}}", ISR_TID);
+  for (i = 0; i < ulNames; i++)
+  {
+    if (pxNames[i].ucIsTask)
+    {
+      prvBegin();
+      printf("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+             (unsigned long)pxNames[i].ulId, pxNames[i].cName);
+    }
+  }
+
+  for (i = 0; i < xHeader.ulRecords && fread(&xRecord, sizeof(xRecord), 1, pxIn) == 1; i++)
+  {
+    const EventInfo_t *pxInfo;
+    uint32_t ulTid;
+
+    /* The recorder guarantees less than 2^31 counts between two records. */
+    if (i != 0U)
+    {
+      ullCounts += (uint32_t)(xRecord.ulTime - ulPrev);
+    }
+    ulPrev = xRecord.ulTime;
+    ullNs = (ullCounts / xHeader.ulCounterHz) * 1000000000ULL +
+            ((ullCounts % xHeader.ulCounterHz) * 1000000000ULL) / xHeader.ulCounterHz;
+
+    switch (xRecord.ucEvent)
+    {
+      case TIMELINE_SYNC:
+        break;
+
+      case TIMELINE_TASK_IN:
+        if (xRecord.ulObject < MAX_TASKS)
+        {
+          prvSlice('B', xRecord.ulObject, prvName(xRecord.ulObject, 1U), ullNs);
+          ucOpen[xRecord.ulObject] = 1U;
+        }
+        break;
+
+      case TIMELINE_TASK_OUT:
+        /* The ring may start in the middle of a slice. */
+        if (xRecord.ulObject < MAX_TASKS && ucOpen[xRecord.ulObject])
+        {
+          prvSlice('E', xRecord.ulObject, prvName(xRecord.ulObject, 1U), ullNs);
+          ucOpen[xRecord.ulObject] = 0U;
+        }
+        break;
+
+      case TIMELINE_ISR_ENTER:
+      {
+        char cName[24];
+
+        snprintf(cName, sizeof(cName), "IRQ %u", (unsigned)xRecord.usValue);
+        prvSlice('B', ISR_TID, cName, ullNs);
+        ulIsrDepth++;
+        break;
+      }
+
+      case TIMELINE_ISR_EXIT:
+        if (ulIsrDepth != 0U)
+        {
+          prvSlice('E', ISR_TID, "IRQ", ullNs);
+          ulIsrDepth--;
+        }
+        break;
+
+      default:
+        if (xRecord.ucEvent >= TIMELINE_EVENT_COUNT || xInfo[xRecord.ucEvent].pcName == NULL)
+        {
+          break;
+        }
+        pxInfo = &xInfo[xRecord.ucEvent];
+        ulTid = (pxInfo->xFromIsr && ulIsrDepth != 0U) ? ISR_TID : xRecord.ucTask;
+
+        prvBegin();
+        printf("\"name\":\"%s %s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%lu,", pxInfo->pcName,
+               prvName(xRecord.ulObject, 0U), (unsigned long)ulTid);
+        prvTs(ullNs);
+        printf(",\"args\":{\"value\":%u}}", (unsigned)xRecord.usValue);
+
+        if (pxInfo->xCounter != 0)
+        {
+          prvBegin();
+          printf("\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,", prvName(xRecord.ulObject, 0U));
+          prvTs(ullNs);
+          printf(",\"args\":{\"items\":%d}}", (int)xRecord.usValue + pxInfo->xCounter);
+        }
+        break;
+    }
+  }
+
+  /* Close what was still running at the end of the recording. */
+  for (i = 0; i < MAX_TASKS; i++)
+  {
+    if (ucOpen[i])
+    {
+      prvSlice('E', i, prvName(i, 1U), ullNs);
+    }
+  }
+  for (; ulIsrDepth != 0U; ulIsrDepth--)
+  {
+    prvSlice('E', ISR_TID, "IRQ", ullNs);
+  }
+
+  printf("\n]}\n");
+  fclose(pxIn);
+  free(pxNames);
+  return 0;
+}
@@ -0,0 +1,456 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+#include "string.h"
+#include "stdio.h"
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "latency_hist.h"
+#include "block_pool.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Allocation cost: pvPortMalloc(100)/vPortFree (heap_4) against
+ * pvBlockPoolAlloc/vBlockPoolFree, the pattern SimpleQueue and the
+ * Message_Buffers examples use for every log line.
+ *
+ *   heap_4 empty       the heap holds nothing else, the free list has 1 entry
+ *   heap_4 fragmented  half of the 15360 byte heap is in use by blocks of
+ *                      mixed size with free holes between them, the way a
+ *                      long running application looks
+ *   block pool         fixed 100 byte blocks, static storage
+ *
+ * Each call is timed on its own with the perf counter; the counter overhead
+ * (two back to back reads) is subtracted.
+ */
+
+#define BENCH_ITERATIONS   1000U
+#define BENCH_SIZE         100U   // what the examples allocate per log line
+#define BENCH_FRAGMENTS    48U
+
+BLOCK_POOL_STORAGE(PoolBlocks, BENCH_SIZE, 4);
+BlockPool_t Pool;
+
+static void* fragments[BENCH_FRAGMENTS];
+
+static LatencyHist_t allocHist;
+static LatencyHist_t freeHist;
+static uint32_t counterOverhead;
+
+static char line[128];
+
+/* ******************* TASK HANDLERS ******************* */
+xTaskHandle Bench_Handle;
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+static uint32_t Bench_Elapsed(uint32_t start, uint32_t end)
+{
+	uint32_t counts = end - start;
+	return (counts > counterOverhead) ? (counts - counterOverhead) : 0;
+}
+
+static void Bench_Report(const char* name)
+{
+	HeapStats_t stats;
+	vPortGetHeapStats(&stats);
+
+	sprintf(line, "%-18s alloc %6lu %6lu %6lu   free %6lu %6lu %6lu   heap free blocks %lu\n", name,
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&allocHist, 500)),
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&allocHist, 990)),
+			(unsigned long)ulPerfCounterToNs(allocHist.ulMax),
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&freeHist, 500)),
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&freeHist, 990)),
+			(unsigned long)ulPerfCounterToNs(freeHist.ulMax),
+			(unsigned long)stats.xNumberOfFreeBlocks);
+	Bench_Print(line);
+}
+
+static void Bench_Heap4(const char* name)
+{
+	vLatencyHistReset(&allocHist);
+	vLatencyHistReset(&freeHist);
+
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		uint32_t t0 = ulPerfCounterGet();
+		char* str = (char*) pvPortMalloc(BENCH_SIZE);
+		uint32_t t1 = ulPerfCounterGet();
+		str[0] = 0;
+		uint32_t t2 = ulPerfCounterGet();
+		vPortFree(str);
+		uint32_t t3 = ulPerfCounterGet();
+
+		vLatencyHistAdd(&allocHist, Bench_Elapsed(t0, t1));
+		vLatencyHistAdd(&freeHist, Bench_Elapsed(t2, t3));
+	}
+	Bench_Report(name);
+}
+
+static void Bench_Pool(const char* name)
+{
+	vLatencyHistReset(&allocHist);
+	vLatencyHistReset(&freeHist);
+
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		uint32_t t0 = ulPerfCounterGet();
+		char* str = (char*) pvBlockPoolAlloc(&Pool);
+		uint32_t t1 = ulPerfCounterGet();
+		str[0] = 0;
+		uint32_t t2 = ulPerfCounterGet();
+		vBlockPoolFree(&Pool, str);
+		uint32_t t3 = ulPerfCounterGet();
+
+		vLatencyHistAdd(&allocHist, Bench_Elapsed(t0, t1));
+		vLatencyHistAdd(&freeHist, Bench_Elapsed(t2, t3));
+	}
+	Bench_Report(name);
+}
+
+/* Fill about half of the free heap with blocks of 16..208 bytes, then free
+every other one so the free list is full of holes. */
+static void Bench_Fragment(void)
+{
+	size_t budget = xPortGetFreeHeapSize() / 2;
+	uint32_t seed = 12345;
+
+	for (uint32_t i = 0; i < BENCH_FRAGMENTS; i++) {
+		size_t size;
+		seed = seed * 1103515245U + 12345U;
+		size = 16 + ((seed >> 16) % 13) * 16;
+		fragments[i] = (size < budget) ? pvPortMalloc(size) : NULL;
+		budget = (fragments[i] != NULL) ? budget - size : 0;
+	}
+	for (uint32_t i = 0; i < BENCH_FRAGMENTS; i += 2) {
+		vPortFree(fragments[i]);
+		fragments[i] = NULL;
+	}
+}
+
+static void Bench_Defragment(void)
+{
+	for (uint32_t i = 0; i < BENCH_FRAGMENTS; i++) {
+		vPortFree(fragments[i]);
+		fragments[i] = NULL;
+	}
+}
+
+/* ******************* TASK FUNCTIONS ******************* */
+void Bench_Task(void* argument)
+{
+	uint32_t t0 = ulPerfCounterGet();
+	uint32_t t1 = ulPerfCounterGet();
+	counterOverhead = t1 - t0;
+
+	sprintf(line, "\nAllocation cost, %u calls of %u bytes, ns (p50 p99 max), configTOTAL_HEAP_SIZE %u\n",
+			(unsigned)BENCH_ITERATIONS, (unsigned)BENCH_SIZE, (unsigned)configTOTAL_HEAP_SIZE);
+	Bench_Print(line);
+
+	Bench_Heap4("heap_4 empty");
+
+	Bench_Fragment();
+	Bench_Heap4("heap_4 fragmented");
+	Bench_Defragment();
+
+	Bench_Pool("block pool");
+
+	sprintf(line, "heap free %u bytes, minimum ever %u bytes\n",
+			(unsigned)xPortGetFreeHeapSize(), (unsigned)xPortGetMinimumEverFreeHeapSize());
+	Bench_Print(line);
+
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+  vBlockPoolInit(&Pool, PoolBlocks, BENCH_SIZE, 4);
+  /* USER CODE END 2 */
+
+  /* ********************* Create Tasks ********************* */
+  xTaskCreate(Bench_Task, "Bench", 512, NULL, 2, &Bench_Handle);
+
+  vTaskStartScheduler(); // This function will never return unless RTOS scheduler stops
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
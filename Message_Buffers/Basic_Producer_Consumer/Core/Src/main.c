@@ -27,6 +27,10 @@
 #include "stdio.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "uart_log.h"
+#include "block_pool.h"
+#include "perf_counter.h"
+#include "queue_metrics.h"
 
 /* USER CODE END Includes */
 
@@ -71,6 +75,20 @@ MessageBufferHandle_t MessageBuffer_Handle;
 TaskHandle_t Producer_Handle;
 TaskHandle_t Consumer_Handle;
 
+/* *********************** Log Line Pool *********************************** */
+#define LOG_LINE_SIZE   100
+#define LOG_LINES       2 // Producer + Consumer
+
+BLOCK_POOL_STORAGE(LogLines, LOG_LINE_SIZE, LOG_LINES);
+BlockPool_t LogPool;
+
+#define METRICS_EVERY   20 // messages between two metrics dumps
+
+void PrintLine(const char *line)
+{
+	xUartLogWrite(line, strlen(line));
+}
+
 /* *********************** Task Functions ********************************** */
 void Producer(void* pv)
 {
@@ -82,15 +100,15 @@ void Producer(void* pv)
 		size_t len = strlen(msgs[i]);
 		if (xMessageBufferSend(MessageBuffer_Handle, (void* )msgs[i], len, pdMS_TO_TICKS(100)) != len) {
 			// Error
-			HAL_UART_Transmit(&huart1, (uint8_t *)"Message Buffer Send Failed\r\n", 21, HAL_MAX_DELAY);
+			xUartLogPrintf("Message Buffer Send Failed\r\n");
 		}else {
 
 			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13);
 
-			char* msg = (char*) pvPortMalloc(100 * sizeof(char)); // Allocate memory from the heap
+			char* msg = (char*) pvBlockPoolAlloc(&LogPool); // O(1), no heap fragmentation
 			sprintf(msg, "Message Sent: %s\r\n", msgs[i]);
-			HAL_UART_Transmit(&huart1, (uint8_t *)msg, strlen(msg), HAL_MAX_DELAY);
-			vPortFree(msg); // Free the allocated memory
+			xUartLogWrite(msg, strlen(msg));
+			vBlockPoolFree(&LogPool, msg); // Return the line to the pool
 		}
 
 		i = (i+1) % (sizeof(msgs)/sizeof(msgs[0]));
@@ -102,19 +120,23 @@ void Producer(void* pv)
 void Consumer(void* pv)
 {
 	uint8_t rxBuffer[100];
+	uint32_t count = 0;
 	for (;;)
 	{
 		size_t received = xMessageBufferReceive(MessageBuffer_Handle, (void* )rxBuffer, sizeof(rxBuffer), portMAX_DELAY);
 
 		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
 
-		char* msg = (char*) pvPortMalloc(100 * sizeof(char)); // Allocate memory from the heap
+		char* msg = (char*) pvBlockPoolAlloc(&LogPool); // O(1), no heap fragmentation
 
 		sprintf(msg, "Message Received: %.*s\n", (int)received, rxBuffer);
 
-		HAL_UART_Transmit(&huart1, (uint8_t *)msg, strlen(msg), HAL_MAX_DELAY);
-		vPortFree(msg); // Free the allocated memory
+		xUartLogWrite(msg, strlen(msg));
+		vBlockPoolFree(&LogPool, msg); // Return the line to the pool
 
+		if (++count % METRICS_EVERY == 0) {
+			vQueueMetricsDump(PrintLine); // levels, waits and failures of MessageBuffer_Handle
+		}
 	}
 }
 
@@ -153,6 +175,8 @@ int main(void)
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
 
+  vPerfCounterInit(); // clock of the wait times
+
   /* *********************** Create Message Buffer ************************** */
   MessageBuffer_Handle = xMessageBufferCreate(256); // 256 bytes buffer (Total buffer size bytes)
 
@@ -162,11 +186,15 @@ int main(void)
   }
   else{
 	HAL_UART_Transmit(&huart1, (uint8_t*) "Message Buffer Created Successfully\n", 37, HAL_MAX_DELAY);
+	xQueueMetricsAddStreamBuffer(MessageBuffer_Handle, "MessageBuffer");
   }
 
   /* *********************** Create Tasks ********************************** */
+  vBlockPoolInit(&LogPool, LogLines, LOG_LINE_SIZE, LOG_LINES);
+  xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
   xTaskCreate(Producer, "Producer", 256, NULL, 2, &Producer_Handle);
   xTaskCreate(Consumer, "Consumer", 256, NULL, 1, &Consumer_Handle);
+  xQueueMetricsStartSampler(pdMS_TO_TICKS(100), 3); // above Producer and Consumer
 
   /* *********************** Start Scheduler ******************************* */
   vTaskStartScheduler();
@@ -27,6 +27,8 @@
 #include "stdio.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "uart_log.h"
+#include "block_pool.h"
 
 /* USER CODE END Includes */
 
@@ -69,6 +71,13 @@ MessageBufferHandle_t MessageBuffer_Handle;
 /* ***************************** Task Handles *************************** */
 TaskHandle_t Consumer_Handle;
 
+/* ***************************** Log Line Pool *************************** */
+#define LOG_LINE_SIZE   100
+#define LOG_LINES       1 // Consumer only
+
+BLOCK_POOL_STORAGE(LogLines, LOG_LINE_SIZE, LOG_LINES);
+BlockPool_t LogPool;
+
 /* ***************************** Task Functions *************************** */
 void Consumer(void *pvParameters)
 {
@@ -77,10 +86,10 @@ void Consumer(void *pvParameters)
 		size_t received = xMessageBufferReceive(MessageBuffer_Handle, rx, sizeof(rx), portMAX_DELAY);
 		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13); // consume marker
 
-		char* msg = (char*)pvPortMalloc(100 * sizeof(char));
+		char* msg = (char*)pvBlockPoolAlloc(&LogPool); // O(1), no heap fragmentation
 		sprintf(msg, "Consumer recv %.*s\n", (int)received, rx);
-		HAL_UART_Transmit(&huart1, (uint8_t *)msg, strlen(msg), HAL_MAX_DELAY);
-		vPortFree(msg); // Free the allocated memory
+		xUartLogWrite(msg, strlen(msg));
+		vBlockPoolFree(&LogPool, msg); // Return the line to the pool
   }
 }
 
@@ -144,6 +153,8 @@ int main(void)
   }
 
   /* ********************** Create Task ******************************** */
+  vBlockPoolInit(&LogPool, LogLines, LOG_LINE_SIZE, LOG_LINES);
+  xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
   xTaskCreate(Consumer, "Consumer", 128, NULL, 1, &Consumer_Handle);
 
   vTaskStartScheduler();
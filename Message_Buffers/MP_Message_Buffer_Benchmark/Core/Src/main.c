@@ -0,0 +1,466 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "message_buffer.h"
+#include "semphr.h"
+
+#include "string.h"
+#include "stdio.h"
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "mp_message_buffer.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Multi-producer message buffer throughput.
+ *
+ * N producers (2 ... 16) send BENCH_MESSAGES messages in total, alternating
+ * 8 and 24 bytes like Producer01/Producer02 of Multiple_Producers, to one
+ * consumer. All of them run at the same priority, so time slicing preempts
+ * producers in the middle of a send.
+ *
+ *   mutex      stock message buffer, every xMessageBufferSend() inside a
+ *              mutex (required with more than one writer)
+ *   lock-free  MPMessageBuffer, reservation by compare-and-swap
+ *   zero-copy  MPMessageBuffer, producer fills the reserved space, consumer
+ *              reads the message in place (no memcpy on either side)
+ */
+
+#define BENCH_MESSAGES        20000U
+#define BENCH_MAX_PRODUCERS   16U
+#define BENCH_BUFFER_SIZE     512U
+
+#define BENCH_CONTROL_PRIO    4
+#define BENCH_WORKER_PRIO     2
+
+typedef enum {
+	BENCH_MUTEX,
+	BENCH_LOCK_FREE,
+	BENCH_ZERO_COPY,
+}BenchVariant;
+
+static const char* variantNames[] = { "mutex", "lock-free", "zero-copy" };
+static const uint32_t producerCounts[] = { 2, 4, 8, 16 };
+
+/* *************************** Buffers ********************************** */
+MessageBufferHandle_t MessageBuffer_Handle;
+SemaphoreHandle_t SendMutex_Handle;
+MPMessageBufferHandle_t MPMessageBuffer_Handle;
+
+/* *************************** Tasks Handles ****************************** */
+TaskHandle_t Control_Handle;
+TaskHandle_t Producer_Handles[BENCH_MAX_PRODUCERS];
+TaskHandle_t Consumer_Handle;
+
+static BenchVariant variant;
+static uint32_t producers;
+static uint32_t runEnd;
+
+static char line[96];
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+/* *************************** Task Functions ******************************* */
+void Producer(void* pv)
+{
+	uint8_t msg[24];
+	uint32_t count = BENCH_MESSAGES / producers;
+
+	memset(msg, 'a' + (int)(uintptr_t)pv, sizeof(msg));
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		size_t len = (i & 1) ? 24 : 8;
+
+		if (variant == BENCH_MUTEX) {
+			xSemaphoreTake(SendMutex_Handle, portMAX_DELAY);
+			xMessageBufferSend(MessageBuffer_Handle, msg, len, portMAX_DELAY);
+			xSemaphoreGive(SendMutex_Handle);
+		} else if (variant == BENCH_LOCK_FREE) {
+			xMPMessageBufferSend(MPMessageBuffer_Handle, msg, len, portMAX_DELAY);
+		} else {
+			uint8_t* p = pvMPMessageBufferReserve(MPMessageBuffer_Handle, len, portMAX_DELAY);
+			p[0] = msg[0];
+			vMPMessageBufferCommit(MPMessageBuffer_Handle, p);
+		}
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Control
+}
+
+void Consumer(void* pv)
+{
+	uint8_t rxBuffer[32];
+	uint32_t count = (BENCH_MESSAGES / producers) * producers;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (variant == BENCH_MUTEX) {
+			xMessageBufferReceive(MessageBuffer_Handle, rxBuffer, sizeof(rxBuffer), portMAX_DELAY);
+		} else if (variant == BENCH_LOCK_FREE) {
+			xMPMessageBufferReceive(MPMessageBuffer_Handle, rxBuffer, sizeof(rxBuffer), portMAX_DELAY);
+		} else {
+			size_t len;
+			const uint8_t* p = pvMPMessageBufferPeek(MPMessageBuffer_Handle, &len, portMAX_DELAY);
+			rxBuffer[0] = p[0];
+			vMPMessageBufferRelease(MPMessageBuffer_Handle);
+		}
+	}
+	runEnd = ulPerfCounterGet();
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Control
+}
+
+static void Bench_Run(BenchVariant v, uint32_t n)
+{
+	variant = v;
+	producers = n;
+
+	if (v == BENCH_MUTEX) {
+		MessageBuffer_Handle = xMessageBufferCreate(BENCH_BUFFER_SIZE);
+		SendMutex_Handle = xSemaphoreCreateMutex();
+	} else {
+		MPMessageBuffer_Handle = xMPMessageBufferCreate(BENCH_BUFFER_SIZE);
+	}
+
+	xTaskCreate(Consumer, "Consumer", 128, NULL, BENCH_WORKER_PRIO, &Consumer_Handle);
+	for (uint32_t i = 0; i < n; i++) {
+		xTaskCreate(Producer, "Producer", 128, (void*)(uintptr_t)i, BENCH_WORKER_PRIO, &Producer_Handles[i]);
+	}
+
+	// Nothing runs before this task blocks
+	uint32_t start = ulPerfCounterGet();
+	uint32_t done = 0;
+	while (done < n + 1) {
+		done += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+
+	for (uint32_t i = 0; i < n; i++) {
+		vTaskDelete(Producer_Handles[i]);
+	}
+	vTaskDelete(Consumer_Handle);
+
+	if (v == BENCH_MUTEX) {
+		vMessageBufferDelete(MessageBuffer_Handle);
+		vSemaphoreDelete(SendMutex_Handle);
+	} else {
+		vMPMessageBufferDelete(MPMessageBuffer_Handle);
+	}
+
+	uint32_t elapsed = runEnd - start;
+	uint32_t count = (BENCH_MESSAGES / n) * n;
+	sprintf(line, "%-9s %3lu %10lu %8lu\n", variantNames[v], (unsigned long)n,
+			(unsigned long)(((uint64_t)count * ulPerfCounterHz()) / (elapsed ? elapsed : 1)),
+			(unsigned long)(ulPerfCounterToNs(elapsed) / count));
+	Bench_Print(line);
+}
+
+void Control(void* pv)
+{
+	sprintf(line, "\nMulti-producer message buffer, %u messages of 8/24 bytes per run\n", (unsigned)BENCH_MESSAGES);
+	Bench_Print(line);
+	Bench_Print("variant   N        msg/s  ns/msg\n");
+
+	for (uint32_t p = 0; p < sizeof(producerCounts) / sizeof(producerCounts[0]); p++) {
+		Bench_Run(BENCH_MUTEX, producerCounts[p]);
+		Bench_Run(BENCH_LOCK_FREE, producerCounts[p]);
+		Bench_Run(BENCH_ZERO_COPY, producerCounts[p]);
+	}
+
+	Bench_Print("done\n");
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+
+  /* ************************** Create Tasks ********************************** */
+  xTaskCreate(Control, "Control", 256, NULL, BENCH_CONTROL_PRIO, &Control_Handle);
+
+  /* ************************** Start Scheduler ********************************** */
+  vTaskStartScheduler();
+
+  /* USER CODE END 2 */
+
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
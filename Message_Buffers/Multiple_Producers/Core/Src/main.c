@@ -28,6 +28,8 @@
 #include "stdio.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "uart_log.h"
+#include "mp_message_buffer.h"
 
 /* USER CODE END Includes */
 
@@ -66,7 +68,8 @@ static void MX_USART1_UART_Init(void);
 /* USER CODE BEGIN 0 */
 
 /* *************************** Message Buffer Handle *********************** */
-MessageBufferHandle_t MessageBuffer_Handle;
+// Both producers write concurrently: multi-producer message buffer, no mutex needed
+MPMessageBufferHandle_t MessageBuffer_Handle;
 
 /* *************************** Tasks Handles ****************************** */
 TaskHandle_t Producer01_Handle;
@@ -82,9 +85,9 @@ void Producer01(void* pv)
 
 	for(;;)
 	{
-		if(xMessageBufferSend(MessageBuffer_Handle, msg, sizeof(msg), pdMS_TO_TICKS(100)) != pdPASS)
+		if(xMPMessageBufferSend(MessageBuffer_Handle, msg, sizeof(msg), pdMS_TO_TICKS(100)) != sizeof(msg))
 		{
-			HAL_UART_Transmit(&huart1, (uint8_t*)"P1 Message Send Failed\n", 24, HAL_MAX_DELAY);
+			xUartLogPrintf("P1 Message Send Failed\n");
 			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13);
 		}
 
@@ -94,16 +97,20 @@ void Producer01(void* pv)
 
 void Producer02(void* pv)
 {
-	uint8_t msg[24];
-	memset(msg, 'B', sizeof(msg));
-
 	for(;;)
 	{
-		if(xMessageBufferSend(MessageBuffer_Handle, msg, sizeof(msg), pdMS_TO_TICKS(100)) != pdPASS)
+		// Zero-copy: build the message directly in the buffer
+		uint8_t* msg = pvMPMessageBufferReserve(MessageBuffer_Handle, 24, pdMS_TO_TICKS(100));
+		if(msg == NULL)
 		{
-			HAL_UART_Transmit(&huart1, (uint8_t*) "P2 Message Send Failed\n", 24, HAL_MAX_DELAY);
+			xUartLogPrintf("P2 Message Send Failed\n");
 			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
 		}
+		else
+		{
+			memset(msg, 'B', 24);
+			vMPMessageBufferCommit(MessageBuffer_Handle, msg);
+		}
 
 		vTaskDelay(pdMS_TO_TICKS(900));
 	}
@@ -111,26 +118,27 @@ void Producer02(void* pv)
 
 void Consumer(void* pv)
 {
-	uint8_t rxBuffer[64];
+	const uint8_t* rxMessage;
 	size_t receivedBytes;
 	size_t freeSpaceBytes;
 
 	for(;;)
 	{
-		// Block until a message arrives
-		receivedBytes = xMessageBufferReceive(MessageBuffer_Handle, rxBuffer, sizeof(rxBuffer), portMAX_DELAY);
+		// Block until a message arrives, read it in place (no rx copy)
+		rxMessage = pvMPMessageBufferPeek(MessageBuffer_Handle, &receivedBytes, portMAX_DELAY);
 
 		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_11);
 
 		// Print received message
 		char log[80];
-		sprintf(log,"Consumer: Received msg (len=%u): %.*s\n",(unsigned)receivedBytes ,(unsigned)receivedBytes, rxBuffer);
-		HAL_UART_Transmit(&huart1, (uint8_t*)log, strlen(log), HAL_MAX_DELAY);
+		sprintf(log,"Consumer: Received msg (len=%u): %.*s\n",(unsigned)receivedBytes ,(unsigned)receivedBytes, rxMessage);
+		vMPMessageBufferRelease(MessageBuffer_Handle);
+		xUartLogWrite(log, strlen(log));
 
 		// Show buffer usage
-		freeSpaceBytes = xMessageBufferSpacesAvailable(MessageBuffer_Handle);
+		freeSpaceBytes = xMPMessageBufferSpacesAvailable(MessageBuffer_Handle);
 		sprintf(log,"Consumer: Free space = %u bytes\n", (unsigned)freeSpaceBytes);
-		HAL_UART_Transmit(&huart1, (uint8_t*)log, strlen(log), HAL_MAX_DELAY);
+		xUartLogWrite(log, strlen(log));
 
 		vTaskDelay(pdMS_TO_TICKS(100));  //
 	}
@@ -171,7 +179,7 @@ int main(void)
   /* USER CODE BEGIN 2 */
 
   /* ************************* Create Message Buffer ****************************** */
-  MessageBuffer_Handle = xMessageBufferCreate(256);
+  MessageBuffer_Handle = xMPMessageBufferCreate(256);
 	if (MessageBuffer_Handle == NULL) {
 		HAL_UART_Transmit(&huart1, (uint8_t*)"Message Buffer Creation Failed\n", 32, HAL_MAX_DELAY);
 	}else{
@@ -179,6 +187,7 @@ int main(void)
 	}
 
     /* ************************** Create Tasks ********************************** */
+	xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
 	xTaskCreate(Producer01, "Producer01", 256, NULL, 1, &Producer01_Handle);
 	xTaskCreate(Producer02, "Producer02", 256, NULL, 1, &Producer02_Handle);
 
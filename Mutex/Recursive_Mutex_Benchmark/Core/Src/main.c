@@ -0,0 +1,428 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "latency_hist.h"
+#include "fast_recursive_mutex.h"
+
+#include "string.h"
+#include "stdio.h"
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Cost of a recursive mutex against nesting depth.
+ *
+ * One round is what Function_A -> Function_B of RecursiveMutex does without
+ * the UART and the delays: depth takes of the same mutex by the same task,
+ * then depth gives. The Control task runs alone, so the mutex is never
+ * contended and only the API cost is measured:
+ *
+ *   mutex      xSemaphoreTake/Give on a plain mutex, depth 1 only
+ *   recursive  xSemaphoreTakeRecursive/GiveRecursive
+ *   fast       Common/fast_recursive_mutex.h, re-entry inlined
+ *
+ * Per round the perf counter difference goes into a histogram; per depth
+ * the p50 and max of BENCH_ROUNDS rounds are printed, plus the p50 cost of
+ * one extra level: (p50(depth) - p50(1)) / (depth - 1).
+ */
+
+#define BENCH_ROUNDS        2000U
+#define BENCH_CONTROL_PRIO  4
+
+typedef enum {
+	BENCH_MUTEX,
+	BENCH_RECURSIVE,
+	BENCH_FAST,
+}BenchVariant;
+
+static const char* variantNames[] = { "mutex", "recursive", "fast" };
+static const uint32_t depths[] = { 1, 2, 3, 4, 6, 8 };
+
+/* ************************* Mutex Handles ************************* */
+SemaphoreHandle_t Mutex_Handle;
+SemaphoreHandle_t RecursiveMutexHandle;
+FastRecursiveMutex_t FastRecursiveMutex;
+
+/* ************************* Task Handles ************************* */
+TaskHandle_t Control_Handle;
+
+static LatencyHist_t roundCost;
+static char line[96];
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+static uint32_t Bench_Round(BenchVariant variant, uint32_t depth)
+{
+	uint32_t start = ulPerfCounterGet();
+
+	switch (variant) {
+	case BENCH_MUTEX:
+		xSemaphoreTake(Mutex_Handle, portMAX_DELAY);
+		xSemaphoreGive(Mutex_Handle);
+		break;
+	case BENCH_RECURSIVE:
+		for (uint32_t i = 0; i < depth; i++) {
+			xSemaphoreTakeRecursive(RecursiveMutexHandle, portMAX_DELAY);
+		}
+		for (uint32_t i = 0; i < depth; i++) {
+			xSemaphoreGiveRecursive(RecursiveMutexHandle);
+		}
+		break;
+	case BENCH_FAST:
+		for (uint32_t i = 0; i < depth; i++) {
+			xFastRecursiveMutexTake(&FastRecursiveMutex, portMAX_DELAY);
+		}
+		for (uint32_t i = 0; i < depth; i++) {
+			xFastRecursiveMutexGive(&FastRecursiveMutex);
+		}
+		break;
+	}
+
+	return ulPerfCounterGet() - start;
+}
+
+/* Returns the p50 of the run. */
+static uint32_t Bench_Run(BenchVariant variant, uint32_t depth, uint32_t depthOneP50)
+{
+	uint32_t p50;
+
+	vLatencyHistReset(&roundCost);
+	for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+		vLatencyHistAdd(&roundCost, Bench_Round(variant, depth));
+	}
+	p50 = ulLatencyHistPercentile(&roundCost, 500);
+
+	sprintf(line, "%-9s %5lu %10lu %10lu %10lu",
+			variantNames[variant], (unsigned long)depth, (unsigned long)p50,
+			(unsigned long)roundCost.ulMax, (unsigned long)ulPerfCounterToNs(p50));
+	Bench_Print(line);
+	if (depth > 1) {
+		uint32_t extra = (p50 > depthOneP50) ? (p50 - depthOneP50) / (depth - 1) : 0;
+		sprintf(line, " %10lu\n", (unsigned long)ulPerfCounterToNs(extra));
+	} else {
+		sprintf(line, "          -\n");
+	}
+	Bench_Print(line);
+
+	return p50;
+}
+
+void Control(void* argument)
+{
+	sprintf(line, "\nRecursive mutex benchmark: %u rounds per run, counter %lu Hz\n",
+			(unsigned)BENCH_ROUNDS, (unsigned long)ulPerfCounterHz());
+	Bench_Print(line);
+	Bench_Print("variant   depth  p50 count  max count     p50 ns  +level ns\n");
+
+	Bench_Run(BENCH_MUTEX, 1, 0);
+	for (uint32_t v = BENCH_RECURSIVE; v <= BENCH_FAST; v++) {
+		uint32_t depthOneP50 = 0;
+		for (uint32_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+			uint32_t p50 = Bench_Run((BenchVariant)v, depths[d], depthOneP50);
+			if (depths[d] == 1) {
+				depthOneP50 = p50;
+			}
+		}
+	}
+
+	Bench_Print("Recursive mutex benchmark done\n");
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+
+  Mutex_Handle = xSemaphoreCreateMutex();
+  RecursiveMutexHandle = xSemaphoreCreateRecursiveMutex();
+  if (Mutex_Handle == NULL || RecursiveMutexHandle == NULL || xFastRecursiveMutexInit(&FastRecursiveMutex) != pdPASS) {
+	HAL_UART_Transmit(&huart1, (uint8_t *)"Mutex creation failed\n", 22, HAL_MAX_DELAY);
+  }
+
+  xTaskCreate(Control, "Control", 256, NULL, BENCH_CONTROL_PRIO, &Control_Handle);
+
+  vTaskStartScheduler();
+
+  /* USER CODE END 2 */
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
@@ -28,6 +28,10 @@
 #include "queue.h"
 #include "semphr.h"
 #include "event_groups.h"
+#include <string.h>
+#include "mutex_profile.h"
+#include "perf_counter.h"
+#include "uart_log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -65,30 +69,37 @@ static void MX_USART1_UART_Init(void);
 /* USER CODE BEGIN 0 */
 
 SemaphoreHandle_t SimpleMutex;
+MutexProfile_t SimpleMutexProfile; // acquire/contention/wait/hold statistics of SimpleMutex
 
-TaskHandle_t Task1Handle, Task2Handle;
+TaskHandle_t Task1Handle, Task2Handle, StatsHandle;
 
 void Task01(void* argument);
 void Task02(void* argument);
+void Stats(void* argument);
+
+void PrintLine(const char *line)
+{
+	xUartLogWrite(line, strlen(line));
+}
 
 void GPIO_TOGLE_01()
 {
-	xSemaphoreTake(SimpleMutex, portMAX_DELAY); // acquire the mutex
+	xMutexProfileTake(&SimpleMutexProfile, portMAX_DELAY); // acquire the mutex
 
 	HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13);
 	vTaskDelay(pdMS_TO_TICKS(500));
 
-	xSemaphoreGive(SimpleMutex); // release the mutex
+	xMutexProfileGive(&SimpleMutexProfile); // release the mutex
 }
 
 void GPIO_TOGLE_02()
 {
-	xSemaphoreTake(SimpleMutex, portMAX_DELAY); // acquire the mutex
+	xMutexProfileTake(&SimpleMutexProfile, portMAX_DELAY); // acquire the mutex
 
 	HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
 	vTaskDelay(pdMS_TO_TICKS(500));
 
-	xSemaphoreGive(SimpleMutex); // release the mutex
+	xMutexProfileGive(&SimpleMutexProfile); // release the mutex
 
 }
 
@@ -127,13 +138,17 @@ int main(void)
 
   /* USER CODE BEGIN 2 */
 
-  SimpleMutex = xSemaphoreCreateMutex();
+  vPerfCounterInit();
+  xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
+
+  SimpleMutex = xMutexProfileCreate(&SimpleMutexProfile, "SimpleMutex");
   if (SimpleMutex == NULL) {
 		HAL_UART_Transmit(&huart1, (uint8_t *)"Mutex Creation Failed\r\n", 23, HAL_MAX_DELAY);
    }
 
    xTaskCreate(Task01, "Task01", 128, NULL, 2, &Task1Handle);
    xTaskCreate(Task02, "Task02", 128, NULL, 1, &Task2Handle);
+   xTaskCreate(Stats, "Stats", 256, NULL, 3, &StatsHandle);
 
 
    vTaskStartScheduler();
@@ -293,6 +308,13 @@ void Task02(void *argument) {
 		GPIO_TOGLE_02();
 	}
 }
+
+void Stats(void *argument) {
+	while(1){
+		vTaskDelay(pdMS_TO_TICKS(5000));
+		vMutexProfileDump(PrintLine);
+	}
+}
 /* USER CODE END 4 */
 
 
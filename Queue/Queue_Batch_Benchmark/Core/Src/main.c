@@ -0,0 +1,497 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+#include "string.h"
+#include "stdio.h"
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "batch_queue.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Batched queue benchmark.
+ *
+ * The producer sends BENCH_ITEMS 8 byte items (sizeof(QMsg) on the
+ * STM32F429) to a consumer of higher priority, in batches of 1 ... 32:
+ *   - "queue": one xQueueSend() per item, the consumer drains with
+ *     xQueueReceive() one item per call,
+ *   - "batch": one uxBatchQueueSend() per batch, the consumer takes up to a
+ *     batch per uxBatchQueueReceive() call.
+ * With the stock queue every send wakes the consumer, with the batch queue
+ * every batch does. The cost per item is the run time divided by the item
+ * count; "wakeups" counts the consumer calls that had to block.
+ */
+
+#define BENCH_ITEMS           2048U   /* per run, a multiple of every batch size */
+#define BENCH_DEPTH           64U
+#define BENCH_MAX_BATCH       32U
+
+#define BENCH_CONTROL_PRIO    4
+#define BENCH_CONSUMER_PRIO   3
+#define BENCH_PRODUCER_PRIO   2
+
+typedef struct {
+	uint32_t stamp;
+	uint32_t seq;
+}BenchItem;
+
+static const uint16_t batchSizes[] = { 1, 2, 4, 8, 16, 32 };
+
+/* ******************* TASK HANDLERS ******************* */
+xTaskHandle Control_Handle;
+xTaskHandle Producer_Handle;
+xTaskHandle Consumer_Handle;
+
+/* ******************* QUEUE HANDLERS ******************* */
+xQueueHandle Queue_Handle;
+BatchQueueHandle_t BatchQueue_Handle;
+
+/* ******************* ONE BENCHMARK RUN ******************* */
+static uint16_t batchSize;
+static uint32_t runStart;
+static uint32_t runEnd;
+static uint32_t wakeups;
+static uint32_t errors;
+
+static char line[96];
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+static void Bench_Check(const BenchItem* item, uint32_t* expected)
+{
+	if (item->seq != (*expected)++) {
+		errors++;
+	}
+}
+
+/* ******************* TASK FUNCTIONS ******************* */
+void Bench_QueueProducer(void* argument)
+{
+	BenchItem item = { 0, 0 };
+
+	runStart = ulPerfCounterGet();
+
+	for (uint32_t i = 0; i < BENCH_ITEMS; i += batchSize) {
+		for (uint32_t j = 0; j < batchSize; j++) {
+			item.stamp = ulPerfCounterGet();
+			xQueueSend(Queue_Handle, &item, portMAX_DELAY);
+			item.seq++;
+		}
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Bench_Control
+}
+
+void Bench_QueueConsumer(void* argument)
+{
+	BenchItem item;
+	uint32_t expected = 0;
+	uint32_t received = 0;
+
+	while (received < BENCH_ITEMS) {
+		if (xQueueReceive(Queue_Handle, &item, 0) != pdPASS) {
+			wakeups++;
+			xQueueReceive(Queue_Handle, &item, portMAX_DELAY);
+		}
+		Bench_Check(&item, &expected);
+		received++;
+	}
+	runEnd = ulPerfCounterGet();
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Bench_Control
+}
+
+void Bench_BatchProducer(void* argument)
+{
+	BenchItem items[BENCH_MAX_BATCH];
+	uint32_t seq = 0;
+
+	runStart = ulPerfCounterGet();
+
+	for (uint32_t i = 0; i < BENCH_ITEMS; i += batchSize) {
+		for (uint32_t j = 0; j < batchSize; j++) {
+			items[j].stamp = ulPerfCounterGet();
+			items[j].seq = seq++;
+		}
+		for (UBaseType_t sent = 0; sent < batchSize; ) { // a full queue takes part of the batch
+			sent += uxBatchQueueSend(BatchQueue_Handle, &items[sent], batchSize - sent, portMAX_DELAY);
+		}
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Bench_Control
+}
+
+void Bench_BatchConsumer(void* argument)
+{
+	BenchItem items[BENCH_MAX_BATCH];
+	uint32_t expected = 0;
+	uint32_t received = 0;
+
+	while (received < BENCH_ITEMS) {
+		UBaseType_t got = uxBatchQueueReceive(BatchQueue_Handle, items, batchSize, 0);
+		if (got == 0) {
+			wakeups++;
+			got = uxBatchQueueReceive(BatchQueue_Handle, items, batchSize, portMAX_DELAY);
+		}
+		for (UBaseType_t j = 0; j < got; j++) {
+			Bench_Check(&items[j], &expected);
+		}
+		received += got;
+	}
+	runEnd = ulPerfCounterGet();
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Bench_Control
+}
+
+/* Runs one producer/consumer pair, returns ns per item. */
+static uint32_t Bench_Run(TaskFunction_t producer, TaskFunction_t consumer)
+{
+	wakeups = 0;
+	errors = 0;
+
+	// Consumer first, it blocks on the empty queue and is woken by every send
+	xTaskCreate(consumer, "Cons", 256, NULL, BENCH_CONSUMER_PRIO, &Consumer_Handle);
+	xTaskCreate(producer, "Prod", 256, NULL, BENCH_PRODUCER_PRIO, &Producer_Handle);
+
+	// Both tasks notify once when they are done
+	uint32_t done = 0;
+	while (done < 2) {
+		done += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+
+	vTaskDelete(Producer_Handle);
+	vTaskDelete(Consumer_Handle);
+
+	return ulPerfCounterToNs(runEnd - runStart) / BENCH_ITEMS;
+}
+
+void Bench_Control(void* argument)
+{
+	sprintf(line, "\nBatch queue benchmark: %u items of %u bytes per run, depth %u\n",
+			(unsigned)BENCH_ITEMS, (unsigned)sizeof(BenchItem), (unsigned)BENCH_DEPTH);
+	Bench_Print(line);
+	Bench_Print("batch  queue ns/item wakeups  batch ns/item wakeups\n");
+
+	Queue_Handle = xQueueCreate(BENCH_DEPTH, sizeof(BenchItem));
+	BatchQueue_Handle = xBatchQueueCreate(BENCH_DEPTH, sizeof(BenchItem));
+	if (Queue_Handle == NULL || BatchQueue_Handle == NULL) {
+		Bench_Print("Queue creation failed\n");
+		vTaskSuspend(NULL);
+	}
+
+	for (uint32_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); b++) {
+		batchSize = batchSizes[b];
+
+		uint32_t queueNs = Bench_Run(Bench_QueueProducer, Bench_QueueConsumer);
+		uint32_t queueWakeups = wakeups;
+		uint32_t queueErrors = errors;
+		uint32_t batchNs = Bench_Run(Bench_BatchProducer, Bench_BatchConsumer);
+
+		sprintf(line, "%5u %14lu %7lu %14lu %7lu%s\n",
+				batchSize, (unsigned long)queueNs, (unsigned long)queueWakeups,
+				(unsigned long)batchNs, (unsigned long)wakeups,
+				(queueErrors + errors) ? "  ORDER ERROR" : "");
+		Bench_Print(line);
+	}
+
+	Bench_Print("Batch queue benchmark done\n");
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+  /* USER CODE END 2 */
+
+  /* ********************* Create Tasks ********************* */
+  xTaskCreate(Bench_Control, "Bench", 512, NULL, BENCH_CONTROL_PRIO, &Control_Handle);
+
+  vTaskStartScheduler(); // This function will never return unless RTOS scheduler stops
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
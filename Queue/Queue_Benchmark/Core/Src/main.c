@@ -0,0 +1,451 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+#include "string.h"
+#include "stdio.h"
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "latency_hist.h"
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+/*
+ * Queue throughput / latency benchmark.
+ *
+ * The Task01_Producer -> Queue_Handle -> Task03_Consumer pair of SimpleQueue,
+ * without the UART logging and the vTaskDelay() in the loops, repeated for
+ * every combination of
+ *   - item size   4 ... 256 bytes (sizeof(QMsg) is 8 on the STM32F429)
+ *   - queue depth 5 (SimpleQueue) ... 1024
+ *   - producer priority above / equal to / below the consumer.
+ *
+ * Every item carries the perf counter value taken right before xQueueSend(),
+ * the consumer stamps it again after xQueueReceive() returns, so the latency
+ * includes the time an item waits in a full queue. One result line per
+ * combination is printed on UART1 after the run, never while measuring.
+ */
+
+#define BENCH_MESSAGES        2000U   /* per combination, p99.9 = 2nd worst */
+#define BENCH_MAX_ITEM_SIZE   256U
+
+#define BENCH_CONTROL_PRIO    4
+#define BENCH_HIGH_PRIO       3
+#define BENCH_LOW_PRIO        2
+
+typedef struct {
+	const char* pName;
+	UBaseType_t producerPrio;
+	UBaseType_t consumerPrio;
+}BenchPrio;
+
+static const uint16_t itemSizes[] = { 4, 8, 16, 32, 64, 128, 256 };
+static const uint16_t queueDepths[] = { 5, 16, 64, 256, 1024 };
+static const BenchPrio prioCases[] = {
+	{ "P>C", BENCH_HIGH_PRIO, BENCH_LOW_PRIO  },
+	{ "P=C", BENCH_LOW_PRIO,  BENCH_LOW_PRIO  },
+	{ "P<C", BENCH_LOW_PRIO,  BENCH_HIGH_PRIO },
+};
+
+/* ******************* TASK HANDLERS ******************* */
+xTaskHandle Control_Handle;
+xTaskHandle Producer_Handle;
+xTaskHandle Consumer_Handle;
+
+/* ******************* QUEUE HANDLER ******************* */
+xQueueHandle Queue_Handle;
+
+/* ******************* ONE BENCHMARK RUN ******************* */
+static uint16_t itemSize;
+static uint32_t runStart;
+static uint32_t runEnd;
+static LatencyHist_t latency;
+
+static char line[128];
+
+static void Bench_Print(const char* str)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+}
+
+/* ******************* TASK FUNCTIONS ******************* */
+void Bench_Producer(void* argument)
+{
+	uint8_t item[BENCH_MAX_ITEM_SIZE];
+
+	memset(item, 0xA5, sizeof(item));
+	runStart = ulPerfCounterGet();
+
+	for (uint32_t i = 0; i < BENCH_MESSAGES; i++) {
+		uint32_t stamp = ulPerfCounterGet();
+		memcpy(item, &stamp, sizeof(stamp));
+		xQueueSend(Queue_Handle, item, portMAX_DELAY);
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Bench_Control
+}
+
+void Bench_Consumer(void* argument)
+{
+	uint8_t item[BENCH_MAX_ITEM_SIZE];
+
+	for (uint32_t i = 0; i < BENCH_MESSAGES; i++) {
+		uint32_t stamp;
+		xQueueReceive(Queue_Handle, item, portMAX_DELAY);
+		runEnd = ulPerfCounterGet();
+		memcpy(&stamp, item, sizeof(stamp));
+		vLatencyHistAdd(&latency, runEnd - stamp);
+	}
+
+	xTaskNotifyGive(Control_Handle);
+	vTaskSuspend(NULL); // deleted by Bench_Control
+}
+
+static void Bench_RunOne(uint16_t size, uint16_t depth, const BenchPrio* prio)
+{
+	itemSize = size;
+	vLatencyHistReset(&latency);
+
+	Queue_Handle = xQueueCreate(depth, size);
+	if (Queue_Handle == NULL) {
+		sprintf(line, "%4u %5u  %s   skipped, needs %lu bytes of heap (free %lu)\n",
+				size, depth, prio->pName, (unsigned long)size * depth,
+				(unsigned long)xPortGetFreeHeapSize());
+		Bench_Print(line);
+		return;
+	}
+
+	// Consumer first, so it is already blocked on the empty queue when P=C
+	xTaskCreate(Bench_Consumer, "Cons", 256 + BENCH_MAX_ITEM_SIZE / sizeof(StackType_t), NULL, prio->consumerPrio, &Consumer_Handle);
+	xTaskCreate(Bench_Producer, "Prod", 256 + BENCH_MAX_ITEM_SIZE / sizeof(StackType_t), NULL, prio->producerPrio, &Producer_Handle);
+
+	// Both tasks notify once when they are done
+	uint32_t done = 0;
+	while (done < 2) {
+		done += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+
+	vTaskDelete(Producer_Handle);
+	vTaskDelete(Consumer_Handle);
+	vQueueDelete(Queue_Handle);
+
+	uint32_t elapsed = runEnd - runStart;
+	uint32_t msgPerSec = (uint32_t)(((uint64_t)BENCH_MESSAGES * ulPerfCounterHz()) / (elapsed ? elapsed : 1));
+
+	sprintf(line, "%4u %5u  %s %10lu %9lu %9lu %9lu %9lu\n",
+			size, depth, prio->pName, (unsigned long)msgPerSec,
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&latency, 500)),
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&latency, 990)),
+			(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&latency, 999)),
+			(unsigned long)ulPerfCounterToNs(latency.ulMax));
+	Bench_Print(line);
+}
+
+void Bench_Control(void* argument)
+{
+	sprintf(line, "\nQueue benchmark: %u messages per run, counter %lu Hz\n",
+			(unsigned)BENCH_MESSAGES, (unsigned long)ulPerfCounterHz());
+	Bench_Print(line);
+	Bench_Print("size depth prio      msg/s    p50 ns    p99 ns  p99.9 ns    max ns\n");
+
+	for (uint32_t p = 0; p < sizeof(prioCases) / sizeof(prioCases[0]); p++) {
+		for (uint32_t s = 0; s < sizeof(itemSizes) / sizeof(itemSizes[0]); s++) {
+			for (uint32_t d = 0; d < sizeof(queueDepths) / sizeof(queueDepths[0]); d++) {
+				Bench_RunOne(itemSizes[s], queueDepths[d], &prioCases[p]);
+			}
+		}
+	}
+
+	Bench_Print("Queue benchmark done\n");
+	vTaskSuspend(NULL);
+}
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+  /* USER CODE END 2 */
+
+  /* ********************* Create Tasks ********************* */
+  xTaskCreate(Bench_Control, "Bench", 512, NULL, BENCH_CONTROL_PRIO, &Control_Handle);
+
+  vTaskStartScheduler(); // This function will never return unless RTOS scheduler stops
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pins : PG11 PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+#ifdef USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
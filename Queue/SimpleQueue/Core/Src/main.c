@@ -29,6 +29,13 @@
 #include "stdio.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "uart_log.h"
+#include "block_pool.h"
+#include "uart_rx.h"
+#include "prio_queue.h"
+#include "perf_counter.h"
+#include "runtime_stats.h"
+#include "queue_metrics.h"
 
 /* USER CODE END Includes */
 
@@ -49,6 +56,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 UART_HandleTypeDef huart1;
+DMA_HandleTypeDef hdma_usart1_rx;
 
 /* USER CODE BEGIN PV */
 
@@ -57,6 +65,7 @@ UART_HandleTypeDef huart1;
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART1_UART_Init(void);
 
 
@@ -67,8 +76,6 @@ static void MX_USART1_UART_Init(void);
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
-uint8_t rx_data = 0;
-
 typedef struct {
     char* pStr;
     int value;
@@ -78,9 +85,25 @@ typedef struct {
 xTaskHandle Task01_Handle;
 xTaskHandle Task02_Handle;
 xTaskHandle Task03_Handle;
+xTaskHandle Task04_Handle;
 
 /* ******************* QUEUE HANDLER ******************* */
-xQueueHandle Queue_Handle;
+PrioQueueHandle_t Queue_Handle; // receive returns the most urgent message first
+
+#define PRIO_URGENT     0 // UART command
+#define PRIO_NORMAL     1 // T1, T2 (FIFO among themselves)
+
+/* ******************* LOG LINE POOL ******************* */
+#define LOG_LINE_SIZE   200 // longest line (T3)
+#define LOG_LINES       3   // one line per task at a time
+
+BLOCK_POOL_STORAGE(LogLines, LOG_LINE_SIZE, LOG_LINES);
+BlockPool_t LogPool;
+
+void PrintLine(const char *line)
+{
+	xUartLogWrite(line, strlen(line));
+}
 
 /* ******************* TASK FUNCTIONS ******************* */
 void Task01_Producer(void* argument)
@@ -90,20 +113,20 @@ void Task01_Producer(void* argument)
 	uint32_t TickDelay = pdMS_TO_TICKS(4000); // convert ms to ticks
 	while(1){
 
-		char* str = (char*) pvPortMalloc(100 * sizeof(char)); // Allocate memory from the heap
+		char* str = (char*) pvBlockPoolAlloc(&LogPool); // O(1), no heap fragmentation
 
 		t1Msg.pStr = "Message from T1";
 		t1Msg.value = 101;
 
-		if(xQueueSend(Queue_Handle, &t1Msg, portMAX_DELAY) == pdPASS){
+		if(xPrioQueueSend(Queue_Handle, &t1Msg, PRIO_NORMAL, portMAX_DELAY) == pdPASS){
 
 			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_13);
 
 			sprintf(str, "T1 Successfully sent message to the queue value:%d  Msg:%s\n", t1Msg.value, t1Msg.pStr);
-			HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+			xUartLogWrite(str, strlen(str));
 		}
 
-		vPortFree(str); // Free the allocated memory
+		vBlockPoolFree(&LogPool, str); // Return the line to the pool
 
 		vTaskDelay(TickDelay);
 	}
@@ -116,22 +139,22 @@ void Task02_Producer(void* argument)
 	uint32_t TickDelay = pdMS_TO_TICKS(2000); // convert ms to ticks
 	while(1){
 
-		char* str = (char*) pvPortMalloc(100 * sizeof(char)); // Allocate memory from the heap
+		char* str = (char*) pvBlockPoolAlloc(&LogPool); // O(1), no heap fragmentation
 
 		t2Msg.pStr = "Message from T2";
 		t2Msg.value = 202;
 
 
-		if(xQueueSend(Queue_Handle, &t2Msg, portMAX_DELAY) == pdPASS){
+		if(xPrioQueueSend(Queue_Handle, &t2Msg, PRIO_NORMAL, portMAX_DELAY) == pdPASS){
 
 			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
 
 			sprintf(str, "T2 Successfully sent message to the queue value:%d  Msg:%s\n", t2Msg.value, t2Msg.pStr);
-			HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+			xUartLogWrite(str, strlen(str));
 
 		}
 
-		vPortFree(str); // Free the allocated memory
+		vBlockPoolFree(&LogPool, str); // Return the line to the pool
 
 		vTaskDelay(TickDelay);
 	}
@@ -143,9 +166,9 @@ void Task03_Consumer(void* argument)
 	uint32_t TickDelay = pdMS_TO_TICKS(5000); // convert ms to ticks
 	while(1){
 
-		char* str = (char*) pvPortMalloc(200 * sizeof(char)); // Allocate memory from the heap
+		char* str = (char*) pvBlockPoolAlloc(&LogPool); // O(1), no heap fragmentation
 
-		if(xQueueReceive(Queue_Handle, &received, portMAX_DELAY) != pdPASS) // Wait indefinitely until something arrives
+		if(xPrioQueueReceive(Queue_Handle, &received, NULL, portMAX_DELAY) != pdPASS) // Wait indefinitely until something arrives
 		{
 			//HAL_UART_Transmit(&huart1, (uint8_t*) "Error in receiving from Queue\n", 31, HAL_MAX_DELAY);
 		}else {
@@ -153,38 +176,75 @@ void Task03_Consumer(void* argument)
 			HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_11);
 
 			sprintf(str, "Successfully received QMsg from the queue: value:%d  Msg:%s\n\n", received.value, received.pStr);
-			HAL_UART_Transmit(&huart1, (uint8_t *)str, strlen(str), HAL_MAX_DELAY);
+			xUartLogWrite(str, strlen(str));
 		}
 
-		vPortFree(str); // Free the allocated memory
+		vBlockPoolFree(&LogPool, str); // Return the line to the pool
 
 		vTaskDelay(TickDelay);
 	}
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart)
+// Woken by the UART interrupt after each 'r'
+void Task04_Stats(void* argument)
 {
-	QMsg ISRMsg;
+	while(1){
 
-	if(rx_data == 'r')
-	{
-		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		vRuntimeStatsPrint(PrintLine); // CPU per task since the previous 'r'
+		vQueueMetricsDump(PrintLine);  // how close Queue_Handle came to full
+	}
+}
 
-		ISRMsg.pStr = "Message from ISR";
-		ISRMsg.value = 999;
+// Called from the UART / DMA interrupt at idle line, half and full buffer
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	QMsg ISRMsg;
+	uint8_t rx[16];
+	size_t len;
 
-		if (xQueueSendToFrontFromISR(Queue_Handle, &ISRMsg, &xHigherPriorityTaskWoken) == pdPASS) // if queue is full, it will block.
+	vUartRxEventFromISR(huart, Size, &xHigherPriorityTaskWoken);
+
+	// Only the bytes that arrived since the previous event
+	while ((len = xUartRxReadFromISR(rx, sizeof(rx))) > 0)
+	{
+		for (size_t i = 0; i < len; i++)
 		{
-			HAL_UART_Transmit(huart, (uint8_t*) "\nSent from ISR\n\n", 17, HAL_MAX_DELAY);
-		}else {
-			HAL_UART_Transmit(huart, (uint8_t*) "\nCould not send from ISR Queue Full\n\n", 38, HAL_MAX_DELAY); // queue full
+			if(rx[i] != 'r')
+			{
+				continue;
+			}
+
+			ISRMsg.pStr = "Message from ISR";
+			ISRMsg.value = 999;
+
+			if (xPrioQueueSendFromISR(Queue_Handle, &ISRMsg, PRIO_URGENT, &xHigherPriorityTaskWoken) == pdPASS) // ahead of T1/T2, never blocks
+			{
+				static const char sent[] = "\nSent from ISR\n\n";
+				xUartLogWriteFromISR(sent, sizeof(sent) - 1, &xHigherPriorityTaskWoken);
+			}else {
+				static const char full[] = "\nCould not send from ISR Queue Full\n\n";
+				xUartLogWriteFromISR(full, sizeof(full) - 1, &xHigherPriorityTaskWoken); // queue full
+			}
+
+			vTaskNotifyGiveFromISR(Task04_Handle, &xHigherPriorityTaskWoken);
 		}
-
-		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 	}
 
-    // Restart UART Reception in Interrupt mode
-	HAL_UART_Receive_IT(huart, &rx_data, 1);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	static const char err[] = "\nUART line error, reception restarted\n\n";
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	vUartRxErrorFromISR(huart); // restart the circular reception
+	xUartLogWriteFromISR(err, sizeof(err) - 1, &xHigherPriorityTaskWoken); // printed by the "Log" task
+
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
 
 
@@ -219,27 +279,35 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
 
+  vPerfCounterInit(); // clock of the runtime statistics
+
   /* USER CODE END 2 */
 
   /* ********************* Create integer QUEUE ********************* */
-  Queue_Handle = xQueueCreate(5, sizeof(QMsg));
+  Queue_Handle = xPrioQueueCreate(5, sizeof(QMsg));
   if (Queue_Handle == NULL) {
 	// Queue was not created and must not be used.
 	HAL_UART_Transmit(&huart1, (uint8_t *)"Queue was not created and must not be used.\n", 43, HAL_MAX_DELAY);
   }else{
 	HAL_UART_Transmit(&huart1, (uint8_t*) "Queue created successfully.\n", 30, HAL_MAX_DELAY);
+	xQueueMetricsAddPrioQueue(Queue_Handle, "Queue_Handle");
   }
 
   /* ********************* Create Tasks ********************* */
+  vBlockPoolInit(&LogPool, LogLines, LOG_LINE_SIZE, LOG_LINES);
+  xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
   xTaskCreate(Task01_Producer, "T1", 256, NULL, 3, &Task01_Handle);
   xTaskCreate(Task02_Producer, "T2", 256, NULL, 2, &Task02_Handle);
   xTaskCreate(Task03_Consumer, "T3", 256, NULL, 1, &Task03_Handle);
+  xTaskCreate(Task04_Stats, "Stats", 256, NULL, 4, &Task04_Handle);
+  xQueueMetricsStartSampler(pdMS_TO_TICKS(100), 5); // above every user of the queue
 
-  /* Start UART Reception in Interrupt mode */
-  HAL_UART_Receive_IT(&huart1, &rx_data, 1);
+  /* Start UART Reception with circular DMA and idle line detection */
+  xUartRxInit(&huart1);
 
 
   vTaskStartScheduler(); // This function will never return unless RTOS scheduler stops
@@ -342,6 +410,22 @@ static void MX_USART1_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA2_Stream2_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
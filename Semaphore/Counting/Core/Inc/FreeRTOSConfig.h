@@ -66,6 +66,7 @@
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
 #define configTOTAL_HEAP_SIZE                    ((size_t)15360)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_TRACE_FACILITY                 1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
@@ -135,6 +136,9 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Task switches, semaphore gives / takes and the other kernel events go to
+the timeline recorder, see Common/Inc/timeline.h */
+#include "timeline_trace.h"
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -27,6 +27,8 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "perf_counter.h"
+#include "timeline.h"
 
 /* USER CODE END Includes */
 
@@ -114,12 +116,14 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
   if(GPIO_Pin == GPIO_PIN_0)
   {
+	  vTimelineIsrEnter(EXTI0_IRQn); // shows up on the ISR track of the timeline
 
 	  // Release the binary semaphore
 	  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	  xSemaphoreGiveFromISR(CountingSemaphore_Handle, &xHigherPriorityTaskWoken);
 
 	  // Perform context switch if needed
+	  vTimelineIsrExit();
 	  portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 
   }
@@ -160,7 +164,11 @@ int main(void)
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
 
+  vPerfCounterInit(); // timestamps of the timeline
+  vTimelineInit();
+
   CountingSemaphore_Handle = xSemaphoreCreateCounting(2,0);
+  vQueueAddToRegistry(CountingSemaphore_Handle, "Counting"); // name on the timeline
   if(CountingSemaphore_Handle == NULL) HAL_UART_Transmit(&huart1,(uint8_t *) "Unable to create semaphore\n\n",29, 100);
   else HAL_UART_Transmit(&huart1,(uint8_t *) "Counting Semaphore created successfully\n\n", 42, 100);
 
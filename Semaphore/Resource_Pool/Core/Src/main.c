@@ -0,0 +1,435 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Main program body
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+#include "resource_pool.h"
+#include "perf_counter.h"
+#include "latency_hist.h"
+#include "uart_log.h"
+
+#include "string.h"
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private define ------------------------------------------------------------*/
+/* USER CODE BEGIN PD */
+#define POOL_SIZE       4       // buffers in the pool
+#define BUFFER_SIZE     64
+#define BATCH           3       // buffers per "DMA transfer", given back by one completion interrupt
+
+#ifdef HOST_BUILD
+#define TRIGGER_COMPLETION()  HostPort_RaiseExti(GPIO_PIN_0)
+#else
+#define TRIGGER_COMPLETION()  (EXTI->SWIER = GPIO_PIN_0)   // software interrupt on EXTI0 (PA0 button line)
+#endif
+/* USER CODE END PD */
+
+/* Private macro -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+UART_HandleTypeDef huart1;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+static void MX_USART1_UART_Init(void);
+
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Private user code ---------------------------------------------------------*/
+/* USER CODE BEGIN 0 */
+
+TaskHandle_t Submit_Handle;
+TaskHandle_t Single_Handle;
+
+/* The pool hands out the buffers themselves, the counting semaphore is only
+there to compare the cost of giving BATCH units from the interrupt. */
+ResourcePoolHandle_t Pool_Handle;
+SemaphoreHandle_t CountingSemaphore_Handle;
+
+uint8_t Buffers[POOL_SIZE][BUFFER_SIZE];
+
+void *inFlight[BATCH];              // buffers of the transfer in progress
+volatile uint32_t inFlightCount;
+
+LatencyHist_t batchGiveCost;        // one vResourcePoolGiveBatchFromISR() of BATCH buffers
+LatencyHist_t semaphoreGiveCost;    // BATCH xSemaphoreGiveFromISR() calls
+uint32_t singleTimeouts;
+
+/* Takes BATCH buffers in one call, fills them and starts a "transfer" whose
+completion interrupt gives all of them back. */
+void Submit(void* arg)
+{
+	uint32_t round = 0;
+
+	while(1)
+	{
+		xResourcePoolTakeBatch(Pool_Handle, inFlight, BATCH, portMAX_DELAY);
+
+		for (uint32_t i = 0; i < BATCH; i++) {
+			memset(inFlight[i], (int)round, BUFFER_SIZE);
+		}
+		HAL_GPIO_WritePin(GPIOG, GPIO_PIN_13, GPIO_PIN_SET);
+		inFlightCount = BATCH;
+		TRIGGER_COMPLETION();
+
+		vTaskDelay(pdMS_TO_TICKS(1000));
+
+		// drop the units the interrupt gave to the comparison semaphore
+		while (xSemaphoreTake(CountingSemaphore_Handle, 0) == pdPASS) {
+		}
+
+		if (++round % 10 == 0) {
+			xUartLogPrintf("%lu transfers: batch give %lu ns (max %lu), %u x semaphore give %lu ns (max %lu), single timeouts %lu\n",
+					(unsigned long)round,
+					(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&batchGiveCost, 500)),
+					(unsigned long)ulPerfCounterToNs(batchGiveCost.ulMax), (unsigned)BATCH,
+					(unsigned long)ulPerfCounterToNs(ulLatencyHistPercentile(&semaphoreGiveCost, 500)),
+					(unsigned long)ulPerfCounterToNs(semaphoreGiveCost.ulMax), (unsigned long)singleTimeouts);
+		}
+	}
+}
+
+/* Uses one buffer at a time, gives up after 100 ms. */
+void Single(void* arg)
+{
+	while(1)
+	{
+		uint8_t *buffer = pvResourcePoolTake(Pool_Handle, pdMS_TO_TICKS(100));
+
+		if (buffer == NULL) {
+			singleTimeouts++;
+		} else {
+			HAL_GPIO_WritePin(GPIOG, GPIO_PIN_14, GPIO_PIN_SET);
+			buffer[0] = 0x55;
+			vTaskDelay(pdMS_TO_TICKS(150));
+			HAL_GPIO_WritePin(GPIOG, GPIO_PIN_14, GPIO_PIN_RESET);
+
+			vResourcePoolGive(Pool_Handle, buffer);
+		}
+		vTaskDelay(pdMS_TO_TICKS(100));
+	}
+}
+
+/* Transfer complete: all BATCH buffers go back at once. */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  if(GPIO_Pin == GPIO_PIN_0 && inFlightCount != 0)
+  {
+	  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	  uint32_t start, middle, end;
+
+	  start = ulPerfCounterGet();
+	  vResourcePoolGiveBatchFromISR(Pool_Handle, inFlight, inFlightCount, &xHigherPriorityTaskWoken);
+	  middle = ulPerfCounterGet();
+	  for (uint32_t i = 0; i < inFlightCount; i++) {
+		  xSemaphoreGiveFromISR(CountingSemaphore_Handle, &xHigherPriorityTaskWoken);
+	  }
+	  end = ulPerfCounterGet();
+
+	  vLatencyHistAdd(&batchGiveCost, middle - start);
+	  vLatencyHistAdd(&semaphoreGiveCost, end - middle);
+	  inFlightCount = 0;
+	  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_13, GPIO_PIN_RESET);
+
+	  // Perform context switch if needed
+	  portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+  }
+}
+
+
+/* USER CODE END 0 */
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+
+  /* USER CODE BEGIN 1 */
+
+  /* USER CODE END 1 */
+
+  /* MCU Configuration--------------------------------------------------------*/
+
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
+  HAL_Init();
+
+  /* USER CODE BEGIN Init */
+
+  /* USER CODE END Init */
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* USER CODE BEGIN SysInit */
+
+  /* USER CODE END SysInit */
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+  /* USER CODE BEGIN 2 */
+  vPerfCounterInit();
+  xUartLogInit(&huart1); // UART output from tasks goes through the "Log" task
+  vLatencyHistReset(&batchGiveCost);
+  vLatencyHistReset(&semaphoreGiveCost);
+
+  void *buffers[POOL_SIZE];
+  for (uint32_t i = 0; i < POOL_SIZE; i++) {
+	  buffers[i] = Buffers[i];
+  }
+  Pool_Handle = xResourcePoolCreate(buffers, POOL_SIZE);
+  CountingSemaphore_Handle = xSemaphoreCreateCounting(BATCH, 0);
+  if(Pool_Handle == NULL || CountingSemaphore_Handle == NULL) HAL_UART_Transmit(&huart1,(uint8_t *) "Unable to create pool\n\n", 23, 100);
+  else HAL_UART_Transmit(&huart1,(uint8_t *) "Resource pool created successfully\n\n", 36, 100);
+
+  xTaskCreate(Submit, "Submit", 256, NULL, 2, &Submit_Handle);
+  xTaskCreate(Single, "Single", 128, NULL, 3, &Single_Handle);
+
+  vTaskStartScheduler();
+
+
+  /* USER CODE END 2 */
+
+
+
+
+  /* We should never get here as control is now taken by the scheduler */
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Activate the Over-Drive mode
+  */
+  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief USART1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_USART1_UART_Init(void)
+{
+
+  /* USER CODE BEGIN USART1_Init 0 */
+
+  /* USER CODE END USART1_Init 0 */
+
+  /* USER CODE BEGIN USART1_Init 1 */
+
+  /* USER CODE END USART1_Init 1 */
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 115200;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN USART1_Init 2 */
+
+  /* USER CODE END USART1_Init 2 */
+
+}
+
+/**
+  * @brief GPIO Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_GPIO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /* USER CODE BEGIN MX_GPIO_Init_1 */
+
+  /* USER CODE END MX_GPIO_Init_1 */
+
+  /* GPIO Ports Clock Enable */
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOG_CLK_ENABLE();
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(GPIOG, GPIO_PIN_11 | GPIO_PIN_13|GPIO_PIN_14, GPIO_PIN_RESET);
+
+  /*Configure GPIO pin : PA0 */
+  GPIO_InitStruct.Pin = GPIO_PIN_0;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+  /*Configure GPIO pins : PG13 PG14 */
+  GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13|GPIO_PIN_14;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOG, &GPIO_InitStruct);
+
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI0_IRQn, 7, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+
+  /* USER CODE BEGIN MX_GPIO_Init_2 */
+
+  /* USER CODE END MX_GPIO_Init_2 */
+}
+
+/* USER CODE BEGIN 4 */
+
+/* USER CODE END 4 */
+
+
+/**
+  * @brief  Period elapsed callback in non blocking mode
+  * @note   This function is called  when TIM6 interrupt took place, inside
+  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
+  * a global variable "uwTick" used as application time base.
+  * @param  htim : TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  /* USER CODE BEGIN Callback 0 */
+
+  /* USER CODE END Callback 0 */
+  if (htim->Instance == TIM6)
+  {
+    HAL_IncTick();
+  }
+  /* USER CODE BEGIN Callback 1 */
+
+  /* USER CODE END Callback 1 */
+}
+
+/**
+  * @brief  This function is executed in case of error occurrence.
+  * @retval None
+  */
+void Error_Handler(void)
+{
+  /* USER CODE BEGIN Error_Handler_Debug */
+  /* User can add his own implementation to report the HAL error return state */
+  __disable_irq();
+  while (1)
+  {
+  }
+  /* USER CODE END Error_Handler_Debug */
+}
+
+#ifdef  USE_FULL_ASSERT
+/**
+  * @brief  Reports the name of the source file and the source line number
+  *         where the assert_param error has occurred.
+  * @param  file: pointer to the source file name
+  * @param  line: assert_param error line source number
+  * @retval None
+  */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  /* USER CODE BEGIN 6 */
+  /* User can add his own implementation to report the file name and line number,
+     ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+  /* USER CODE END 6 */
+}
+#endif /* USE_FULL_ASSERT */
@@ -27,6 +27,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "adaptive_stream_buffer.h"
 
 /* USER CODE END Includes */
 
@@ -65,14 +66,14 @@ static void MX_USART1_UART_Init(void);
 /* USER CODE BEGIN 0 */
 
 /* ****************************** Stream Buffer Handle ************************* */
-StreamBufferHandle_t StreamBuffer_Handle;
+AdaptiveStreamBufferHandle_t StreamBuffer_Handle;
 
 /* ****************************** Task Handles ********************************* */
 TaskHandle_t ProducerHandle;
 TaskHandle_t ConsumerHandle;
 
 #define STREAM_BUFFER_SIZE 64
-#define TRIGGER_LEVEL	   1
+#define IDLE_TIMEOUT	   pdMS_TO_TICKS(20) // hand partial data over after 20 ms without writes
 
 /* ***************************** Task Functions ******************************** */
 void ProducerTask(void* pvParameters)
@@ -82,7 +83,7 @@ void ProducerTask(void* pvParameters)
 	for(;;)
 	{
 		HAL_UART_Transmit(&huart1, (uint8_t *)"Producing Data...\r\n", 20, HAL_MAX_DELAY);
-		size_t bytesSent = xStreamBufferSend(
+		size_t bytesSent = xAdaptiveStreamBufferSend(
 				StreamBuffer_Handle,
 				(void *)txData,
 				strlen(txData),
@@ -102,7 +103,7 @@ void ConsumerTask(void *pvParameters)
 	char rxBuffer[32];
 	for(;;)
 	{
-		size_t bytesReceived = xStreamBufferReceive( // waiting for data from Producer
+		size_t bytesReceived = xAdaptiveStreamBufferReceive( // waiting for data from Producer
 				StreamBuffer_Handle,
 				(void*)rxBuffer,
 				sizeof(rxBuffer),
@@ -150,7 +151,7 @@ int main(void)
   /* USER CODE BEGIN 2 */
 
   /* ************************** Create Stream Buffer ************************** */
-  StreamBuffer_Handle = xStreamBufferCreate(STREAM_BUFFER_SIZE, TRIGGER_LEVEL);
+  StreamBuffer_Handle = xAdaptiveStreamBufferCreate(STREAM_BUFFER_SIZE, IDLE_TIMEOUT);
   if(StreamBuffer_Handle == NULL)
   {
 	  HAL_UART_Transmit(&huart1, (uint8_t *)"Stream Buffer Creation Failed\r\n", 30, HAL_MAX_DELAY);
@@ -26,6 +26,10 @@
 #include "string.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "adaptive_stream_buffer.h"
+#include "periodic.h"
+#include "perf_counter.h"
+#include "queue_metrics.h"
 
 /* USER CODE END Includes */
 
@@ -64,14 +68,24 @@ static void MX_USART1_UART_Init(void);
 /* USER CODE BEGIN 0 */
 
 /* ****************************** Stream Buffer Handle ************************* */
-StreamBufferHandle_t StreamBuffer_Handle;
+AdaptiveStreamBufferHandle_t StreamBuffer_Handle;
 
 /* ****************************** Task Handles ********************************* */
 TaskHandle_t ProducerHandle;
 TaskHandle_t ConsumerHandle;
 
 #define STREAM_BUFFER_SIZE 64
-#define TRIGGER_LEVEL	   1
+#define IDLE_TIMEOUT	   pdMS_TO_TICKS(20) // hand partial data over after 20 ms without writes
+#define STATS_EVERY_READS  10
+
+// The producer is released every 100 ms on an absolute grid: a send that
+// blocks on a full buffer shows up as an overrun, not as a slower producer
+PeriodicTask_t ProducerPeriodic;
+
+void PrintLine(const char *line)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)line, strlen(line), HAL_MAX_DELAY);
+}
 
 /* ****************************** BurstProducer Task ******************************** */
 void BurstProducer(void *pvParameters)
@@ -80,13 +94,12 @@ void BurstProducer(void *pvParameters)
 	uint8_t i = 0;
 	char setChars[] = {'A','B','C','D','E'};
 
-	xStreamBufferReset(StreamBuffer_Handle); // Reset Stream Buffer before using
-
 	for(;;)
 	{
+		vPeriodicWait(&ProducerPeriodic); // Very fast producer
 		memset(txData, setChars[i] , sizeof(txData));
 		// Send data to Stream Buffer
-		size_t sent = xStreamBufferSend(StreamBuffer_Handle,
+		size_t sent = xAdaptiveStreamBufferSend(StreamBuffer_Handle,
 		                                txData,
 		                                sizeof(txData),
 		                                pdMS_TO_TICKS(100));
@@ -99,8 +112,6 @@ void BurstProducer(void *pvParameters)
 
 		i++;
 		if(i > 4) i = 0;
-
-		vTaskDelay(pdMS_TO_TICKS(100)); // Very fast producer
 	}
 }
 
@@ -108,10 +119,11 @@ void BurstProducer(void *pvParameters)
 void SlowConsumer(void *pvParameters)
 {
 	uint8_t rxData[20];
+	uint32_t reads = 0;
 	memset(rxData, 0, sizeof(rxData));
 	for(;;)
 	{
-		size_t recvd = xStreamBufferReceive(StreamBuffer_Handle,
+		size_t recvd = xAdaptiveStreamBufferReceive(StreamBuffer_Handle,
 		                                    rxData,
 		                                    sizeof(rxData),
 		                                    portMAX_DELAY);
@@ -121,6 +133,11 @@ void SlowConsumer(void *pvParameters)
 		HAL_UART_Transmit(&huart1, rxData, recvd, HAL_MAX_DELAY);
 		HAL_UART_Transmit(&huart1,(uint8_t*)"\n",1,HAL_MAX_DELAY);
 
+		if (++reads % STATS_EVERY_READS == 0) {
+			vPeriodicDump(PrintLine);
+			vQueueMetricsDump(PrintLine); // how often the producer found the buffer full
+		}
+
 		vTaskDelay(pdMS_TO_TICKS(1000));  // Slow consumer
 	}
 }
@@ -159,19 +176,25 @@ int main(void)
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
 
+  vPerfCounterInit();
+
   /* ************************** Create Stream Buffer ************************** */
-  StreamBuffer_Handle = xStreamBufferCreate(STREAM_BUFFER_SIZE, TRIGGER_LEVEL);
+  StreamBuffer_Handle = xAdaptiveStreamBufferCreate(STREAM_BUFFER_SIZE, IDLE_TIMEOUT);
   if(StreamBuffer_Handle == NULL)
   {
 	  HAL_UART_Transmit(&huart1, (uint8_t *)"Stream Buffer Creation Failed\n", 30, HAL_MAX_DELAY);
   }else{
 	  HAL_UART_Transmit(&huart1, (uint8_t *)"Stream Buffer Created Successfully\n", 37, HAL_MAX_DELAY);
+	  xQueueMetricsAddStreamBuffer(xAdaptiveStreamBufferGetStreamBuffer(StreamBuffer_Handle), "StreamBuffer");
   }
 
 
+  vPeriodicInit(&ProducerPeriodic, "Producer", pdMS_TO_TICKS(100), 0);
+
   /* **************************** Create Tasks ********************************** */
   xTaskCreate(BurstProducer, "Producer", 256, NULL, 2, &ProducerHandle);
   xTaskCreate(SlowConsumer,  "Consumer", 256, NULL, 2, &ConsumerHandle);
+  xQueueMetricsStartSampler(pdMS_TO_TICKS(100), 3); // above Producer and Consumer
 
   vTaskStartScheduler();
 
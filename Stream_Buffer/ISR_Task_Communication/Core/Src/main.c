@@ -26,6 +26,11 @@
 #include "string.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "adaptive_stream_buffer.h"
+#include "uart_rx.h"
+#include "perf_counter.h"
+#include "runtime_stats.h"
+#include "queue_metrics.h"
 
 /* USER CODE END Includes */
 
@@ -46,6 +51,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 UART_HandleTypeDef huart1;
+DMA_HandleTypeDef hdma_usart1_rx;
 
 /* USER CODE BEGIN PV */
 
@@ -54,6 +60,7 @@ UART_HandleTypeDef huart1;
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART1_UART_Init(void);
 /* USER CODE BEGIN PFP */
 
@@ -62,21 +69,26 @@ static void MX_USART1_UART_Init(void);
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
-uint8_t rx_data = 0; // Variable to store UART received data
-
 /* *********************** Stream Buffer Configurations ************************ */
 #define STREAM_BUFFER_SIZE 64
-#define TRIGGER_LEVEL	   1
+#define IDLE_TIMEOUT	   pdMS_TO_TICKS(20) // hand partial data over after 20 ms without writes
 
 /* ****************************** Stream Buffer Handle ************************* */
-StreamBufferHandle_t StreamBuffer_Handle;
+AdaptiveStreamBufferHandle_t StreamBuffer_Handle;
+
+TaskHandle_t StatsTask_Handle;
+
+void PrintLine(const char *line)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)line, strlen(line), HAL_MAX_DELAY);
+}
 
 void ConsumerTask(void *pvParameters)
 {
 	char rxBuffer[32];
 	for(;;)
 	{
-		size_t bytesReceived = xStreamBufferReceive( //  Receive data from the stream buffer
+		size_t bytesReceived = xAdaptiveStreamBufferReceive( //  Receive data from the stream buffer
 				StreamBuffer_Handle,
 				(void*)rxBuffer,
 				sizeof(rxBuffer),
@@ -89,30 +101,51 @@ void ConsumerTask(void *pvParameters)
 	}
 }
 
-// This callback is called by the HAL_UART_IRQHandler when the UART receive interrupt occurs
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart)
+// Woken by the UART interrupt after each 'r'
+void StatsTask(void *pvParameters)
 {
+	for(;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
+		vRuntimeStatsPrint(PrintLine); // CPU per task since the previous 'r'
+		vQueueMetricsDump(PrintLine);  // stream buffer level and failed ISR writes
+	}
+}
+
+// This callback is called from the UART / DMA interrupt at idle line, half and full buffer
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	const char *msg = "\nUART Received\n";
+	uint8_t rx[16];
+	size_t len;
 
-	if(rx_data == 'r')
-	{
-		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	vUartRxEventFromISR(huart, Size, &xHigherPriorityTaskWoken);
 
-		// Send data to the stream buffer from ISR
-		xStreamBufferSendFromISR(
-				StreamBuffer_Handle,
-				(void*) msg,
-				strlen(msg),
-				&xHigherPriorityTaskWoken);
+	// Only the bytes that arrived since the previous event
+	while ((len = xUartRxReadFromISR(rx, sizeof(rx))) > 0)
+	{
+		for (size_t i = 0; i < len; i++)
+		{
+			if(rx[i] == 'r')
+			{
+				// Send data to the stream buffer from ISR
+				xAdaptiveStreamBufferSendFromISR(StreamBuffer_Handle, (void*) msg, strlen(msg), &xHigherPriorityTaskWoken);
 
-		HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
+				HAL_GPIO_TogglePin(GPIOG, GPIO_PIN_14);
 
-		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+				vTaskNotifyGiveFromISR(StatsTask_Handle, &xHigherPriorityTaskWoken);
+			}
+		}
 	}
 
-    // Restart UART Reception in Interrupt mode
-	HAL_UART_Receive_IT(huart, &rx_data, 1);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	vUartRxErrorFromISR(huart); // restart the circular reception
 }
 
 /* USER CODE END 0 */
@@ -146,24 +179,30 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
 
+  vPerfCounterInit(); // clock of the runtime statistics
+
   /* ************************** Create Stream Buffer ************************** */
-  StreamBuffer_Handle = xStreamBufferCreate(STREAM_BUFFER_SIZE, TRIGGER_LEVEL);
+  StreamBuffer_Handle = xAdaptiveStreamBufferCreate(STREAM_BUFFER_SIZE, IDLE_TIMEOUT);
   if(StreamBuffer_Handle == NULL)
   {
 	  HAL_UART_Transmit(&huart1, (uint8_t *)"Stream Buffer Creation Failed\r\n", 30, HAL_MAX_DELAY);
   }else{
 	  HAL_UART_Transmit(&huart1, (uint8_t *)"Stream Buffer Created Successfully\r\n", 37, HAL_MAX_DELAY);
+	  xQueueMetricsAddStreamBuffer(xAdaptiveStreamBufferGetStreamBuffer(StreamBuffer_Handle), "StreamBuffer");
   }
 
   /* ************************** Create Consumer Task ************************** */
   xTaskCreate(ConsumerTask, "ConsumerTask", 256, NULL, 2, NULL);
+  xTaskCreate(StatsTask, "StatsTask", 256, NULL, 3, &StatsTask_Handle);
+  xQueueMetricsStartSampler(pdMS_TO_TICKS(100), 4); // above ConsumerTask and StatsTask
 
 
-  /* Start UART Reception in Interrupt mode */
-  HAL_UART_Receive_IT(&huart1, &rx_data, 1);
+  /* Start UART Reception with circular DMA and idle line detection */
+  xUartRxInit(&huart1);
 
 
   vTaskStartScheduler();
@@ -269,6 +308,22 @@ static void MX_USART1_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA2_Stream2_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None